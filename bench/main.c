@@ -0,0 +1,1737 @@
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <gfx.h>
+#include <gfx-font.h>
+#include <gfx-display-list.h>
+#include <gfx-gradient.h>
+#include <gfx-indexed.h>
+#include <gfx-path.h>
+#include <gfx-polygon.h>
+#include <gfx-rle.h>
+#include <gfx-stroke.h>
+#include <gfx-text.h>
+#include <gfx-pixtile.h>
+#include <lcd.h>
+#include <math-util.h>
+
+#include "reference.h"
+
+// Microbenchmarks for the libgfx drawing primitives.
+//
+// This runs on the build host, linked against the host build of
+// libgfx.  Every case draws into a pixtile the same shape as the ones
+// lcd_alloc_pixtile hands out, LCD_WIDTH x LCD_MAX_TILE_ROWS, placed
+// in the middle of the screen so that clipping happens on both edges.
+//
+// Output is one JSON object per case per line.
+//
+//   usage: gfx-bench [-f hz] [-t seconds] [pattern ...]
+//
+// A case runs if its name contains any of the patterns.  With -f,
+// each result also gives cycles per pixel at that clock rate.
+//
+// Cases named ref_* measure the reference implementations in
+// reference.c, so the library's versions can be compared with them.
+
+#define SAMPLE_COUNT 1024       // distinct operands per case
+#define BATCH_SIZE     64       // ops between clock reads
+
+#define BENCH_COLOR  0x3080C0
+#define BENCH_ALPHA  0x80
+
+typedef struct bench_case bench_case;
+
+// Draw count ops.  Return the number of pixels drawn.
+typedef size_t bench_fn(gfx_pixtile *tile, size_t count);
+
+struct bench_case {
+    const char *name;           // gfx function measured
+    const char *shape;          // operand size, free-form
+    const char *unit;           // what one op is
+    bench_fn   *run;
+};
+
+typedef struct span_sample {
+    int    x0, x1, y;
+} span_sample;
+
+typedef struct zoid_sample {
+    gfx_trapezoid zoid;
+    size_t        pixels;       // pixels inside the tile
+} zoid_sample;
+
+typedef struct triangle_sample {
+    gfx_triangle  tri;
+    size_t        pixels;       // pixels inside the tile
+} triangle_sample;
+
+typedef struct path_sample {
+    gfx_path   path;
+    uint8_t    ops[4];
+    gfx_point  points[10];
+    size_t     pixels;          // pixels inside the tile
+} path_sample;
+
+typedef struct polygon_sample {
+    gfx_point  points[10];
+    size_t     pixels;          // pixels inside the tile
+} polygon_sample;
+
+typedef struct polyline_sample {
+    gfx_point  points[32];
+    size_t     pixels;          // pixels inside the tile
+} polyline_sample;
+
+typedef struct rect_sample {
+    float  x, y, w, h;
+    size_t pixels;              // pixels inside the tile
+} rect_sample;
+
+// One call of a scene: a rect, line, or circle, per kind.
+typedef struct scene_call {
+    int        kind;
+    float      a, b, c, d;
+    gfx_rgb888 color;
+} scene_call;
+
+typedef struct ellipse_sample {
+    float  cx, cy, rx, ry;
+    float  a0, a1;              // arcs only
+    size_t pixels;              // pixels inside the tile
+    size_t arc_pixels;          // same for the arc
+} ellipse_sample;
+
+typedef struct line_sample {
+    float  x0, y0, x1, y1;
+    size_t pixels;              // pixels inside the tile
+} line_sample;
+
+static gfx_rgb565  tile_pixels[LCD_WIDTH * LCD_MAX_TILE_ROWS];
+static gfx_pixtile bench_tile;
+
+static gfx_ipoint  pixel_samples[SAMPLE_COUNT];
+static span_sample wide_span_samples[SAMPLE_COUNT];
+static span_sample narrow_span_samples[SAMPLE_COUNT];
+static line_sample screen_line_samples[SAMPLE_COUNT];
+static line_sample short_line_samples[SAMPLE_COUNT];
+static line_sample tile_line_samples[SAMPLE_COUNT];
+static zoid_sample screen_zoid_samples[SAMPLE_COUNT];
+static zoid_sample tile_zoid_samples[SAMPLE_COUNT];
+static triangle_sample screen_triangle_samples[SAMPLE_COUNT];
+static triangle_sample tile_triangle_samples[SAMPLE_COUNT];
+static rect_sample screen_rect_samples[SAMPLE_COUNT];
+static path_sample gauge_path_samples[SAMPLE_COUNT];
+static polygon_sample star_polygon_samples[SAMPLE_COUNT];
+static polyline_sample trend_polyline_samples[SAMPLE_COUNT];
+static ellipse_sample screen_ellipse_samples[SAMPLE_COUNT];
+
+static gfx_alpha8  icon_mask_pixels[48 * 48];
+static gfx_mask    icon_masks[SAMPLE_COUNT];
+static size_t      icon_mask_pixels_in_tile[SAMPLE_COUNT];
+static gfx_alpha8  lcd_icon_mask_pixels[3 * 48 * 48];
+static gfx_mask    lcd_icon_masks[SAMPLE_COUNT];
+
+#define BENCH_GLYPH_W      8
+#define BENCH_GLYPH_H     11
+#define BENCH_GLYPH_COUNT 95
+
+static const char  bench_text[] = "Sphinx of black quartz,\njudge my vow.";
+static gfx_alpha8  bench_atlas[BENCH_GLYPH_COUNT * BENCH_GLYPH_W * BENCH_GLYPH_H];
+static gfx_glyph   bench_glyphs[BENCH_GLYPH_COUNT];
+static gfx_font    bench_font;
+static gfx_ipoint  text_origins[SAMPLE_COUNT];
+static size_t      text_pixels_in_tile[SAMPLE_COUNT];
+
+static gfx_outline_glyph bench_outline_glyphs[BENCH_GLYPH_COUNT];
+static gfx_outline_font  bench_outline_font;
+
+static gfx_rgb565  sprite_pixels[50 * 20];
+static gfx_pixtile sprite_tile;
+static gfx_ipoint  sprite_offsets[SAMPLE_COUNT];
+static gfx_alpha8  sprite_alpha[50 * 20];
+static gfx_rgb565  keyed_sprite_pixels[50 * 20];
+static gfx_pixtile keyed_sprite_tile;
+static gfx_rgb565  flat_sprite_pixels[50 * 20];
+static uint16_t    rle_sprite_data[50 * 20 * 2];
+static uint32_t    rle_sprite_rows[20];
+static gfx_rle_image rle_sprite;
+
+static gfx_gradient vertical_gradient;
+static gfx_gradient diagonal_gradient;
+static gfx_gradient diagonal_ramp_gradient;
+static gfx_gradient radial_gradient;
+static gfx_gradient radial_ramp_gradient;
+static gfx_rgb565   diagonal_ramp[GFX_GRADIENT_RAMP_SIZE];
+static gfx_rgb565   radial_ramp[GFX_GRADIENT_RAMP_SIZE];
+static gfx_rgb565  frame_pixels[LCD_WIDTH * LCD_MAX_TILE_ROWS];
+static gfx_pixtile frame_tile;
+static uint8_t     indexed_pixels[LCD_WIDTH * LCD_MAX_TILE_ROWS];
+static gfx_rgb565  indexed_palette[256];
+static gfx_indexed indexed_frame_8;
+static gfx_indexed indexed_frame_4;
+
+#define SCENE_CALLS 300
+static scene_call   scene_calls[SCENE_CALLS];
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Sample data
+
+static uint32_t rng_state = 0x1b175;
+
+// xorshift32.  Deterministic, so every run draws the same thing.
+static uint32_t rng(void)
+{
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return rng_state = x;
+}
+
+static int rng_int(int lo, int hi)
+{
+    return lo + (int)(rng() % (uint32_t)(hi - lo));
+}
+
+static float rng_float(float lo, float hi)
+{
+    return lo + (hi - lo) * (rng() & 0xFFFFFF) / (float)0x1000000;
+}
+
+// Count the pixels of a line that land inside the tile.
+// Approximate: one pixel per step along the major axis.
+static size_t line_pixels_in_tile(const gfx_pixtile *tile,
+                                  float x0, float y0,
+                                  float x1, float y1)
+{
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    int steps = (int)MAX(ABS(dx), ABS(dy)) + 1;
+    size_t n = 0;
+    for (int i = 0; i < steps; i++) {
+        float t = steps > 1 ? (float)i / (steps - 1) : 0;
+        int x = FLOOR(x0 + t * dx);
+        int y = FLOOR(y0 + t * dy);
+        if (x >= tile->x && x < tile->x + (int)tile->w &&
+            y >= tile->y && y < tile->y + (int)tile->h)
+            n++;
+    }
+    return n;
+}
+
+static void init_line_sample(line_sample *ls,
+                             float x0, float y0,
+                             float x1, float y1)
+{
+    ls->x0 = x0;
+    ls->y0 = y0;
+    ls->x1 = x1;
+    ls->y1 = y1;
+    ls->pixels = line_pixels_in_tile(&bench_tile, x0, y0, x1, y1);
+}
+
+// Area of a trapezoid inside the tile, sampled at row centers.
+static size_t zoid_pixels_in_tile(const gfx_pixtile *tile,
+                                  const gfx_trapezoid *z)
+{
+    float n = 0;
+    for (int y = tile->y; y < tile->y + (int)tile->h; y++) {
+        float yc = y + 0.5f;
+        if (yc < z->y0 || yc >= z->y1)
+            continue;
+        float t = (yc - z->y0) / (z->y1 - z->y0);
+        float xl = MAX((float)tile->x, z->xl0 + t * (z->xl1 - z->xl0));
+        float xr = MIN((float)(tile->x + tile->w),
+                       z->xr0 + t * (z->xr1 - z->xr0));
+        if (xr > xl)
+            n += xr - xl;
+    }
+    return n;
+}
+
+static void init_zoid_sample(zoid_sample *zs,
+                             float xmin, float xmax,
+                             float ymin, float ymax)
+{
+    float y0 = rng_float(ymin, ymax - 8);
+    float y1 = rng_float(y0 + 4, MIN(ymax, y0 + 64));
+    float xl0 = rng_float(xmin, xmax - 8), xr0 = rng_float(xl0, xmax);
+    float xl1 = rng_float(xmin, xmax - 8), xr1 = rng_float(xl1, xmax);
+    zs->zoid = (gfx_trapezoid) {
+        .xl0 = xl0, .xr0 = xr0, .y0 = y0,
+        .xl1 = xl1, .xr1 = xr1, .y1 = y1,
+    };
+    zs->pixels = zoid_pixels_in_tile(&bench_tile, &zs->zoid);
+}
+
+static size_t triangle_pixels_in_tile(const gfx_pixtile *tile,
+                                      const gfx_triangle *tri)
+{
+    gfx_point a = tri->v[0], b = tri->v[1], c = tri->v[2], t;
+    if (b.y < a.y) { t = a; a = b; b = t; }
+    if (c.y < b.y) { t = b; b = c; c = t; }
+    if (b.y < a.y) { t = a; a = b; b = t; }
+    if (!(a.y < c.y))
+        return 0;
+    float xm = a.x + (c.x - a.x) * (b.y - a.y) / (c.y - a.y);
+    float xl = MIN(xm, b.x), xr = MAX(xm, b.x);
+    gfx_trapezoid top = { a.x, a.x, a.y, xl, xr, b.y };
+    gfx_trapezoid bot = { xl, xr, b.y, c.x, c.x, c.y };
+    size_t n = 0;
+    if (top.y0 < top.y1)
+        n += zoid_pixels_in_tile(tile, &top);
+    if (bot.y0 < bot.y1)
+        n += zoid_pixels_in_tile(tile, &bot);
+    return n;
+}
+
+static void init_triangle_sample(triangle_sample *ts,
+                                 float xmin, float xmax,
+                                 float ymin, float ymax)
+{
+    float x = rng_float(xmin, xmax - 48);
+    float y = rng_float(ymin, ymax - 48);
+    for (size_t i = 0; i < 3; i++) {
+        ts->tri.v[i].x = x + rng_float(0, 48);
+        ts->tri.v[i].y = y + rng_float(0, 48);
+    }
+    ts->pixels = triangle_pixels_in_tile(&bench_tile, &ts->tri);
+}
+
+// A soft edged disc, like a pre-rasterized AA icon: transparent
+// corners, an opaque middle, and a ramp between.
+static void init_icon_mask(void)
+{
+    for (int y = 0; y < 48; y++) {
+        for (int x = 0; x < 48; x++) {
+            float dx = x + 0.5f - 24, dy = y + 0.5f - 24;
+            float d = 22 - sqrtf(dx * dx + dy * dy);
+            icon_mask_pixels[48 * y + x] = CLAMP(0, 255, (int)(d * 128));
+        }
+        for (int x = 0; x < 3 * 48; x++) {
+            float dx = (x + 0.5f) / 3 - 24, dy = y + 0.5f - 24;
+            float d = 22 - sqrtf(dx * dx + dy * dy);
+            lcd_icon_mask_pixels[3 * 48 * y + x] =
+                CLAMP(0, 255, (int)(d * 128));
+        }
+    }
+}
+
+// A button: a rounded rectangle with soft corners.  The keyed copy
+// has the key color wherever the button is transparent.
+#define SPRITE_KEY 0xF81F
+
+static void init_sprite(void)
+{
+    for (int y = 0; y < 20; y++) {
+        for (int x = 0; x < 50; x++) {
+            float dx = MAX(0, fabsf(x + 0.5f - 25) - 19);
+            float dy = MAX(0, fabsf(y + 0.5f - 10) - 4);
+            float d = 6 - sqrtf(dx * dx + dy * dy);
+            size_t i = 50 * y + x;
+            sprite_pixels[i] = rng();
+            sprite_alpha[i] = CLAMP(0, 255, (int)(d * 255));
+            keyed_sprite_pixels[i] =
+                sprite_alpha[i] < 0x80 ? SPRITE_KEY : sprite_pixels[i];
+        }
+    }
+}
+
+// Flat UI art: a button face with a border and a few lines of
+// lettering, encoded the way pixmaps/img-to-button does it.
+static void init_rle_sprite(void)
+{
+    for (int y = 0; y < 20; y++)
+        for (int x = 0; x < 50; x++) {
+            gfx_rgb565 c = 0xE71C;
+            if (x == 0 || x == 49 || y == 0 || y == 19)
+                c = 0x8410;
+            else if (y >= 6 && y < 14 && x >= 12 && x < 38 && x % 4 == y % 3)
+                c = 0x0000;
+            flat_sprite_pixels[50 * y + x] = c;
+        }
+
+    size_t n = 0;
+    for (int y = 0; y < 20; y++) {
+        const gfx_rgb565 *row = flat_sprite_pixels + 50 * y;
+        rle_sprite_rows[y] = n;
+        for (int x = 0; x < 50; ) {
+            int run = 1;
+            while (x + run < 50 && row[x + run] == row[x])
+                run++;
+            if (run >= 3) {
+                rle_sprite_data[n++] = GFX_RLE_FILL | run;
+                rle_sprite_data[n++] = row[x];
+            } else {
+                rle_sprite_data[n++] = GFX_RLE_COPY | run;
+                for (int i = 0; i < run; i++)
+                    rle_sprite_data[n++] = row[x + i];
+            }
+            x += run;
+        }
+    }
+    rle_sprite = (gfx_rle_image) {
+        .data = rle_sprite_data,
+        .rows = rle_sprite_rows,
+        .w    = 50,
+        .h    = 20,
+    };
+}
+
+// Small shapes scattered over the whole screen, like a busy UI.
+static void init_scene(void)
+{
+    for (size_t i = 0; i < SCENE_CALLS; i++) {
+        scene_call *sc = &scene_calls[i];
+        sc->kind = i % 3;
+        sc->a = rng_float(0, LCD_WIDTH - 24);
+        sc->b = rng_float(0, LCD_HEIGHT - 24);
+        sc->c = rng_float(4, 24);
+        sc->d = rng_float(4, 24);
+        sc->color = rng() & 0xFFFFFF;
+    }
+}
+
+static void init_gradients(void)
+{
+    static const gfx_color_stop stops[] = {
+        { 0.0f, 0x203040 },
+        { 0.6f, 0x80C0F0 },
+        { 1.0f, 0xF0F0F0 },
+    };
+    size_t n = sizeof stops / sizeof *stops;
+    gfx_point top = {{ 0, 0 }}, bottom = {{ 0, LCD_HEIGHT }};
+    gfx_point corner = {{ LCD_WIDTH, LCD_HEIGHT }};
+    gfx_point center = {{ LCD_WIDTH / 2, LCD_HEIGHT / 2 }};
+    gfx_init_linear_gradient(&vertical_gradient, top, bottom,
+                             stops, n, NULL);
+    gfx_init_linear_gradient(&diagonal_gradient, top, corner,
+                             stops, n, NULL);
+    gfx_init_linear_gradient(&diagonal_ramp_gradient, top, corner,
+                             stops, n, diagonal_ramp);
+    gfx_init_radial_gradient(&radial_gradient, center, LCD_WIDTH / 2,
+                             stops, n, NULL);
+    gfx_init_radial_gradient(&radial_ramp_gradient, center, LCD_WIDTH / 2,
+                             stops, n, radial_ramp);
+}
+
+static size_t mask_pixels_in_tile(const gfx_pixtile *tile,
+                                  const gfx_mask *mask)
+{
+    int x0 = MAX(mask->x, tile->x);
+    int x1 = MIN(mask->x + (int)mask->w, tile->x + (int)tile->w);
+    int y0 = MAX(mask->y, tile->y);
+    int y1 = MIN(mask->y + (int)mask->h, tile->y + (int)tile->h);
+    return x0 < x1 && y0 < y1 ? (size_t)(x1 - x0) * (y1 - y0) : 0;
+}
+
+// A monospaced font of blobby glyphs, the size of a small UI font,
+// without kerning.  (Real fonts come from pixmaps/make-font.)
+static void init_bench_font(void)
+{
+    const size_t glyph_bytes = BENCH_GLYPH_W * BENCH_GLYPH_H;
+    for (size_t i = 0; i < sizeof bench_atlas; i++) {
+        uint32_t r = rng();
+        bench_atlas[i] = r & 1 ? 0 : r & 2 ? 0xFF : r >> 24;
+    }
+    for (size_t i = 0; i < BENCH_GLYPH_COUNT; i++) {
+        bench_glyphs[i] = (gfx_glyph) {
+            .offset  = i * glyph_bytes,
+            .advance = BENCH_GLYPH_W + 1,
+            .w       = BENCH_GLYPH_W,
+            .h       = BENCH_GLYPH_H,
+            .left    = 0,
+            .top     = BENCH_GLYPH_H - 2,
+        };
+    }
+    bench_font = (gfx_font) {
+        .atlas       = bench_atlas,
+        .glyphs      = bench_glyphs,
+        .kerning     = NULL,
+        .first       = ' ',
+        .count       = BENCH_GLYPH_COUNT,
+        .ascent      = BENCH_GLYPH_H - 2,
+        .descent     = 2,
+        .line_height = BENCH_GLYPH_H + 3,
+    };
+}
+
+// An outline font whose every glyph is a ring: an outer and an inner
+// contour of quadratic curves, like an 'o'.  On is 1, in the low bit
+// of x.
+#define ON(x) ((x) * 2 + 1)
+#define OFF(x) ((x) * 2)
+
+static const int16_t bench_ring_points[] = {
+    ON(300),   0, OFF(550),   0, ON(550), 300, OFF(550), 600,
+    ON(300), 600, OFF( 50), 600, ON( 50), 300, OFF( 50),   0,
+    ON(300), 100, OFF(150), 100, ON(150), 300, OFF(150), 500,
+    ON(300), 500, OFF(450), 500, ON(450), 300, OFF(450), 100,
+};
+
+static const uint16_t bench_ring_contour_ends[] = { 7, 15 };
+
+static void init_bench_outline_font(void)
+{
+    for (size_t i = 0; i < BENCH_GLYPH_COUNT; i++) {
+        bench_outline_glyphs[i] = (gfx_outline_glyph) {
+            .contour_count = 2,
+            .advance       = 600,
+            .x_min         = 50,
+            .y_min         = 0,
+            .x_max         = 550,
+            .y_max         = 600,
+        };
+    }
+    bench_outline_font = (gfx_outline_font) {
+        .glyphs       = bench_outline_glyphs,
+        .points       = bench_ring_points,
+        .contour_ends = bench_ring_contour_ends,
+        .kerning      = NULL,
+        .units_per_em = 1000,
+        .ascent       = 600,
+        .descent      = 0,
+        .line_height  = 1200,
+        .first        = ' ',
+        .count        = BENCH_GLYPH_COUNT,
+    };
+}
+
+static size_t text_pixels(const gfx_pixtile *tile, gfx_ipoint origin)
+{
+    size_t n = 0;
+    int x = origin.x, y = origin.y;
+    for (const char *p = bench_text; *p; p++) {
+        if (*p == '\n') {
+            x = origin.x;
+            y += bench_font.line_height;
+            continue;
+        }
+        gfx_mask m = {
+            .x = x,
+            .y = y - (BENCH_GLYPH_H - 2),
+            .w = BENCH_GLYPH_W,
+            .h = BENCH_GLYPH_H,
+        };
+        n += mask_pixels_in_tile(tile, &m);
+        x += BENCH_GLYPH_W + 1;
+    }
+    return n;
+}
+
+typedef struct path_pixel_counter {
+    gfx_point current;
+    size_t    pixels;
+} path_pixel_counter;
+
+static void count_path_pixels(void *closure, gfx_path_op op, gfx_point p)
+{
+    path_pixel_counter *c = closure;
+    if (op != GFX_PATH_MOVE)
+        c->pixels += line_pixels_in_tile(&bench_tile,
+                                         c->current.x, c->current.y,
+                                         p.x, p.y);
+    c->current = p;
+}
+
+// A dial gauge's scale: three quarter-circle cubics, 270 degrees.
+static void init_gauge_path_sample(path_sample *ps)
+{
+    const float k = 0.5523f;    // quarter circle control distance
+    float cx = rng_float(0, LCD_WIDTH);
+    float cy = rng_float(0, LCD_HEIGHT);
+    float r = rng_float(20, 110);
+    gfx_path *path = &ps->path;
+    gfx_init_path(path, ps->ops, 4, ps->points, 10);
+    gfx_path_move_to(path, cx - r, cy);
+    gfx_path_cubic_to(path, cx - r, cy - k * r,
+                      cx - k * r, cy - r, cx, cy - r);
+    gfx_path_cubic_to(path, cx + k * r, cy - r,
+                      cx + r, cy - k * r, cx + r, cy);
+    gfx_path_cubic_to(path, cx + r, cy + k * r,
+                      cx + k * r, cy + r, cx, cy + r);
+    path_pixel_counter c = { .pixels = 0 };
+    gfx_flatten_path(path, NULL, 0, GFX_PATH_TOLERANCE,
+                     count_path_pixels, &c);
+    ps->pixels = c.pixels;
+}
+
+// Area of a polygon inside the tile, sampled at row centers, by the
+// nonzero rule.
+static size_t polygon_pixels_in_tile(const gfx_pixtile *tile,
+                                     const gfx_point *p, size_t n)
+{
+    float total = 0;
+    for (int y = tile->y; y < tile->y + (int)tile->h; y++) {
+        float yc = y + 0.5f;
+        float xs[16];
+        int windings[16];
+        size_t k = 0;
+        for (size_t i = 0; i < n && k < 16; i++) {
+            gfx_point a = p[i], b = p[(i + 1) % n];
+            if ((a.y <= yc) == (b.y <= yc))
+                continue;
+            float x = a.x + (yc - a.y) * (b.x - a.x) / (b.y - a.y);
+            size_t j = k++;
+            for ( ; j > 0 && xs[j - 1] > x; j--) {
+                xs[j] = xs[j - 1];
+                windings[j] = windings[j - 1];
+            }
+            xs[j] = x;
+            windings[j] = b.y > a.y ? +1 : -1;
+        }
+        int winding = 0;
+        for (size_t j = 0; j + 1 < k; j++) {
+            winding += windings[j];
+            if (!winding)
+                continue;
+            float xl = MAX(xs[j], (float)tile->x);
+            float xr = MIN(xs[j + 1], (float)(tile->x + tile->w));
+            if (xr > xl)
+                total += xr - xl;
+        }
+    }
+    return total;
+}
+
+// A five pointed star, concave, at a random angle.
+static void init_star_polygon_sample(polygon_sample *ps)
+{
+    float cx = rng_float(0, LCD_WIDTH);
+    float cy = rng_float(0, LCD_HEIGHT);
+    float r = rng_float(20, 110);
+    float a = rng_float(0, 2 * M_PI);
+    for (size_t i = 0; i < 10; i++) {
+        float ri = i & 1 ? 0.4f * r : r;
+        float ai = a + i * (float)M_PI / 5;
+        ps->points[i] = (gfx_point) {{ cx + ri * cosf(ai),
+                                       cy + ri * sinf(ai) }};
+    }
+    ps->pixels = polygon_pixels_in_tile(&bench_tile, ps->points, 10);
+}
+
+static const gfx_stroke trend_stroke = {
+    .width = 3,
+    .join  = GFX_JOIN_ROUND,
+    .cap   = GFX_CAP_BUTT,
+};
+
+// A trend graph: a random walk across the screen.
+static void init_trend_polyline_sample(polyline_sample *ps)
+{
+    float y = rng_float(0, LCD_HEIGHT);
+    size_t pixels = 0;
+    for (size_t i = 0; i < 32; i++) {
+        y = CLAMP(0.0f, (float)LCD_HEIGHT, y + rng_float(-20, +20));
+        ps->points[i] = (gfx_point) {{ i * (LCD_WIDTH - 1) / 31.0f, y }};
+        if (i)
+            pixels += line_pixels_in_tile(&bench_tile,
+                                          ps->points[i - 1].x,
+                                          ps->points[i - 1].y,
+                                          ps->points[i].x,
+                                          ps->points[i].y);
+    }
+    ps->pixels = pixels * trend_stroke.width;
+}
+
+static void init_rect_sample(rect_sample *rs)
+{
+    const gfx_pixtile *t = &bench_tile;
+    rs->x = rng_float(-20, LCD_WIDTH);
+    rs->y = rng_float(-20, LCD_HEIGHT);
+    rs->w = rng_float(4, 100);
+    rs->h = rng_float(4, 100);
+    float w = MIN(rs->x + rs->w, (float)(t->x + t->w)) - MAX(rs->x, t->x);
+    float h = MIN(rs->y + rs->h, (float)(t->y + t->h)) - MAX(rs->y, t->y);
+    rs->pixels = w > 0 && h > 0 ? w * h : 0;
+}
+
+// Ellipse area and arc length inside the tile, by sampling pixel
+// centers.  Arc lengths count the circle with radius rx.
+static void init_ellipse_sample(ellipse_sample *es)
+{
+    const gfx_pixtile *t = &bench_tile;
+    es->cx = rng_float(0, LCD_WIDTH);
+    es->cy = rng_float(0, LCD_HEIGHT);
+    es->rx = rng_float(4, 40);
+    es->ry = rng_float(4, 40);
+    es->a0 = rng_float(0, 6.28f);
+    es->a1 = es->a0 + rng_float(0.5f, 6);
+    es->pixels = es->arc_pixels = 0;
+    float sweep = es->a1 - es->a0;
+    for (int y = t->y; y < t->y + (int)t->h; y++) {
+        for (int x = t->x; x < t->x + (int)t->w; x++) {
+            float dx = x + 0.5f - es->cx, dy = y + 0.5f - es->cy;
+            float ex = dx / es->rx, ey = dy / es->ry;
+            if (ex * ex + ey * ey < 1)
+                es->pixels++;
+            float d = sqrtf(dx * dx + dy * dy) - es->rx;
+            float a = atan2f(dy, dx) - es->a0;
+            while (a < 0)
+                a += 6.2831853f;
+            if (d >= -0.5f && d < 0.5f && a <= sweep)
+                es->arc_pixels++;
+        }
+    }
+}
+
+static void init_samples(void)
+{
+    const gfx_pixtile *t = &bench_tile;
+    int tx0 = t->x, tx1 = t->x + t->w;
+    int ty0 = t->y, ty1 = t->y + t->h;
+
+    for (size_t i = 0; i < SAMPLE_COUNT; i++) {
+        pixel_samples[i] = (gfx_ipoint) {{
+            .x = rng_int(tx0, tx1),
+            .y = rng_int(ty0, ty1),
+        }};
+
+        wide_span_samples[i] = (span_sample) {
+            .x0 = tx0,
+            .x1 = tx1,
+            .y  = rng_int(ty0, ty1),
+        };
+
+        int x = rng_int(tx0, tx1 - 16);
+        narrow_span_samples[i] = (span_sample) {
+            .x0 = x,
+            .x1 = x + 16,
+            .y  = rng_int(ty0, ty1),
+        };
+
+        init_line_sample(&screen_line_samples[i],
+                         rng_float(0, LCD_WIDTH),
+                         rng_float(0, LCD_HEIGHT),
+                         rng_float(0, LCD_WIDTH),
+                         rng_float(0, LCD_HEIGHT));
+
+        init_line_sample(&tile_line_samples[i],
+                         rng_float(tx0, tx1), rng_float(ty0, ty1),
+                         rng_float(tx0, tx1), rng_float(ty0, ty1));
+
+        float x0 = rng_float(tx0 + 8, tx1 - 8);
+        float y0 = rng_float(ty0 + 8, ty1 - 8);
+        init_line_sample(&short_line_samples[i],
+                         x0, y0,
+                         x0 + rng_float(-8, +8), y0 + rng_float(-8, +8));
+
+        init_zoid_sample(&screen_zoid_samples[i],
+                         0, LCD_WIDTH, 0, LCD_HEIGHT);
+        init_zoid_sample(&tile_zoid_samples[i], tx0, tx1, ty0, ty1);
+        init_triangle_sample(&screen_triangle_samples[i],
+                             0, LCD_WIDTH, 0, LCD_HEIGHT);
+        init_triangle_sample(&tile_triangle_samples[i],
+                             tx0, tx1, ty0, ty1);
+
+        init_rect_sample(&screen_rect_samples[i]);
+        init_gauge_path_sample(&gauge_path_samples[i]);
+        init_star_polygon_sample(&star_polygon_samples[i]);
+        init_trend_polyline_sample(&trend_polyline_samples[i]);
+        init_ellipse_sample(&screen_ellipse_samples[i]);
+
+        icon_masks[i] = (gfx_mask) {
+            .pixels = icon_mask_pixels,
+            .x      = rng_int(-24, LCD_WIDTH - 24),
+            .y      = rng_int(ty0 - 24, ty1 - 24),
+            .w      = 48,
+            .h      = 48,
+            .stride = 48,
+        };
+        icon_mask_pixels_in_tile[i] = mask_pixels_in_tile(t, &icon_masks[i]);
+        lcd_icon_masks[i] = icon_masks[i];
+        lcd_icon_masks[i].pixels = lcd_icon_mask_pixels;
+        lcd_icon_masks[i].stride = 3 * 48;
+
+        text_origins[i] = (gfx_ipoint) {{
+            .x = rng_int(-40, LCD_WIDTH - 160),
+            .y = rng_int(ty0 - 16, ty1 + 16),
+        }};
+        text_pixels_in_tile[i] = text_pixels(t, text_origins[i]);
+
+        sprite_offsets[i] = (gfx_ipoint) {{
+            .x = rng_int(tx0, tx1 - 50),
+            .y = rng_int(ty0, ty1 - 20),
+        }};
+    }
+
+    init_icon_mask();
+    init_bench_font();
+    init_bench_outline_font();
+    init_sprite();
+    init_rle_sprite();
+    init_gradients();
+    init_scene();
+    for (size_t i = 0; i < sizeof frame_pixels / sizeof *frame_pixels; i++)
+        frame_pixels[i] = rng();
+    for (size_t i = 0; i < sizeof indexed_pixels; i++)
+        indexed_pixels[i] = rng();
+    for (size_t i = 0; i < 256; i++)
+        indexed_palette[i] = rng();
+}
+
+static void init_tiles(void)
+{
+    gfx_init_pixtile(&bench_tile, tile_pixels,
+                     0, LCD_MAX_TILE_ROWS,
+                     LCD_WIDTH, LCD_MAX_TILE_ROWS,
+                     LCD_WIDTH);
+    gfx_init_pixtile(&sprite_tile, sprite_pixels, 0, 0, 50, 20, 50);
+    gfx_init_pixtile(&keyed_sprite_tile, keyed_sprite_pixels,
+                     0, 0, 50, 20, 50);
+    gfx_init_pixtile(&frame_tile, frame_pixels,
+                     0, 0,
+                     LCD_WIDTH, LCD_MAX_TILE_ROWS,
+                     LCD_WIDTH);
+    gfx_init_indexed(&indexed_frame_8, indexed_pixels,
+                     0, LCD_MAX_TILE_ROWS,
+                     LCD_WIDTH, LCD_MAX_TILE_ROWS,
+                     8, indexed_palette);
+    gfx_init_indexed(&indexed_frame_4, indexed_pixels,
+                     0, LCD_MAX_TILE_ROWS,
+                     LCD_WIDTH, LCD_MAX_TILE_ROWS,
+                     4, indexed_palette);
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Pixels
+
+static size_t run_fill_pixel(gfx_pixtile *tile, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        gfx_ipoint *p = &pixel_samples[i % SAMPLE_COUNT];
+        gfx_fill_pixel(tile, p->x, p->y, BENCH_COLOR);
+    }
+    return count;
+}
+
+static size_t run_fill_pixel_blend(gfx_pixtile *tile, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        gfx_ipoint *p = &pixel_samples[i % SAMPLE_COUNT];
+        gfx_fill_pixel_blend(tile, p->x, p->y, BENCH_COLOR, BENCH_ALPHA);
+    }
+    return count;
+}
+
+static size_t run_fill_pixel_unclipped(gfx_pixtile *tile, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        gfx_ipoint *p = &pixel_samples[i % SAMPLE_COUNT];
+        gfx_fill_pixel_unclipped(tile, p->x, p->y, BENCH_COLOR);
+    }
+    return count;
+}
+
+static size_t run_fill_pixel_blend_unclipped(gfx_pixtile *tile, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        gfx_ipoint *p = &pixel_samples[i % SAMPLE_COUNT];
+        gfx_fill_pixel_blend_unclipped(tile, p->x, p->y,
+                                       BENCH_COLOR, BENCH_ALPHA);
+    }
+    return count;
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Spans
+
+#define DEFINE_SPAN_RUNNERS(shape)                                      \
+                                                                        \
+    static size_t run_fill_span_##shape(gfx_pixtile *tile,              \
+                                        size_t count)                   \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            span_sample *s = &shape##_span_samples[i % SAMPLE_COUNT];   \
+            gfx_fill_span(tile, s->x0, s->x1, s->y, BENCH_COLOR);       \
+            n += s->x1 - s->x0;                                         \
+        }                                                               \
+        return n;                                                       \
+    }                                                                   \
+                                                                        \
+    static size_t run_fill_span_blend_##shape(gfx_pixtile *tile,        \
+                                              size_t count)             \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            span_sample *s = &shape##_span_samples[i % SAMPLE_COUNT];   \
+            gfx_fill_span_blend(tile, s->x0, s->x1, s->y,               \
+                                BENCH_COLOR, BENCH_ALPHA);              \
+            n += s->x1 - s->x0;                                         \
+        }                                                               \
+        return n;                                                       \
+    }                                                                   \
+                                                                        \
+    static size_t run_fill_span_unclipped_##shape(gfx_pixtile *tile,    \
+                                                  size_t count)         \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            span_sample *s = &shape##_span_samples[i % SAMPLE_COUNT];   \
+            gfx_fill_span_unclipped(tile, s->x0, s->x1, s->y,           \
+                                    BENCH_COLOR);                       \
+            n += s->x1 - s->x0;                                         \
+        }                                                               \
+        return n;                                                       \
+    }                                                                   \
+                                                                        \
+    static size_t run_fill_span_blend_unclipped_##shape(                \
+                                                  gfx_pixtile *tile,    \
+                                                  size_t count)         \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            span_sample *s = &shape##_span_samples[i % SAMPLE_COUNT];   \
+            gfx_fill_span_blend_unclipped(tile, s->x0, s->x1, s->y,     \
+                                          BENCH_COLOR, BENCH_ALPHA);    \
+            n += s->x1 - s->x0;                                         \
+        }                                                               \
+        return n;                                                       \
+    }
+
+DEFINE_SPAN_RUNNERS(wide)
+DEFINE_SPAN_RUNNERS(narrow)
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Lines
+
+#define DEFINE_LINE_RUNNER(func, shape, ...)                            \
+    static size_t run_##func##_##shape(gfx_pixtile *tile, size_t count) \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            line_sample *s = &shape##_line_samples[i % SAMPLE_COUNT];   \
+            gfx_##func(tile, s->x0, s->y0, s->x1, s->y1,                \
+                       BENCH_COLOR, ##__VA_ARGS__);                     \
+            n += s->pixels;                                             \
+        }                                                               \
+        return n;                                                       \
+    }
+
+DEFINE_LINE_RUNNER(draw_line,                      screen)
+DEFINE_LINE_RUNNER(draw_line,                      short)
+DEFINE_LINE_RUNNER(draw_line_aa,                   screen)
+DEFINE_LINE_RUNNER(draw_line_aa,                   short)
+DEFINE_LINE_RUNNER(draw_line_blend,                screen, BENCH_ALPHA)
+DEFINE_LINE_RUNNER(draw_line_aa_blend,             screen, BENCH_ALPHA)
+DEFINE_LINE_RUNNER(draw_line_unclipped,            tile)
+DEFINE_LINE_RUNNER(draw_line_aa_unclipped,         tile)
+DEFINE_LINE_RUNNER(draw_line_blend_unclipped,      tile, BENCH_ALPHA)
+DEFINE_LINE_RUNNER(draw_line_aa_blend_unclipped,   tile, BENCH_ALPHA)
+
+#define DEFINE_REF_LINE_RUNNER(func, shape)                             \
+    static size_t run_ref_##func##_##shape(gfx_pixtile *tile,          \
+                                           size_t count)                \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            line_sample *s = &shape##_line_samples[i % SAMPLE_COUNT];   \
+            ref_##func(tile, s->x0, s->y0, s->x1, s->y1, BENCH_COLOR);  \
+            n += s->pixels;                                             \
+        }                                                               \
+        return n;                                                       \
+    }
+
+DEFINE_REF_LINE_RUNNER(draw_line_float,            screen)
+DEFINE_REF_LINE_RUNNER(draw_line_float,            short)
+DEFINE_REF_LINE_RUNNER(draw_line_aa_float,         screen)
+DEFINE_REF_LINE_RUNNER(draw_line_aa_float,         short)
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Trapezoids
+
+#define DEFINE_ZOID_RUNNER(func, shape, ...)                            \
+    static size_t run_##func##_##shape(gfx_pixtile *tile, size_t count) \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            zoid_sample *s = &shape##_zoid_samples[i % SAMPLE_COUNT];   \
+            gfx_##func(tile, &s->zoid, 1, BENCH_COLOR, ##__VA_ARGS__);  \
+            n += s->pixels;                                             \
+        }                                                               \
+        return n;                                                       \
+    }
+
+DEFINE_ZOID_RUNNER(fill_trapezoids,                        screen)
+DEFINE_ZOID_RUNNER(fill_trapezoids_aa,                     screen)
+DEFINE_ZOID_RUNNER(fill_trapezoids_blend,                  screen, BENCH_ALPHA)
+DEFINE_ZOID_RUNNER(fill_trapezoids_aa_blend,               screen, BENCH_ALPHA)
+DEFINE_ZOID_RUNNER(fill_trapezoids_unclipped,              tile)
+DEFINE_ZOID_RUNNER(fill_trapezoids_aa_unclipped,           tile)
+DEFINE_ZOID_RUNNER(fill_trapezoids_blend_unclipped,        tile, BENCH_ALPHA)
+DEFINE_ZOID_RUNNER(fill_trapezoids_aa_blend_unclipped,     tile, BENCH_ALPHA)
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Triangles
+
+#define DEFINE_TRIANGLE_RUNNER(func, shape, ...)                        \
+    static size_t run_##func##_##shape(gfx_pixtile *tile, size_t count) \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            triangle_sample *s =                                        \
+                &shape##_triangle_samples[i % SAMPLE_COUNT];            \
+            gfx_##func(tile, &s->tri, 1, BENCH_COLOR, ##__VA_ARGS__);   \
+            n += s->pixels;                                             \
+        }                                                               \
+        return n;                                                       \
+    }
+
+DEFINE_TRIANGLE_RUNNER(fill_triangle,                      screen)
+DEFINE_TRIANGLE_RUNNER(fill_triangle_aa,                   screen)
+DEFINE_TRIANGLE_RUNNER(fill_triangle_blend,                screen, BENCH_ALPHA)
+DEFINE_TRIANGLE_RUNNER(fill_triangle_aa_blend,             screen, BENCH_ALPHA)
+DEFINE_TRIANGLE_RUNNER(fill_triangle_unclipped,            tile)
+DEFINE_TRIANGLE_RUNNER(fill_triangle_aa_unclipped,         tile)
+DEFINE_TRIANGLE_RUNNER(fill_triangle_blend_unclipped,      tile, BENCH_ALPHA)
+DEFINE_TRIANGLE_RUNNER(fill_triangle_aa_blend_unclipped,   tile, BENCH_ALPHA)
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Rectangles
+
+#define DEFINE_RECT_RUNNER(func, ...)                                   \
+    static size_t run_##func(gfx_pixtile *tile, size_t count)           \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            rect_sample *s = &screen_rect_samples[i % SAMPLE_COUNT];    \
+            gfx_##func(tile, s->x, s->y, s->w, s->h,                    \
+                       BENCH_COLOR, ##__VA_ARGS__);                     \
+            n += s->pixels;                                             \
+        }                                                               \
+        return n;                                                       \
+    }
+
+DEFINE_RECT_RUNNER(fill_rect)
+DEFINE_RECT_RUNNER(fill_rect_aa)
+DEFINE_RECT_RUNNER(fill_rect_blend,                BENCH_ALPHA)
+DEFINE_RECT_RUNNER(fill_rect_aa_blend,             BENCH_ALPHA)
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Gradients
+
+#define DEFINE_GRADIENT_RECT_RUNNER(name)                               \
+    static size_t run_fill_rect_gradient_##name(gfx_pixtile *tile,      \
+                                                size_t count)           \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            rect_sample *s = &screen_rect_samples[i % SAMPLE_COUNT];    \
+            gfx_fill_rect_gradient(tile, s->x, s->y, s->w, s->h,        \
+                                   &name##_gradient);                   \
+            n += s->pixels;                                             \
+        }                                                               \
+        return n;                                                       \
+    }
+
+DEFINE_GRADIENT_RECT_RUNNER(vertical)
+DEFINE_GRADIENT_RECT_RUNNER(diagonal)
+DEFINE_GRADIENT_RECT_RUNNER(diagonal_ramp)
+DEFINE_GRADIENT_RECT_RUNNER(radial)
+DEFINE_GRADIENT_RECT_RUNNER(radial_ramp)
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Dithering
+
+#define DEFINE_DITHERED_RUNNER(name, runner)                            \
+    static size_t run_##name##_dithered(gfx_pixtile *tile,              \
+                                        size_t count)                   \
+    {                                                                   \
+        gfx_set_dither(GFX_DITHER_8X8);                                 \
+        size_t n = runner(tile, count);                                 \
+        gfx_set_dither(GFX_DITHER_NONE);                                \
+        return n;                                                       \
+    }
+
+DEFINE_DITHERED_RUNNER(fill_rect_blend,           run_fill_rect_blend)
+DEFINE_DITHERED_RUNNER(fill_rect_gradient_diagonal,
+                       run_fill_rect_gradient_diagonal)
+DEFINE_DITHERED_RUNNER(fill_rect_gradient_radial,
+                       run_fill_rect_gradient_radial)
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Circles, Ellipses, and Arcs
+
+#define DEFINE_CIRCLE_RUNNER(func, ...)                                 \
+    static size_t run_##func(gfx_pixtile *tile, size_t count)           \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            ellipse_sample *s = &screen_ellipse_samples[i % SAMPLE_COUNT]; \
+            gfx_##func(tile, s->cx, s->cy, s->rx,                       \
+                       BENCH_COLOR, ##__VA_ARGS__);                     \
+            n += s->pixels;                                             \
+        }                                                               \
+        return n;                                                       \
+    }
+
+#define DEFINE_ELLIPSE_RUNNER(func, ...)                                \
+    static size_t run_##func(gfx_pixtile *tile, size_t count)           \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            ellipse_sample *s = &screen_ellipse_samples[i % SAMPLE_COUNT]; \
+            gfx_##func(tile, s->cx, s->cy, s->rx, s->ry,                \
+                       BENCH_COLOR, ##__VA_ARGS__);                     \
+            n += s->pixels;                                             \
+        }                                                               \
+        return n;                                                       \
+    }
+
+#define DEFINE_ARC_RUNNER(func, ...)                                    \
+    static size_t run_##func(gfx_pixtile *tile, size_t count)           \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            ellipse_sample *s = &screen_ellipse_samples[i % SAMPLE_COUNT]; \
+            gfx_##func(tile, s->cx, s->cy, s->rx, s->a0, s->a1,         \
+                       BENCH_COLOR, ##__VA_ARGS__);                     \
+            n += s->arc_pixels;                                         \
+        }                                                               \
+        return n;                                                       \
+    }
+
+DEFINE_CIRCLE_RUNNER(fill_circle)
+DEFINE_CIRCLE_RUNNER(fill_circle_aa)
+DEFINE_CIRCLE_RUNNER(fill_circle_aa_blend,         BENCH_ALPHA)
+DEFINE_ELLIPSE_RUNNER(fill_ellipse)
+DEFINE_ELLIPSE_RUNNER(fill_ellipse_aa)
+DEFINE_ARC_RUNNER(draw_arc)
+DEFINE_ARC_RUNNER(draw_arc_aa)
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Paths
+
+#define DEFINE_PATH_RUNNER(func, shape, ...)                            \
+    static size_t run_##func##_##shape(gfx_pixtile *tile, size_t count) \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            path_sample *s = &shape##_path_samples[i % SAMPLE_COUNT];   \
+            gfx_##func(tile, &s->path, BENCH_COLOR, ##__VA_ARGS__);     \
+            n += s->pixels;                                             \
+        }                                                               \
+        return n;                                                       \
+    }
+
+DEFINE_PATH_RUNNER(draw_path,                      gauge)
+DEFINE_PATH_RUNNER(draw_path_aa,                   gauge)
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Polygons
+
+#define DEFINE_POLYGON_RUNNER(func, shape, ...)                         \
+    static size_t run_##func##_##shape(gfx_pixtile *tile, size_t count) \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            polygon_sample *s = &shape##_polygon_samples[i % SAMPLE_COUNT]; \
+            gfx_##func(tile, s->points, 10, GFX_FILL_NONZERO,           \
+                       BENCH_COLOR, ##__VA_ARGS__);                     \
+            n += s->pixels;                                             \
+        }                                                               \
+        return n;                                                       \
+    }
+
+DEFINE_POLYGON_RUNNER(fill_polygon,                star)
+DEFINE_POLYGON_RUNNER(fill_polygon_aa,             star)
+DEFINE_POLYGON_RUNNER(fill_polygon_aa_blend,       star, BENCH_ALPHA)
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Strokes
+
+#define DEFINE_POLYLINE_RUNNER(func, shape, ...)                        \
+    static size_t run_##func##_##shape(gfx_pixtile *tile, size_t count) \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            polyline_sample *s =                                        \
+                &shape##_polyline_samples[i % SAMPLE_COUNT];            \
+            gfx_##func(tile, s->points, 32, &shape##_stroke,            \
+                       BENCH_COLOR, ##__VA_ARGS__);                     \
+            n += s->pixels;                                             \
+        }                                                               \
+        return n;                                                       \
+    }
+
+DEFINE_POLYLINE_RUNNER(stroke_polyline,            trend)
+DEFINE_POLYLINE_RUNNER(stroke_polyline_aa,         trend)
+DEFINE_POLYLINE_RUNNER(stroke_polyline_aa_blend,   trend, BENCH_ALPHA)
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Masks
+
+#define DEFINE_MASK_RUNNER(func, ...)                                   \
+    static size_t run_##func(gfx_pixtile *tile, size_t count)           \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            gfx_##func(tile, &icon_masks[i % SAMPLE_COUNT],             \
+                       BENCH_COLOR, ##__VA_ARGS__);                     \
+            n += icon_mask_pixels_in_tile[i % SAMPLE_COUNT];            \
+        }                                                               \
+        return n;                                                       \
+    }
+
+DEFINE_MASK_RUNNER(fill_mask)
+DEFINE_MASK_RUNNER(fill_mask_blend,                BENCH_ALPHA)
+
+// Subpixel masks fill about as many pixels, counted the same way.
+#define DEFINE_LCD_MASK_RUNNER(func, ...)                               \
+    static size_t run_##func(gfx_pixtile *tile, size_t count)           \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            gfx_##func(tile, &lcd_icon_masks[i % SAMPLE_COUNT],         \
+                       BENCH_COLOR, ##__VA_ARGS__);                     \
+            n += icon_mask_pixels_in_tile[i % SAMPLE_COUNT];            \
+        }                                                               \
+        return n;                                                       \
+    }
+
+DEFINE_LCD_MASK_RUNNER(fill_mask_lcd)
+DEFINE_LCD_MASK_RUNNER(fill_mask_blend_lcd,        BENCH_ALPHA)
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Text
+
+#define DEFINE_TEXT_RUNNER(func, ...)                                   \
+    static size_t run_##func(gfx_pixtile *tile, size_t count)           \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            gfx_##func(tile, &bench_font,                               \
+                       text_origins[i % SAMPLE_COUNT], bench_text,      \
+                       BENCH_COLOR, ##__VA_ARGS__);                     \
+            n += text_pixels_in_tile[i % SAMPLE_COUNT];                 \
+        }                                                               \
+        return n;                                                       \
+    }
+
+DEFINE_TEXT_RUNNER(draw_text)
+DEFINE_TEXT_RUNNER(draw_text_blend,                BENCH_ALPHA)
+
+// The ring glyphs at 16 pixels per em are 8 pixels wide and 10 high,
+// a little smaller than the atlas glyphs.  Pixels are counted the same
+// way.
+#define DEFINE_OUTLINE_TEXT_RUNNER(func, shape, flush)                  \
+    static size_t run_##func##_##shape(gfx_pixtile *tile, size_t count) \
+    {                                                                   \
+        size_t n = 0;                                                   \
+        for (size_t i = 0; i < count; i++) {                            \
+            gfx_ipoint o = text_origins[i % SAMPLE_COUNT];              \
+            if (flush)                                                  \
+                gfx_flush_glyph_cache();                                \
+            gfx_##func(tile, &bench_outline_font, 16,                   \
+                       (gfx_point) {{ o.x, o.y }}, bench_text,          \
+                       BENCH_COLOR);                                    \
+            n += text_pixels_in_tile[i % SAMPLE_COUNT];                 \
+        }                                                               \
+        return n;                                                       \
+    }
+
+DEFINE_OUTLINE_TEXT_RUNNER(draw_outline_text,      cached, false)
+DEFINE_OUTLINE_TEXT_RUNNER(draw_outline_text,      uncached, true)
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Pixtiles
+
+static size_t run_copy_pixtile_sprite(gfx_pixtile *tile, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        gfx_copy_pixtile(tile, &sprite_tile, sprite_offsets[i % SAMPLE_COUNT]);
+    return count * sprite_tile.w * sprite_tile.h;
+}
+
+static size_t run_copy_pixtile_keyed(gfx_pixtile *tile, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        gfx_copy_pixtile_keyed(tile, &keyed_sprite_tile,
+                               sprite_offsets[i % SAMPLE_COUNT], SPRITE_KEY);
+    return count * keyed_sprite_tile.w * keyed_sprite_tile.h;
+}
+
+static size_t run_draw_sprite(gfx_pixtile *tile, size_t count)
+{
+    gfx_sprite sprite = {
+        .pixels       = sprite_pixels,
+        .alpha        = sprite_alpha,
+        .w            = 50,
+        .h            = 20,
+        .stride       = 50,
+        .alpha_stride = 50,
+    };
+    for (size_t i = 0; i < count; i++) {
+        sprite.x = sprite_offsets[i % SAMPLE_COUNT].x;
+        sprite.y = sprite_offsets[i % SAMPLE_COUNT].y;
+        gfx_draw_sprite(tile, &sprite);
+    }
+    return count * sprite.w * sprite.h;
+}
+
+static size_t run_draw_sprite_blend(gfx_pixtile *tile, size_t count)
+{
+    gfx_sprite sprite = {
+        .pixels       = sprite_pixels,
+        .alpha        = sprite_alpha,
+        .w            = 50,
+        .h            = 20,
+        .stride       = 50,
+        .alpha_stride = 50,
+    };
+    for (size_t i = 0; i < count; i++) {
+        sprite.x = sprite_offsets[i % SAMPLE_COUNT].x;
+        sprite.y = sprite_offsets[i % SAMPLE_COUNT].y;
+        gfx_draw_sprite_blend(tile, &sprite, 0xC0);
+    }
+    return count * sprite.w * sprite.h;
+}
+
+static size_t run_draw_rle_image(gfx_pixtile *tile, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        gfx_draw_rle_image(tile, &rle_sprite,
+                           sprite_offsets[i % SAMPLE_COUNT]);
+    return count * rle_sprite.w * rle_sprite.h;
+}
+
+// A 24x16 view magnified to 240x160, like a pixel inspector, and
+// scaled by a fraction.
+#define DEFINE_BLIT_SCALED_RUNNER(suffix, sw, sh, dw, dh, filter)        \
+    static size_t run_blit_scaled_##suffix(gfx_pixtile *tile,           \
+                                           size_t count)                \
+    {                                                                   \
+        gfx_pixtile src;                                                \
+        gfx_init_pixtile(&src, frame_pixels, 0, 0, sw, sh, LCD_WIDTH);  \
+        for (size_t i = 0; i < count; i++)                              \
+            gfx_blit_scaled(tile, &src, 0, tile->y - i % 24,            \
+                            dw, dh, filter);                            \
+        return count * tile->w * tile->h;                               \
+    }
+
+DEFINE_BLIT_SCALED_RUNNER(zoom_nearest,   24, 16, 240, 160, GFX_FILTER_NEAREST)
+DEFINE_BLIT_SCALED_RUNNER(zoom_bilinear,  24, 16, 240, 160, GFX_FILTER_BILINEAR)
+DEFINE_BLIT_SCALED_RUNNER(ratio_nearest,  90, 60, 240, 160, GFX_FILTER_NEAREST)
+DEFINE_BLIT_SCALED_RUNNER(ratio_bilinear, 90, 60, 240, 160, GFX_FILTER_BILINEAR)
+
+static size_t run_copy_pixtile_frame(gfx_pixtile *tile, size_t count)
+{
+    gfx_ipoint offset = {{ .x = tile->x, .y = tile->y }};
+    for (size_t i = 0; i < count; i++)
+        gfx_copy_pixtile(tile, &frame_tile, offset);
+    return count * tile->w * tile->h;
+}
+
+// A tile's worth of an indexed frame, as lcd_send_indexed expands it.
+#define DEFINE_EXPAND_INDEXED_RUNNER(bpp)                               \
+    static size_t run_expand_indexed_##bpp(gfx_pixtile *tile,           \
+                                           size_t count)                \
+    {                                                                   \
+        for (size_t i = 0; i < count; i++)                              \
+            gfx_expand_indexed(tile, &indexed_frame_##bpp);             \
+        return count * tile->w * tile->h;                               \
+    }
+
+DEFINE_EXPAND_INDEXED_RUNNER(8)
+DEFINE_EXPAND_INDEXED_RUNNER(4)
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Display list
+
+static void draw_scene(gfx_pixtile *tile)
+{
+    for (size_t i = 0; i < SCENE_CALLS; i++) {
+        const scene_call *sc = &scene_calls[i];
+        switch (sc->kind) {
+
+            case 0:
+                gfx_fill_rect(tile, sc->a, sc->b, sc->c, sc->d, sc->color);
+                break;
+            case 1:
+                gfx_draw_line_aa(tile, sc->a, sc->b,
+                                 sc->a + sc->c, sc->b + sc->d, sc->color);
+                break;
+            default:
+                gfx_fill_circle_aa(tile, sc->a, sc->b, sc->c / 2, sc->color);
+                break;
+        }
+    }
+}
+
+static void record_scene(void)
+{
+    gfx_clear_display_list();
+    for (size_t i = 0; i < SCENE_CALLS; i++) {
+        const scene_call *sc = &scene_calls[i];
+        switch (sc->kind) {
+
+            case 0:
+                gfx_record_fill_rect(sc->a, sc->b, sc->c, sc->d, sc->color);
+                break;
+            case 1:
+                gfx_record_draw_line_aa(sc->a, sc->b,
+                                        sc->a + sc->c, sc->b + sc->d,
+                                        sc->color);
+                break;
+            default:
+                gfx_record_fill_circle_aa(sc->a, sc->b, sc->c / 2, sc->color);
+                break;
+        }
+    }
+}
+
+// The whole scene submitted to the tile, as draw_tile does without a
+// display list.
+static size_t run_draw_scene_direct(gfx_pixtile *tile, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        draw_scene(tile);
+    return count * tile->w * tile->h;
+}
+
+static size_t run_replay_display_list(gfx_pixtile *tile, size_t count)
+{
+    record_scene();
+    for (size_t i = 0; i < count; i++)
+        gfx_replay_display_list(tile);
+    return count * tile->w * tile->h;
+}
+
+static size_t run_record(gfx_pixtile *tile, size_t count)
+{
+    (void)tile;
+    for (size_t i = 0; i < count; i++)
+        record_scene();
+    return 0;
+}
+
+// One call moves a pixel each frame, back and forth.
+static size_t run_damage_display_list(gfx_pixtile *tile, size_t count)
+{
+    (void)tile;
+    gfx_region damage;
+    for (size_t i = 0; i < count; i++) {
+        scene_calls[i / 2 % SCENE_CALLS].a += i & 1 ? -1 : +1;
+        record_scene();
+        gfx_region_clear(&damage);
+        gfx_damage_display_list(&damage);
+    }
+    return 0;
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Driver
+
+static const bench_case bench_cases[] = {
+    { "gfx_fill_pixel",                 "1x1",    "pixels",
+      run_fill_pixel                                               },
+    { "gfx_fill_pixel_blend",           "1x1",    "pixels",
+      run_fill_pixel_blend                                         },
+    { "gfx_fill_pixel_unclipped",       "1x1",    "pixels",
+      run_fill_pixel_unclipped                                     },
+    { "gfx_fill_pixel_blend_unclipped", "1x1",    "pixels",
+      run_fill_pixel_blend_unclipped                               },
+
+    { "gfx_fill_span",                  "240x1",  "spans",
+      run_fill_span_wide                                           },
+    { "gfx_fill_span",                  "16x1",   "spans",
+      run_fill_span_narrow                                         },
+    { "gfx_fill_span_blend",            "240x1",  "spans",
+      run_fill_span_blend_wide                                     },
+    { "gfx_fill_span_blend",            "16x1",   "spans",
+      run_fill_span_blend_narrow                                   },
+    { "gfx_fill_span_unclipped",        "240x1",  "spans",
+      run_fill_span_unclipped_wide                                 },
+    { "gfx_fill_span_unclipped",        "16x1",   "spans",
+      run_fill_span_unclipped_narrow                               },
+    { "gfx_fill_span_blend_unclipped",  "240x1",  "spans",
+      run_fill_span_blend_unclipped_wide                           },
+    { "gfx_fill_span_blend_unclipped",  "16x1",   "spans",
+      run_fill_span_blend_unclipped_narrow                         },
+
+    { "gfx_draw_line",                  "screen", "lines",
+      run_draw_line_screen                                         },
+    { "gfx_draw_line",                  "16",     "lines",
+      run_draw_line_short                                          },
+    { "gfx_draw_line_aa",               "screen", "lines",
+      run_draw_line_aa_screen                                      },
+    { "gfx_draw_line_aa",               "16",     "lines",
+      run_draw_line_aa_short                                       },
+    { "gfx_draw_line_blend",            "screen", "lines",
+      run_draw_line_blend_screen                                   },
+    { "gfx_draw_line_aa_blend",         "screen", "lines",
+      run_draw_line_aa_blend_screen                                },
+    { "gfx_draw_line_unclipped",        "tile",   "lines",
+      run_draw_line_unclipped_tile                                 },
+    { "gfx_draw_line_aa_unclipped",     "tile",   "lines",
+      run_draw_line_aa_unclipped_tile                              },
+    { "gfx_draw_line_blend_unclipped",  "tile",   "lines",
+      run_draw_line_blend_unclipped_tile                           },
+    { "gfx_draw_line_aa_blend_unclipped", "tile", "lines",
+      run_draw_line_aa_blend_unclipped_tile                        },
+    { "ref_draw_line_float",            "screen", "lines",
+      run_ref_draw_line_float_screen                               },
+    { "ref_draw_line_float",            "16",     "lines",
+      run_ref_draw_line_float_short                                },
+    { "ref_draw_line_aa_float",         "screen", "lines",
+      run_ref_draw_line_aa_float_screen                            },
+    { "ref_draw_line_aa_float",         "16",     "lines",
+      run_ref_draw_line_aa_float_short                             },
+
+    { "gfx_fill_trapezoids",            "screen", "trapezoids",
+      run_fill_trapezoids_screen                                   },
+    { "gfx_fill_trapezoids_aa",         "screen", "trapezoids",
+      run_fill_trapezoids_aa_screen                                },
+    { "gfx_fill_trapezoids_blend",      "screen", "trapezoids",
+      run_fill_trapezoids_blend_screen                             },
+    { "gfx_fill_trapezoids_aa_blend",   "screen", "trapezoids",
+      run_fill_trapezoids_aa_blend_screen                          },
+    { "gfx_fill_trapezoids_unclipped",  "tile",   "trapezoids",
+      run_fill_trapezoids_unclipped_tile                           },
+    { "gfx_fill_trapezoids_aa_unclipped", "tile", "trapezoids",
+      run_fill_trapezoids_aa_unclipped_tile                        },
+    { "gfx_fill_trapezoids_blend_unclipped", "tile", "trapezoids",
+      run_fill_trapezoids_blend_unclipped_tile                     },
+    { "gfx_fill_trapezoids_aa_blend_unclipped", "tile", "trapezoids",
+      run_fill_trapezoids_aa_blend_unclipped_tile                  },
+
+    { "gfx_fill_triangle",              "screen", "triangles",
+      run_fill_triangle_screen                                     },
+    { "gfx_fill_triangle_aa",           "screen", "triangles",
+      run_fill_triangle_aa_screen                                  },
+    { "gfx_fill_triangle_blend",        "screen", "triangles",
+      run_fill_triangle_blend_screen                               },
+    { "gfx_fill_triangle_aa_blend",     "screen", "triangles",
+      run_fill_triangle_aa_blend_screen                            },
+    { "gfx_fill_triangle_unclipped",    "tile",   "triangles",
+      run_fill_triangle_unclipped_tile                             },
+    { "gfx_fill_triangle_aa_unclipped", "tile",   "triangles",
+      run_fill_triangle_aa_unclipped_tile                          },
+    { "gfx_fill_triangle_blend_unclipped", "tile", "triangles",
+      run_fill_triangle_blend_unclipped_tile                       },
+    { "gfx_fill_triangle_aa_blend_unclipped", "tile", "triangles",
+      run_fill_triangle_aa_blend_unclipped_tile                    },
+
+    { "gfx_fill_rect",                  "screen", "rects",
+      run_fill_rect                                                },
+    { "gfx_fill_rect_aa",               "screen", "rects",
+      run_fill_rect_aa                                             },
+    { "gfx_fill_rect_blend",            "screen", "rects",
+      run_fill_rect_blend                                          },
+    { "gfx_fill_rect_aa_blend",         "screen", "rects",
+      run_fill_rect_aa_blend                                       },
+    { "gfx_fill_rect_gradient",         "vertical", "rects",
+      run_fill_rect_gradient_vertical                              },
+    { "gfx_fill_rect_gradient",         "diagonal", "rects",
+      run_fill_rect_gradient_diagonal                              },
+    { "gfx_fill_rect_gradient",         "diagonal ramp", "rects",
+      run_fill_rect_gradient_diagonal_ramp                         },
+    { "gfx_fill_rect_gradient",         "radial", "rects",
+      run_fill_rect_gradient_radial                                },
+    { "gfx_fill_rect_gradient",         "radial ramp", "rects",
+      run_fill_rect_gradient_radial_ramp                           },
+    { "gfx_fill_rect_blend",            "dithered", "rects",
+      run_fill_rect_blend_dithered                                 },
+    { "gfx_fill_rect_gradient",         "diagonal dithered", "rects",
+      run_fill_rect_gradient_diagonal_dithered                     },
+    { "gfx_fill_rect_gradient",         "radial dithered", "rects",
+      run_fill_rect_gradient_radial_dithered                       },
+
+    { "gfx_fill_circle",                "screen", "circles",
+      run_fill_circle                                              },
+    { "gfx_fill_circle_aa",             "screen", "circles",
+      run_fill_circle_aa                                           },
+    { "gfx_fill_circle_aa_blend",       "screen", "circles",
+      run_fill_circle_aa_blend                                     },
+    { "gfx_fill_ellipse",               "screen", "ellipses",
+      run_fill_ellipse                                             },
+    { "gfx_fill_ellipse_aa",            "screen", "ellipses",
+      run_fill_ellipse_aa                                          },
+    { "gfx_draw_arc",                   "screen", "arcs",
+      run_draw_arc                                                 },
+    { "gfx_draw_arc_aa",                "screen", "arcs",
+      run_draw_arc_aa                                              },
+
+    { "gfx_draw_path",                  "gauge",  "paths",
+      run_draw_path_gauge                                          },
+    { "gfx_draw_path_aa",               "gauge",  "paths",
+      run_draw_path_aa_gauge                                       },
+
+    { "gfx_fill_polygon",               "star",   "polygons",
+      run_fill_polygon_star                                        },
+    { "gfx_fill_polygon_aa",            "star",   "polygons",
+      run_fill_polygon_aa_star                                     },
+    { "gfx_fill_polygon_aa_blend",      "star",   "polygons",
+      run_fill_polygon_aa_blend_star                               },
+
+    { "gfx_stroke_polyline",            "trend",  "polylines",
+      run_stroke_polyline_trend                                    },
+    { "gfx_stroke_polyline_aa",         "trend",  "polylines",
+      run_stroke_polyline_aa_trend                                 },
+    { "gfx_stroke_polyline_aa_blend",   "trend",  "polylines",
+      run_stroke_polyline_aa_blend_trend                           },
+
+    { "gfx_fill_mask",                  "48x48",  "masks",
+      run_fill_mask                                                },
+    { "gfx_fill_mask_blend",            "48x48",  "masks",
+      run_fill_mask_blend                                          },
+    { "gfx_fill_mask_lcd",              "48x48",  "masks",
+      run_fill_mask_lcd                                            },
+    { "gfx_fill_mask_blend_lcd",        "48x48",  "masks",
+      run_fill_mask_blend_lcd                                      },
+
+    { "gfx_draw_text",                  "8x11",   "strings",
+      run_draw_text                                                },
+    { "gfx_draw_text_blend",            "8x11",   "strings",
+      run_draw_text_blend                                          },
+    { "gfx_draw_outline_text",          "cached", "strings",
+      run_draw_outline_text_cached                                 },
+    { "gfx_draw_outline_text",          "uncached", "strings",
+      run_draw_outline_text_uncached                               },
+
+    { "gfx_copy_pixtile",               "50x20",  "copies",
+      run_copy_pixtile_sprite                                      },
+    { "gfx_copy_pixtile_keyed",         "50x20",  "copies",
+      run_copy_pixtile_keyed                                       },
+    { "gfx_draw_sprite",                "50x20",  "sprites",
+      run_draw_sprite                                              },
+    { "gfx_draw_sprite_blend",          "50x20",  "sprites",
+      run_draw_sprite_blend                                        },
+    { "gfx_draw_rle_image",             "50x20",  "images",
+      run_draw_rle_image                                           },
+    { "gfx_copy_pixtile",               "240x136", "copies",
+      run_copy_pixtile_frame                                       },
+    { "gfx_blit_scaled",                "10x nearest", "blits",
+      run_blit_scaled_zoom_nearest                                 },
+    { "gfx_blit_scaled",                "10x bilinear", "blits",
+      run_blit_scaled_zoom_bilinear                                },
+    { "gfx_blit_scaled",                "8/3 nearest", "blits",
+      run_blit_scaled_ratio_nearest                                },
+    { "gfx_blit_scaled",                "8/3 bilinear", "blits",
+      run_blit_scaled_ratio_bilinear                               },
+    { "gfx_expand_indexed",             "8 bit",  "frames",
+      run_expand_indexed_8                                         },
+    { "gfx_expand_indexed",             "4 bit",  "frames",
+      run_expand_indexed_4                                         },
+
+    { "gfx_replay_display_list",        "300 direct", "tiles",
+      run_draw_scene_direct                                        },
+    { "gfx_replay_display_list",        "300 calls", "tiles",
+      run_replay_display_list                                      },
+    { "gfx_record",                     "300 calls", "frames",
+      run_record                                                   },
+    { "gfx_damage_display_list",        "300 calls", "frames",
+      run_damage_display_list                                      },
+};
+
+static const size_t bench_case_count =
+    (&bench_cases)[1] - bench_cases;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void run_case(const bench_case *bc, double min_seconds, double hz)
+{
+    gfx_pixtile *tile = &bench_tile;
+
+    // Warm up.
+    (*bc->run)(tile, BATCH_SIZE);
+
+    size_t ops = 0, pixels = 0;
+    double t0 = now(), t1;
+    do {
+        pixels += (*bc->run)(tile, BATCH_SIZE);
+        ops += BATCH_SIZE;
+        t1 = now();
+    } while (t1 - t0 < min_seconds);
+
+    double seconds = t1 - t0;
+    printf("{\"name\": \"%s\", "
+           "\"shape\": \"%s\", "
+           "\"tile\": \"%zux%zu\", "
+           "\"unit\": \"%s\", "
+           "\"ops\": %zu, "
+           "\"pixels\": %zu, "
+           "\"seconds\": %.6f, "
+           "\"ops_per_sec\": %.1f, "
+           "\"pixels_per_sec\": %.1f, "
+           "\"ns_per_pixel\": %.4f",
+           bc->name, bc->shape,
+           tile->w, tile->h,
+           bc->unit,
+           ops, pixels, seconds,
+           ops / seconds,
+           pixels / seconds,
+           pixels ? seconds * 1e9 / pixels : 0.0);
+    if (hz)
+        printf(", \"cycles_per_pixel\": %.2f",
+               pixels ? seconds * hz / pixels : 0.0);
+    printf("}\n");
+    fflush(stdout);
+}
+
+static bool case_is_selected(const bench_case *bc,
+                             int pattern_count, char **patterns)
+{
+    if (pattern_count == 0)
+        return true;
+    for (int i = 0; i < pattern_count; i++)
+        if (strstr(bc->name, patterns[i]))
+            return true;
+    return false;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-f hz] [-t seconds] [pattern ...]\n", prog);
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    double min_seconds = 0.25;
+    double hz = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:t:")) != -1) {
+        switch (opt) {
+
+            case 'f':
+                errno = 0;
+                hz = strtod(optarg, NULL);
+                if (errno || hz <= 0)
+                    usage(argv[0]);
+                break;
+
+            case 't':
+                errno = 0;
+                min_seconds = strtod(optarg, NULL);
+                if (errno || min_seconds <= 0)
+                    usage(argv[0]);
+                break;
+
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    init_tiles();
+    init_samples();
+
+    for (size_t i = 0; i < bench_case_count; i++) {
+        const bench_case *bc = &bench_cases[i];
+        if (case_is_selected(bc, argc - optind, argv + optind))
+            run_case(bc, min_seconds, hz);
+    }
+    return 0;
+}
@@ -0,0 +1,371 @@
+#include "reference.h"
+
+#include <stdbool.h>
+
+#include <gfx-pixtile.h>
+#include <math-util.h>
+
+// Reference implementations of the line primitives, kept so
+// gfx-bench can compare them against the library's.
+//
+// These are the clipped float line rasterizers that libgfx used
+// before its lines moved to fixed point.  They step the minor axis
+// coordinate in float and take FLOOR and FRAC of it at every pixel.
+
+typedef enum variant_flags {
+    VF_AA        = 1 << 0,
+    VF_BLEND     = 1 << 1,
+    VF_UNCLIPPED = 1 << 2,
+} variant_flags;
+
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+
+static gfx_rgb565 blend_pixel(gfx_rgb565 dest, gfx_rgb888 src, gfx_alpha8 alpha)
+{
+    uint32_t dr5 = dest >> 11 & 0x1f;
+    uint32_t dg5 = dest >>  5 & 0x3f;
+    uint32_t db5 = dest >>  0 & 0x1f;
+    uint32_t dr8 = dr5 << 3 | dr5 >> 2;
+    uint32_t dg8 = dg5 << 2 | dg5 >> 4;
+    uint32_t db8 = db5 << 3 | db5 >> 2;
+    uint32_t sr8 = src >> 16 & 0xFF;
+    uint32_t sg8 = src >>  8 & 0xFF;
+    uint32_t sb8 = src >>  0 & 0xFF;
+    dr8 += (sr8 - dr8) * (alpha * 0x8081) >> 23; // divide by 255
+    dg8 += (sg8 - dg8) * (alpha * 0x8081) >> 23;
+    db8 += (sb8 - db8) * (alpha * 0x8081) >> 23;
+    return (dr8 << 8 & 0xf800) | (dg8 << 3 & 0x07e0) | (db8 >> 3 & 0x001f);
+}
+
+static ALWAYS_INLINE void fill_run(gfx_rgb565 *p, size_t count,
+                                   gfx_rgb888 color)
+{
+    while (count--)
+        *p++ = color;
+}
+
+static ALWAYS_INLINE void blend_run(gfx_rgb565 *p, size_t count,
+                                    gfx_rgb888 color, gfx_alpha8 alpha)
+{
+    while (count--) {
+        *p = blend_pixel(*p, color, alpha);
+        p++;
+    }
+}
+
+static ALWAYS_INLINE void fill_or_blend_run(gfx_rgb565 *p, size_t count,
+                                            gfx_rgb888 color,
+                                            gfx_alpha8 alpha)
+{
+    if (alpha == 0xFF)
+        fill_run(p, count, color);
+    else if (alpha)
+        blend_run(p, count, color, alpha);
+}
+
+// Lines are rasterized in major/minor axis coordinates: i runs along
+// the major axis, one pixel per step, and j along the minor axis.
+// Steep lines have y as the major axis.
+
+static ALWAYS_INLINE gfx_rgb565 *line_pixel_address(gfx_pixtile *tile,
+                                                    bool steep,
+                                                    int i, int j)
+{
+    if (steep)
+        return gfx_pixel_address_unchecked(tile, j, i);
+    else
+        return gfx_pixel_address_unchecked(tile, i, j);
+}
+
+static ALWAYS_INLINE void plot(gfx_rgb565 *p,
+                               gfx_rgb888 color,
+                               gfx_alpha8 alpha,
+                               variant_flags flags)
+{
+    if (flags & VF_BLEND)
+        *p = blend_pixel(*p, color, alpha);
+    else
+        *p = color;
+}
+
+// Combine antialiasing coverage with the blend alpha.
+static ALWAYS_INLINE gfx_alpha8 line_alpha(int coverage,
+                                           gfx_alpha8 alpha,
+                                           variant_flags flags)
+{
+    if (flags & VF_BLEND)
+        return coverage * alpha * 0x8081 >> 23; // divide by 255
+    return coverage;
+}
+
+// Liang-Barsky.  Clip the segment from (x0, y0) to (x0 + dx, y0 + dy)
+// to the rectangle [min_x, max_x] x [min_y, max_y].  On entry, *t0
+// and *t1 are the parameter range; on exit, they're narrowed to the
+// part inside the rectangle.  Returns false if no part is inside.
+static bool clip_line(float x0, float y0,
+                      float dx, float dy,
+                      float min_x, float min_y,
+                      float max_x, float max_y,
+                      float *t0, float *t1)
+{
+    const float p[4] = { -dx, +dx, -dy, +dy };
+    const float q[4] = { x0 - min_x, max_x - x0, y0 - min_y, max_y - y0 };
+    for (size_t k = 0; k < 4; k++) {
+        if (p[k] == 0) {
+            if (q[k] < 0)
+                return false;   // parallel and outside
+        } else {
+            float r = q[k] / p[k];
+            if (p[k] < 0) {
+                if (r > *t1)
+                    return false;
+                if (r > *t0)
+                    *t0 = r;
+            } else {
+                if (r < *t0)
+                    return false;
+                if (r < *t1)
+                    *t1 = r;
+            }
+        }
+    }
+    return true;
+}
+
+// Bounds of the tile in major/minor axis coordinates.
+typedef struct line_bounds {
+    int min_i, max_i;
+    int min_j, max_j;
+} line_bounds;
+
+static ALWAYS_INLINE line_bounds tile_line_bounds(const gfx_pixtile *tile,
+                                                  bool steep)
+{
+    int min_x = tile->x, max_x = min_x + tile->w;
+    int min_y = tile->y, max_y = min_y + tile->h;
+    if (steep)
+        return (line_bounds) { min_y, max_y, min_x, max_x };
+    else
+        return (line_bounds) { min_x, max_x, min_y, max_y };
+}
+
+// Clip the major axis pixel range [*i0, *i1] of the line from (x0, y0)
+// with slope dy/dx to the part whose minor axis coordinate, padded by
+// pad_j pixels, is inside the bounds.  The result is conservative by
+// a pixel at either end; callers check the minor axis there.
+static ALWAYS_INLINE bool clip_line_range(const line_bounds *b,
+                                          float x0, float y0,
+                                          float dx, float dy,
+                                          int pad_j,
+                                          int *i0, int *i1)
+{
+    // Trivially accept lines well inside the bounds.  (x0 <= x1.)
+    float y1 = y0 + dy;
+    if (b->min_i + 1 <= x0 && x0 + dx < b->max_i - 1 &&
+        b->min_j + 1 <= MIN(y0, y1) && MAX(y0, y1) < b->max_j - 1)
+        return *i0 <= *i1;
+
+    float t0 = 0, t1 = 1;
+    if (!clip_line(x0, y0, dx, dy,
+                   b->min_i, b->min_j - pad_j,
+                   b->max_i, b->max_j,
+                   &t0, &t1))
+        return false;
+    *i0 = MAX(*i0, MAX(b->min_i,     FLOOR(x0 + t0 * dx) - 1));
+    *i1 = MIN(*i1, MIN(b->max_i - 1, FLOOR(x0 + t1 * dx) + 1));
+    return *i0 <= *i1;
+}
+
+static ALWAYS_INLINE void draw_line(gfx_pixtile *tile,
+                                    float x0, float y0,
+                                    float x1, float y1,
+                                    gfx_rgb888 color,
+                                    gfx_alpha8 alpha,
+                                    variant_flags flags)
+{
+    if ((flags & VF_BLEND) && alpha == 0)
+        return;
+
+    bool steep = ABS(y1 - y0) > ABS(x1 - x0);
+    if (steep) {
+        float t0 = x0; x0 = y0; y0 = t0;
+        float t1 = x1; x1 = y1; y1 = t1;
+    }
+    if (x1 < x0) {
+        float xt = x0; x0 = x1; x1 = xt;
+        float yt = y0; y0 = y1; y1 = yt;
+    }
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    float slope = dx ? dy / dx : 0;
+    int i0 = FLOOR(x0);
+    int i1 = FLOOR(x1);
+    line_bounds b = tile_line_bounds(tile, steep);
+
+    if (dy == 0) {
+
+        // Axis aligned: a span or a column.
+
+        int j = FLOOR(y0);
+        if (!(flags & VF_UNCLIPPED)) {
+            if (j < b.min_j || j >= b.max_j)
+                return;
+            i0 = MAX(i0, b.min_i);
+            i1 = MIN(i1, b.max_i - 1);
+        }
+        if (i0 > i1)
+            return;
+        gfx_rgb565 *p = line_pixel_address(tile, steep, i0, j);
+        if (!steep) {
+            if (flags & VF_BLEND)
+                fill_or_blend_run(p, i1 - i0 + 1, color, alpha);
+            else
+                fill_run(p, i1 - i0 + 1, color);
+        } else {
+            for (int i = i0; i <= i1; i++, p += tile->stride)
+                plot(p, color, alpha, flags);
+        }
+        return;
+    }
+
+    // Sample the line at each pixel center along the major axis.
+    // Pixel center sampling can step one pixel outside the clipped
+    // segment at either end, so trim those.
+    if (!(flags & VF_UNCLIPPED)) {
+        if (!clip_line_range(&b, x0, y0, dx, dy, 0, &i0, &i1))
+            return;
+        while (i0 <= i1) {
+            int j = FLOOR(y0 + (i0 + 0.5f - x0) * slope);
+            if (b.min_j <= j && j < b.max_j)
+                break;
+            i0++;
+        }
+        while (i0 <= i1) {
+            int j = FLOOR(y0 + (i1 + 0.5f - x0) * slope);
+            if (b.min_j <= j && j < b.max_j)
+                break;
+            --i1;
+        }
+    }
+    float y = y0 + (i0 + 0.5f - x0) * slope;
+    for (int i = i0; i <= i1; i++) {
+        plot(line_pixel_address(tile, steep, i, FLOOR(y)),
+             color, alpha, flags);
+        y += slope;
+    }
+}
+
+// Plot a pixel of an antialiased line's endpoint.  There are only
+// four per line, so check bounds here instead of clipping.
+static ALWAYS_INLINE void plot_line_end_aa(gfx_pixtile *tile,
+                                           bool steep,
+                                           int i, int j,
+                                           gfx_rgb888 color,
+                                           int coverage,
+                                           gfx_alpha8 alpha,
+                                           variant_flags flags)
+{
+    gfx_rgb565 *p;
+    if (flags & VF_UNCLIPPED)
+        p = line_pixel_address(tile, steep, i, j);
+    else if (steep)
+        p = gfx_pixel_address(tile, j, i);
+    else
+        p = gfx_pixel_address(tile, i, j);
+    if (p)
+        *p = blend_pixel(*p, color, line_alpha(coverage, alpha, flags));
+}
+
+// Line, anti-aliased using Xiaolin Wu's algorithm
+static ALWAYS_INLINE void draw_line_aa(gfx_pixtile *tile,
+                                       float x0, float y0,
+                                       float x1, float y1,
+                                       gfx_rgb888 color,
+                                       gfx_alpha8 alpha,
+                                       variant_flags flags)
+{
+    // Cribbed directly from en.wikipedia.org/wiki/Xiaolin_Wu%27s_line_algorithm
+
+    if ((flags & VF_BLEND) && alpha == 0)
+        return;
+
+    bool steep = ABS(y1 - y0) > ABS(x1 - x0);
+    if (steep) {
+        float t0 = x0; x0 = y0; y0 = t0;
+        float t1 = x1; x1 = y1; y1 = t1;
+    }
+    if (x1 < x0) {
+        float xt = x0; x0 = x1; x1 = xt;
+        float yt = y0; y0 = y1; y1 = yt;
+    }
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    if (dx == 0)
+        return;                 // x0 == x1, y0 == y1, ∴ no line
+    float gradient = dy / dx;
+
+    // handle first endpoint
+    float xend = ROUND(x0);
+    float yend = y0 + gradient * (xend - x0);
+    float xgap = 255.0f * RFRAC(x0 + 0.5f);
+    int xpxl1 = xend;
+    int ypxl1 = FLOOR(yend);
+    plot_line_end_aa(tile, steep, xpxl1, ypxl1,
+                     color, RFRAC(yend) * xgap, alpha, flags);
+    plot_line_end_aa(tile, steep, xpxl1, ypxl1 + 1,
+                     color, FRAC(yend) * xgap, alpha, flags);
+    float intery = yend + gradient; // first y-intersection for the main loop
+
+    // handle second endpoint
+    xend = ROUND(x1);
+    yend = y1 + gradient * (xend - x1);
+    xgap = 255.0f * FRAC(x1 + 0.5f);
+    int xpxl2 = xend;
+    int ypxl2 = FLOOR(yend);
+    plot_line_end_aa(tile, steep, xpxl2, ypxl2,
+                     color, RFRAC(yend) * xgap, alpha, flags);
+    plot_line_end_aa(tile, steep, xpxl2, ypxl2 + 1,
+                     color, FRAC(yend) * xgap, alpha, flags);
+
+    // main loop
+    int i0 = xpxl1 + 1;
+    int i1 = xpxl2 - 1;
+    line_bounds b = tile_line_bounds(tile, steep);
+    if (!(flags & VF_UNCLIPPED)) {
+        // Each step touches j and j + 1, so pad the minor axis by one.
+        if (!clip_line_range(&b, x0, y0, dx, dy, 1, &i0, &i1))
+            return;
+        intery += gradient * (i0 - (xpxl1 + 1));
+    }
+    for (int i = i0; i <= i1; i++) {
+        int j = FLOOR(intery);
+        int f = 256.0f * FRAC(intery);
+        if ((flags & VF_UNCLIPPED) || (unsigned)(j - b.min_j) <
+                                      (unsigned)(b.max_j - b.min_j)) {
+            gfx_rgb565 *p = line_pixel_address(tile, steep, i, j);
+            *p = blend_pixel(*p, color, line_alpha(255 - f, alpha, flags));
+        }
+        if ((flags & VF_UNCLIPPED) || (unsigned)(j + 1 - b.min_j) <
+                                      (unsigned)(b.max_j - b.min_j)) {
+            gfx_rgb565 *p = line_pixel_address(tile, steep, i, j + 1);
+            *p = blend_pixel(*p, color, line_alpha(f, alpha, flags));
+        }
+        intery += gradient;
+    }
+}
+
+void ref_draw_line_float(gfx_pixtile *tile,
+                         float x0, float y0,
+                         float x1, float y1,
+                         gfx_rgb888 color)
+{
+    draw_line(tile, x0, y0, x1, y1, color, 0xFF, 0);
+}
+
+void ref_draw_line_aa_float(gfx_pixtile *tile,
+                            float x0, float y0,
+                            float x1, float y1,
+                            gfx_rgb888 color)
+{
+    draw_line_aa(tile, x0, y0, x1, y1, color, 0xFF, VF_AA);
+}
@@ -0,0 +1,17 @@
+#ifndef REFERENCE_included
+#define REFERENCE_included
+
+#include <gfx-types.h>
+
+// Float line rasterizers, for comparison.  See reference.c.
+
+extern void ref_draw_line_float                    (gfx_pixtile *tile,
+                                                    float x0, float y0,
+                                                    float x1, float y1,
+                                                    gfx_rgb888 color);
+extern void ref_draw_line_aa_float                 (gfx_pixtile *tile,
+                                                    float x0, float y0,
+                                                    float x1, float y1,
+                                                    gfx_rgb888 color);
+
+#endif /* !REFERENCE_included */
@@ -13,16 +13,16 @@
 
 #define MY_CLOCK (rcc_hse_25mhz_3v3[RCC_CLOCK_3V3_168MHZ])
 
-#define BLACK_565  0x0000
-#define WHITE_565  0xFFFF
-#define GRAY50_565 0x7BEF
-#define GRAY88_565 0xE71C
-#define RED_565    0xF800
-#define GREEN_565  0x07E0
-#define BLUE_565   0x001F
+#define BLACK      0x000000
+#define WHITE      0xFFFFFF
+#define GRAY50     0x7F7F7F
+#define GRAY88     0xE0E0E0
+#define RED        0xFF0000
+#define GREEN      0x00FF00
+#define BLUE       0x0000FF
 
-#define BG_COLOR   GRAY88_565
-#define STOPLIGHT_COLOR 0x7BE0
+#define BG_COLOR   GRAY88
+#define STOPLIGHT_COLOR 0x7F7F00
 
 uint32_t fps;
 
@@ -50,7 +50,7 @@ static void setup(void)
 
     init_buttons();
 
-    lcd_set_bg_color(BG_COLOR, false);
+    lcd_set_bg_color(gfx_rgb888_to_rgb565(BG_COLOR), false);
     lcd_init();
 
     touch_init();
@@ -85,61 +85,24 @@ static void animate(void)
     }
 }
 
-// XXX this should be a gfx primitive.
-static void fill_circle(gfx_pixtile *tile,
-                        gfx_point *const center,
-                        float radius,
-                        gfx_rgb565 color)
-{
-    int x = radius;
-    int y = 0;
-    int err = 0;
-    while (x >= y) {
-        gfx_fill_span(tile, center->x - x, center->x + x, center->y + y, color);
-        if (y)
-            gfx_fill_span(tile,
-                          center->x - x, center->x + x, center->y - y,
-                          color);
-        if (err <= 0) {
-            y++;
-            err += 2 * y + 1;
-        }
-        if (err > 0) {
-            --x;
-            if (x > y) {
-            gfx_fill_span(tile,
-                          center->x - y, center->x + y, center->y - x,
-                          color);
-            gfx_fill_span(tile,
-                          center->x - y, center->x + y, center->y + x,
-                          color);
-            }
-            err -= 2 * x + 1;
-        }
-    }
-}
-
 static void draw_stoplight(gfx_pixtile *tile, int x, int y, bool go)
 {
     // cheap stoplight: yellow rectangle, two circles.
 
     // outline rectangle
-    gfx_draw_line(tile, x - 30, y - 60, x + 30, y - 60, BLACK_565);
-    gfx_draw_line(tile, x - 30, y - 60, x - 30, y + 60, BLACK_565);
-    gfx_draw_line(tile, x - 30, y + 60, x + 30, y + 60, BLACK_565);
-    gfx_draw_line(tile, x + 30, y - 60, x + 30, y + 60, BLACK_565);
+    gfx_draw_line(tile, x - 30, y - 60, x + 30, y - 60, BLACK);
+    gfx_draw_line(tile, x - 30, y - 60, x - 30, y + 60, BLACK);
+    gfx_draw_line(tile, x - 30, y + 60, x + 30, y + 60, BLACK);
+    gfx_draw_line(tile, x + 30, y - 60, x + 30, y + 60, BLACK);
 
     // fill rectangle
-    for (int iy = y - 59; iy < y + 60; iy++)
-        gfx_fill_span(tile, x - 29, x + 30, iy, STOPLIGHT_COLOR);
+    gfx_fill_rect(tile, x - 29, y - 59, 59, 119, STOPLIGHT_COLOR);
 
     // red light
-    gfx_point stop_center = {{ .x = x, .y = y - 30 }};
-    fill_circle(tile, &stop_center, 20, go ? GRAY50_565 : RED_565);
+    gfx_fill_circle(tile, x, y - 30, 20, go ? GRAY50 : RED);
 
     // green light
-    gfx_point go_center = {{ .x = x, .y = y + 30 }};
-    fill_circle(tile, &go_center, 20, go ? GREEN_565 : GRAY50_565);
+    gfx_fill_circle(tile, x, y + 30, 20, go ? GREEN : GRAY50);
 }
 
 // N.B., lower level functions handle all the clipping.  We just
@@ -17,20 +17,20 @@
 
 #define MY_CLOCK (rcc_hse_25mhz_3v3[RCC_CLOCK_3V3_168MHZ])
 
-#define BLACK_565  0x0000
-#define WHITE_565  0xFFFF
-#define GRAY50_565 0x7BEF
-#define GRAY88_565 0xE71C
-#define RED_565    0xF800
-#define GREEN_565  0x07E0
-#define BLUE_565   0x001F
-
-#define FG_COLOR   WHITE_565
-#define BG_COLOR   GRAY88_565
-#define PIX_COLOR  BLACK_565
-#define LINE_COLOR GREEN_565
-#define P0_COLOR   RED_565
-#define P1_COLOR   BLUE_565
+#define BLACK      0x000000
+#define WHITE      0xFFFFFF
+#define GRAY50     0x7F7F7F
+#define GRAY88     0xE0E0E0
+#define RED        0xFF0000
+#define GREEN      0x00FF00
+#define BLUE       0x0000FF
+
+#define FG_COLOR   WHITE
+#define BG_COLOR   GRAY88
+#define PIX_COLOR  BLACK
+#define LINE_COLOR GREEN
+#define P0_COLOR   RED
+#define P1_COLOR   BLUE
 
 #define ZOOM 10
 #define LEFT (LCD_WIDTH / 4)
@@ -61,7 +61,7 @@ static gfx_point    line_p0;
 static gfx_point    line_p1;
 static uint8_t      line_alpha;
 static drawing_mode line_mode;
-static gfx_rgb565   line_color = PIX_COLOR;
+static gfx_rgb888   line_color = PIX_COLOR;
 static bool         is_touching_screen;
 static gfx_button  *touched_button;
 static bool         button_was_down;
@@ -89,7 +89,8 @@ static void render_tile(void)
 {
     for (int y = 0; y < HEIGHT; y++)
         for (int x = 0; x < WIDTH; x++)
-            *gfx_pixel_address_unchecked(&my_tile, x, y) = FG_COLOR;
+            *gfx_pixel_address_unchecked(&my_tile, x, y) =
+                gfx_rgb888_to_rgb565(FG_COLOR);
 
     gfx_point p0 = zoom_out(line_p0);
     gfx_point p1 = zoom_out(line_p1);
@@ -114,23 +115,23 @@ static void render_tile(void)
             break;
 
         case DRAWING_MODE_BLEND:
-            // gfx_draw_line_blend(&my_tile,
-            //                     p0.x,
-            //                     p0.y,
-            //                     p1.x,
-            //                     p1.y,
-            //                     line_color,
-            //                     line_alpha);
+            gfx_draw_line_blend(&my_tile,
+                                p0.x,
+                                p0.y,
+                                p1.x,
+                                p1.y,
+                                line_color,
+                                line_alpha);
             break;
 
         case DRAWING_MODE_AA_BLEND:
-            // gfx_draw_line_aa_blend(&my_tile,
-            //                        p0.x,
-            //                        p0.y,
-            //                        p1.x,
-            //                        p1.y,
-            //                        line_color,
-            //                        line_alpha);
+            gfx_draw_line_aa_blend(&my_tile,
+                                   p0.x,
+                                   p0.y,
+                                   p1.x,
+                                   p1.y,
+                                   line_color,
+                                   line_alpha);
             break;
 
         default:
@@ -159,7 +160,7 @@ static void setup(void)
 
     setup_systick(MY_CLOCK.ahb_frequency);
 
-    lcd_set_bg_color(BG_COLOR, false);
+    lcd_set_bg_color(gfx_rgb888_to_rgb565(BG_COLOR), false);
     lcd_init();
     touch_init();
 
@@ -250,7 +251,7 @@ static void on_finger_up(void)
 
 static void switch_colors(void)
 {
-    line_color = RED_565;
+    line_color = RED;
     // keep fg and bg at opposite hues.
     // increment hues by 60 degrees.
     // keep S maximized.
@@ -302,19 +303,10 @@ static void animate(void)
     render_tile();
 }
 
-static void fill_rect(gfx_pixtile *tile,
-                      int x, int y,
-                      size_t w, size_t h,
-                      gfx_rgb565 color)
-{
-    for (int iy = y; iy < (ssize_t)(y + h); iy++)
-        gfx_fill_span(tile, x, x + w, iy, color);
-}
-
 static void fill_diamond(gfx_pixtile *tile,
                          gfx_point center,
                          float radius,
-                         gfx_rgb565 color)
+                         gfx_rgb888 color)
 {
     int w = 1;
     int xc = ROUND(center.x);
@@ -330,7 +322,7 @@ static void fill_diamond(gfx_pixtile *tile,
 
 static void draw_crosshairs(gfx_pixtile *tile,
                             gfx_point    center,
-                            gfx_rgb565   color)
+                            gfx_rgb888   color)
 {
     const float x = center.x;
     const float y = center.y;
@@ -341,18 +333,18 @@ static void draw_crosshairs(gfx_pixtile *tile,
 
 static void draw_tile(gfx_pixtile *tile)
 {
-    int iy0 = MAX(0, (tile->y - TOP) / ZOOM);
-    int iy1 = MIN(HEIGHT, (ssize_t)(tile->y + tile->h - TOP + ZOOM - 1) / ZOOM);
-
-    // Draw magnified pixmap.
-    for (int iy = iy0; iy < iy1; iy++) {
-        int y = TOP + iy * ZOOM;
-        for (int ix = 0; ix < WIDTH; ix++) {
-            int x = LEFT + ix * ZOOM;
-            gfx_rgb565 color = *gfx_pixel_address_unchecked(&my_tile, ix, iy);
-            fill_rect(tile, x + 1, y + 1, ZOOM - 1, ZOOM - 1, color);
-        }
-    }
+    // Draw magnified pixmap, then the grid between its pixels.
+    gfx_blit_scaled(tile, &my_tile,
+                    LEFT + 1, TOP + 1,
+                    WIDTH * ZOOM, HEIGHT * ZOOM,
+                    GFX_FILTER_NEAREST);
+    for (int iy = 1; iy <= HEIGHT; iy++)
+        gfx_fill_span(tile,
+                      LEFT + 1, LEFT + 1 + WIDTH * ZOOM, TOP + iy * ZOOM,
+                      BG_COLOR);
+    for (int ix = 1; ix <= WIDTH; ix++)
+        gfx_fill_rect(tile, LEFT + ix * ZOOM, TOP + 1,
+                      1, HEIGHT * ZOOM, BG_COLOR);
 
     // Draw line controls.
     gfx_draw_line(tile, line_p0.x, line_p0.y, line_p1.x, line_p1.y, LINE_COLOR);
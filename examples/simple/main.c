@@ -2,9 +2,10 @@
 #include <libopencm3/stm32/rcc.h>
 
 #include <gfx.h>
+#include <gfx-display-list.h>
+#include <gfx-region.h>
 #include <lcd.h>
 #include <systick.h>
-#include <math-util.h>
 
 // This is about as simple as a libgfx client can be.
 // Draw a rectangular grid of pixels over and over.
@@ -14,12 +15,16 @@
 //   main() sets up, then runs.
 //   run() repeatedly animates and draws a frame.
 //   animate() updates some state.
-//   draw_frame() splits the screen into tiles and draws each.
-//   draw_tile() calls gfx drawing functions.
+//   draw_frame() records the frame's drawing calls, then sends only
+//     the parts of the screen they draw differently from last frame.
+//   draw_grid() and draw_hole() call gfx drawing functions.
+//
+// The grid is the same every frame, so only the hole's old and new
+// boxes are damaged and sent.
 
 #define MY_CLOCK (rcc_hse_25mhz_3v3[RCC_CLOCK_3V3_168MHZ])
-#define FG_COLOR 0xFFE0         // yellow
-#define BG_COLOR 0x001F         // blue
+#define FG_COLOR 0xFFFF00       // yellow
+#define BG_COLOR 0x0000FF       // blue
 
 static int center_y = 160;
 uint32_t   fps;
@@ -33,7 +38,7 @@ static void setup(void)
 
     setup_systick(MY_CLOCK.ahb_frequency);
 
-    lcd_set_bg_color(BG_COLOR, false);
+    lcd_set_bg_color(gfx_rgb888_to_rgb565(BG_COLOR), false);
     lcd_init();
 }
 
@@ -53,37 +58,71 @@ static void animate(void)
     }
 }
 
-static bool is_in_circle(int x, int y)
+static bool is_in_circle(int x, int y, int cy)
 {
     x -= 120;
-    y -= center_y;
+    y -= cy;
     return x * x + y * y <= 50 * 50;
 }
 
-static void draw_tile(gfx_pixtile *tile)
+// The recorded calls' arguments.
+typedef struct grid_args {
+    gfx_rgb888 color;
+} grid_args;
+
+typedef struct hole_args {
+    int        center_y;
+    gfx_rgb888 color;
+} hole_args;
+
+static void draw_grid(gfx_pixtile *tile, const void *args)
+{
+    const grid_args *a = args;
+
+    for (int y = 80; y < 240; y += 3)
+        for (int x = 60; x < 180; x += 2)
+            gfx_fill_pixel(tile, x, y, a->color);
+}
+
+// Uncolor some of the grid's pixels inside the circle.
+static void draw_hole(gfx_pixtile *tile, const void *args)
 {
-    bool in_circle = false;
+    const hole_args *a = args;
 
     for (int y = 80; y < 240; y += 3) {
         for (int x = 60; x < 180; x += 2) {
-            in_circle = is_in_circle(x, y);
-            if (!in_circle || !((x % 3) && !(y % 2)))
-                gfx_fill_pixel(tile, x, y, FG_COLOR);
+            bool in_circle = is_in_circle(x, y, a->center_y);
+            if (in_circle && (x % 3) && !(y % 2))
+                gfx_fill_pixel(tile, x, y, a->color);
         }
     }
 }
 
-static void draw_frame(void)
+static void record_frame(void)
 {
-    size_t h;
+    grid_args grid = { .color = FG_COLOR };
+    hole_args hole = { .center_y = center_y, .color = BG_COLOR };
+    gfx_irect grid_box = { 60, 80, 180, 240 };
+    gfx_irect hole_box = { 70, center_y - 50, 171, center_y + 51 };
+
+    gfx_clear_display_list();
+    gfx_record(grid_box, draw_grid, &grid, sizeof grid);
+    gfx_record(hole_box, draw_hole, &hole, sizeof hole);
+}
 
-    for (size_t y = 0; y < LCD_HEIGHT; y += h) {
-        h = MIN(LCD_MAX_TILE_ROWS, LCD_HEIGHT - y);
-        gfx_pixtile *tile = lcd_alloc_pixtile(0, y, LCD_WIDTH, h);
-        draw_tile(tile);
-        lcd_send_pixtile(tile);
-    }
+static void replay(gfx_pixtile *tile, void *closure)
+{
+    (void)closure;
+    gfx_replay_display_list(tile);
+}
+
+static void draw_frame(void)
+{
+    static gfx_region damage;
 
+    record_frame();
+    gfx_damage_display_list(&damage);
+    lcd_send_damage(&damage, replay, NULL);
 }
 
 static void calc_fps(void)
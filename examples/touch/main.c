@@ -11,22 +11,22 @@
 
 #define MY_CLOCK (rcc_hse_25mhz_3v3[RCC_CLOCK_3V3_168MHZ])
 
-#define BLACK_565  0x0000
-#define WHITE_565  0xFFFF
-#define GRAY50_565 0x7BEF
-#define RED_565    0xF800
-#define GREEN_565  0x07E0
-#define BLUE_565   0x001F
-
-#define FG_COLOR   WHITE_565
-#define BG_COLOR   GRAY50_565
-#define PIX_COLOR  BLACK_565
-#define LINE_COLOR GREEN_565
-#define P0_COLOR   RED_565
-#define P1_COLOR   BLUE_565
-
-#define CH0_COLOR  RED_565
-#define CH1_COLOR  BLUE_565
+#define BLACK      0x000000
+#define WHITE      0xFFFFFF
+#define GRAY50     0x7F7F7F
+#define RED        0xFF0000
+#define GREEN      0x00FF00
+#define BLUE       0x0000FF
+
+#define FG_COLOR   WHITE
+#define BG_COLOR   GRAY50
+#define PIX_COLOR  BLACK
+#define LINE_COLOR GREEN
+#define P0_COLOR   RED
+#define P1_COLOR   BLUE
+
+#define CH0_COLOR  RED
+#define CH1_COLOR  BLUE
 
 #define CROSSHAIR_RADIUS 64
 
@@ -48,7 +48,7 @@ static void setup(void)
 
     setup_systick(MY_CLOCK.ahb_frequency);
 
-    lcd_set_bg_color(BG_COLOR, false);
+    lcd_set_bg_color(gfx_rgb888_to_rgb565(BG_COLOR), false);
     lcd_init();
 
     touch_init();
@@ -73,7 +73,7 @@ static void draw_tile(gfx_pixtile *tile)
         const float      x = touch_pt0.x;
         const float      y = touch_pt0.y;
         const float      r = CROSSHAIR_RADIUS;
-        const gfx_rgb565 c = CH0_COLOR;
+        const gfx_rgb888 c = CH0_COLOR;
         gfx_draw_line(tile, x - r, y, x + r, y, c);
         gfx_draw_line(tile, x, y - r, x, y + r, c);
     }
@@ -81,7 +81,7 @@ static void draw_tile(gfx_pixtile *tile)
         const float      x = touch_pt1.x;
         const float      y = touch_pt1.y;
         const float      r = CROSSHAIR_RADIUS;
-        const gfx_rgb565 c = CH1_COLOR;
+        const gfx_rgb888 c = CH1_COLOR;
         gfx_draw_line(tile, x - r, y, x + r, y, c);
         gfx_draw_line(tile, x, y - r, x, y + r, c);
     }
@@ -4,12 +4,17 @@
 #include <stdbool.h>
 
 #include "gfx-pixtile.h"
+#include "gfx-rle.h"
 
+// A button's images are either pixtiles or RLE images; the other
+// pair is NULL.
 typedef struct gfx_button {
-    bool               is_down;
-    gfx_ipoint         position;
-    const gfx_pixtile *up_image;
-    const gfx_pixtile *down_image;
+    bool                 is_down;
+    gfx_ipoint           position;
+    const gfx_pixtile   *up_image;
+    const gfx_pixtile   *down_image;
+    const gfx_rle_image *up_rle;
+    const gfx_rle_image *down_rle;
 } gfx_button;
 
 extern void gfx_button_init(gfx_button *,
@@ -18,6 +23,12 @@ extern void gfx_button_init(gfx_button *,
                             const gfx_pixtile *up_image,
                             const gfx_pixtile *down_image);
 
+extern void gfx_button_init_rle(gfx_button *,
+                                bool is_down,
+                                gfx_ipoint position,
+                                const gfx_rle_image *up_rle,
+                                const gfx_rle_image *down_rle);
+
 extern bool gfx_point_is_in_button(const gfx_ipoint *, const gfx_button *);
 
 extern void gfx_draw_button(gfx_pixtile *, const gfx_button *);
@@ -0,0 +1,81 @@
+#ifndef GFX_DISPLAY_LIST_included
+#define GFX_DISPLAY_LIST_included
+
+#include <stdbool.h>
+
+#include <gfx-region.h>
+#include <gfx-text.h>
+#include <gfx-types.h>
+
+// The display list records a frame's drawing calls once, each with
+// its bounding box, and replays them into each pixtile.  Recording
+// bins every call into the screen bands it touches, LCD_MAX_TILE_ROWS
+// rows each, the tiles of the usual rendering loop.  Replaying a tile
+// that lies within one band visits only that band's calls, in the
+// order they were recorded, and skips those whose box misses the
+// tile.  Other tiles are replayed from the whole list, box tested.
+//
+// Calls and their arguments are copied into a fixed size arena.  It
+// is static, so on the device it lives in CCM with the rest of the
+// data: GFX_DISPLAY_LIST_BYTES, 16 KB unless libgfx is built with
+// another size, plus 5 KB for the last frame's calls.  A call that
+// doesn't fit is not recorded, and the recorder returns false.
+// Arguments that point elsewhere, such as a mask's pixels or a font,
+// must stay valid until the list is cleared; text is copied.
+
+// Draw into the tile from the arguments that were recorded.
+typedef void gfx_draw_func(gfx_pixtile *tile, const void *args);
+
+// Forget every call, e.g., before recording the next frame.
+extern void gfx_clear_display_list(void);
+
+// Record a call to func, with a copy of size bytes of args, that
+// draws only inside box.
+extern bool gfx_record(gfx_irect box,
+                       gfx_draw_func *func,
+                       const void *args,
+                       size_t size);
+
+// Replay the calls whose boxes touch the tile.
+extern void gfx_replay_display_list(gfx_pixtile *tile);
+
+// Add to damage the parts of the screen this frame's calls may draw
+// differently from the last frame's, and remember this frame's for
+// the next.  Call it once a frame, after recording.  Calls are
+// compared in order by a hash of their arguments: where one differs,
+// its old box and its new box are damaged.  The first frame, and the
+// frame after one of more than 256 calls, damage the whole screen.
+//
+// Only the recorded bytes are hashed, so arguments that point
+// elsewhere are compared by address.  If a mask's pixels or a font
+// change in place, add the call's box to damage yourself.  Text is
+// copied, so changed text is found.
+extern void gfx_damage_display_list(gfx_region *damage);
+
+// Record a call to the drawing function of the same name.
+extern bool gfx_record_fill_rect                   (float x, float y,
+                                                    float w, float h,
+                                                    gfx_rgb888 color);
+extern bool gfx_record_fill_rect_aa                (float x, float y,
+                                                    float w, float h,
+                                                    gfx_rgb888 color);
+extern bool gfx_record_draw_line                   (float x0, float y0,
+                                                    float x1, float y1,
+                                                    gfx_rgb888 color);
+extern bool gfx_record_draw_line_aa                (float x0, float y0,
+                                                    float x1, float y1,
+                                                    gfx_rgb888 color);
+extern bool gfx_record_fill_circle                 (float cx, float cy,
+                                                    float r,
+                                                    gfx_rgb888 color);
+extern bool gfx_record_fill_circle_aa              (float cx, float cy,
+                                                    float r,
+                                                    gfx_rgb888 color);
+extern bool gfx_record_fill_mask                   (const gfx_mask *mask,
+                                                    gfx_rgb888 color);
+extern bool gfx_record_draw_text                   (const gfx_font *font,
+                                                    gfx_ipoint origin,
+                                                    const char *text,
+                                                    gfx_rgb888 color);
+
+#endif /* !GFX_DISPLAY_LIST_included */
@@ -0,0 +1,82 @@
+#ifndef GFX_FONT_included
+#define GFX_FONT_included
+
+#include <gfx-types.h>
+
+// Outline fonts are drawn at any size from the glyphs' quadratic
+// contours, as pixmaps/make-font -O extracts them from a TrueType
+// font.  One font costs about as much flash as one small atlas, and
+// serves every size.
+//
+// A glyph is rasterized the first time it is drawn at a size, into a
+// fixed size glyph cache in CCM (GFX_GLYPH_CACHE_BYTES, 8 KB unless
+// libgfx is built with another size), and filled from the cache as a
+// mask after that, in every tile and every frame, until it is the
+// least recently used glyph and its space is needed.  Glyphs too big for
+// the cache are filled straight from their outlines.
+//
+// As with gfx-text.h, characters are bytes, characters outside the
+// font's range are skipped, and '\n' starts a new line.  Glyphs and
+// lines that miss the pixtile are skipped without being rasterized.
+
+// A contour is a closed chain of points, TrueType style: two points on
+// the curve are joined by a line, an off curve point is the control
+// point of a quadratic curve, and between two off curve points there
+// is an implied on curve point halfway.  Points are pairs of int16_t
+// in font units, x then y, y up.  The low bit of x is set when the
+// point is on the curve; x is the rest, arithmetically shifted right.
+typedef struct gfx_outline_glyph {
+    uint16_t point_first;       // first point in the font's points
+    uint16_t contour_first;     // first contour end in contour_ends
+    uint8_t  contour_count;
+    uint8_t  kern_count;        // kerning pairs with this on the left
+    uint16_t kern_first;
+    int16_t  advance;           // font units
+    int16_t  x_min, y_min;      // bounding box, font units
+    int16_t  x_max, y_max;
+} gfx_outline_glyph;
+
+typedef struct gfx_outline_kern_pair {
+    uint8_t  right;             // character on the right
+    int16_t  adjust;            // font units
+} gfx_outline_kern_pair;
+
+typedef struct gfx_outline_font {
+    const gfx_outline_glyph     *glyphs;        // one per character
+    const int16_t               *points;
+    const uint16_t              *contour_ends;  // last point of each,
+                                                // glyph relative
+    const gfx_outline_kern_pair *kerning;
+    uint16_t                     units_per_em;
+    int16_t                      ascent;        // font units, y up
+    int16_t                      descent;       // font units, negative
+    int16_t                      line_height;   // font units
+    uint8_t                      first;         // first character
+    uint8_t                      count;         // characters in range
+} gfx_outline_font;
+
+// Width in pixels of the text's longest line at size pixels per em.
+extern float gfx_outline_text_width(const gfx_outline_font *font,
+                                    float size,
+                                    const char *text);
+
+// Draw text size pixels per em.  origin is the pen position on the
+// first line's baseline.  Glyphs are placed on whole pixels.
+extern void gfx_draw_outline_text                  (gfx_pixtile *tile,
+                                                    const gfx_outline_font *font,
+                                                    float size,
+                                                    gfx_point origin,
+                                                    const char *text,
+                                                    gfx_rgb888 color);
+extern void gfx_draw_outline_text_blend            (gfx_pixtile *tile,
+                                                    const gfx_outline_font *font,
+                                                    float size,
+                                                    gfx_point origin,
+                                                    const char *text,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+
+// Forget every cached glyph, e.g., before a font's data goes away.
+extern void gfx_flush_glyph_cache(void);
+
+#endif /* !GFX_FONT_included */
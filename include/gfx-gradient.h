@@ -0,0 +1,60 @@
+#ifndef GFX_GRADIENT_included
+#define GFX_GRADIENT_included
+
+#include <stdbool.h>
+
+#include <gfx-types.h>
+
+// A gradient paints each pixel a color chosen by the pixel center's
+// position.  A linear gradient's parameter t runs from 0 at p0 to 1 at
+// p1, and is constant across lines perpendicular to p0-p1.  A radial
+// gradient's t is the distance from its center divided by its radius.
+// Colors are interpolated between color stops, and beyond the first
+// and last stops the end colors continue.
+//
+// The gradient is prepared once, by gfx_init_linear_gradient or
+// gfx_init_radial_gradient, and drawn incrementally in fixed point:
+// a pixel costs a few adds and a color lookup, with no division or
+// square root.
+//
+// With a ramp, the lookup is one load from GFX_GRADIENT_RAMP_SIZE
+// precomputed colors.  Without one, each pixel is interpolated
+// between its two stops, with 8 bits of fraction, and rounded to 565.
+
+#define GFX_GRADIENT_MAX_STOPS 8
+#define GFX_GRADIENT_RAMP_SIZE 256
+
+typedef struct gfx_color_stop {
+    float      offset;          // 0 .. 1, in increasing order
+    gfx_rgb888 color;
+} gfx_color_stop;
+
+struct gfx_gradient {
+    bool              radial;
+    float             x0, y0;   // where t is 0
+    float             tx, ty;   // linear: change in t per pixel
+    float             r2;       // radial: radius squared
+    float             r2_inv;   // radial: one over that
+    const gfx_rgb565 *ramp;     // precomputed colors, or NULL
+    size_t            stop_count;
+    uint16_t          stop_t[GFX_GRADIENT_MAX_STOPS + 2];     // 0.16
+    uint32_t          stop_scale[GFX_GRADIENT_MAX_STOPS + 2]; // 256 / length
+    uint16_t          stop_rgb[GFX_GRADIENT_MAX_STOPS + 2][3]; // rgb, 32nds
+};
+
+// At most GFX_GRADIENT_MAX_STOPS stops are used.  If ramp is not NULL,
+// it must hold GFX_GRADIENT_RAMP_SIZE colors, and is filled in here.
+// It must stay valid while the gradient is used.
+extern void gfx_init_linear_gradient(gfx_gradient *gradient,
+                                     gfx_point p0, gfx_point p1,
+                                     const gfx_color_stop *stops,
+                                     size_t stop_count,
+                                     gfx_rgb565 *ramp);
+
+extern void gfx_init_radial_gradient(gfx_gradient *gradient,
+                                     gfx_point center, float r,
+                                     const gfx_color_stop *stops,
+                                     size_t stop_count,
+                                     gfx_rgb565 *ramp);
+
+#endif /* !GFX_GRADIENT_included */
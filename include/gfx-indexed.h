@@ -0,0 +1,71 @@
+#ifndef GFX_INDEXED_included
+#define GFX_INDEXED_included
+
+#include <stdint.h>
+
+#include <gfx-types.h>
+
+// An indexed frame holds a palette index per pixel instead of a 565
+// color, at 8 bits per pixel with a 256 color palette or 4 bits per
+// pixel with a 16 color palette.  A full 240x320 screen is 76800
+// bytes at 8 bits, which fits in SRAM beside the DMA tiles (see
+// LCD_FRAME_BYTES in lcd.h), or 38400 bytes at 4 bits.  That leaves
+// 26 KB of the 64 KB CCM for the stack and the static pools of
+// polygons, outline fonts and display lists, which together take
+// 45 KB by default, so a 4 bit frame in CCM needs those shrunk or
+// left out.  (See the hardware details in README.md.)
+//
+// The frame is retained: it keeps its pixels from one screen refresh
+// to the next, so only the primitives that changed are redrawn.
+// lcd_send_indexed expands it through its palette into pixtiles as
+// it sends them, so changing the palette changes the whole screen at
+// no drawing cost.  It sends whole DMA bursts, so w * h must be a
+// multiple of LCD_TILE_ALIGN pixels, e.g., w a multiple of 8.
+//
+// At 4 bits, the left pixel of each byte is in the high nibble.
+
+typedef struct gfx_indexed {
+    uint8_t          *pixels;   // top left pixel
+    int               x, y;     // screen position
+    size_t            w, h;     // size
+    size_t            stride;   // row stride in bytes
+    unsigned          bpp;      // bits per pixel, 8 or 4
+    const gfx_rgb565 *palette;  // 1 << bpp colors
+} gfx_indexed;
+
+// The buffer holds h rows of w pixels, each row starting on a byte.
+extern void gfx_init_indexed(gfx_indexed *frame,
+                             void *buffer,
+                             int x, int y,
+                             size_t w, size_t h,
+                             unsigned bpp,
+                             const gfx_rgb565 *palette);
+
+// Bytes needed for a frame of w x h pixels.
+static inline size_t gfx_indexed_size_bytes(size_t w, size_t h, unsigned bpp)
+{
+    return (w * bpp + 7) / 8 * h;
+}
+
+// Drawing stores the index in each pixel, clipped to the frame.
+// Masks are not blended: a pixel is stored where coverage is at
+// least half.
+extern void gfx_fill_pixel_indexed                 (gfx_indexed *frame,
+                                                    int x, int y,
+                                                    uint8_t index);
+extern void gfx_fill_span_indexed                  (gfx_indexed *frame,
+                                                    int x0, int x1, int y,
+                                                    uint8_t index);
+extern void gfx_fill_rect_indexed                  (gfx_indexed *frame,
+                                                    int x, int y,
+                                                    size_t w, size_t h,
+                                                    uint8_t index);
+extern void gfx_fill_mask_indexed                  (gfx_indexed *frame,
+                                                    const gfx_mask *mask,
+                                                    uint8_t index);
+
+// Look up the frame's pixels that land in the pixtile in its palette
+// and store them there.
+extern void gfx_expand_indexed(gfx_pixtile *tile, const gfx_indexed *frame);
+
+#endif /* !GFX_INDEXED_included */
@@ -0,0 +1,49 @@
+#ifndef GFX_PAINT_included
+#define GFX_PAINT_included
+
+#include <stdbool.h>
+
+#include <gfx-types.h>
+
+// Paint is the library's own: it lets the other drawing modules fill
+// with gfx.c's pixel loops, converting their color once per call
+// instead of once per span.  Applications use gfx.h.
+
+typedef struct gfx_paint {
+    gfx_rgb565 pixel;           // the color, as 565
+    gfx_alpha8 alpha;
+    uint32_t   spread;          // pixel, spread
+    uint32_t   src_term;        // spread times alpha, plus SPREAD_HALF
+    uint32_t   inv_alpha;       // 32 - alpha, 5 bits
+    const uint32_t (*dither)[8];    // thresholds by [y & 7][x & 7],
+                                    // or NULL when not dithering
+    uint32_t   whole, frac;     // the color in whole 565 steps and
+                                // 32nds of a step, spread
+    uint32_t   dither_term;     // color times alpha, exact to a 32nd
+                                // of a 565 step; 0 unless dithering
+    bool       dithers;         // dither_term is not a whole pixel
+} gfx_paint;
+
+// Convert color and alpha for the current dither mode.
+extern void gfx_init_paint(gfx_paint *pt,
+                           gfx_rgb888 color,
+                           gfx_alpha8 alpha);
+
+// Fill or blend count pixels at p, which is screen position (x, y),
+// with alpha, e.g., coverage times the paint's alpha.  Dithered if
+// dithering is on.
+extern void gfx_paint_run(gfx_rgb565 *p, size_t count,
+                          int x, int y,
+                          const gfx_paint *pt,
+                          gfx_alpha8 alpha);
+
+// The same, for one pixel.
+extern void gfx_paint_pixel(gfx_rgb565 *p,
+                            int x, int y,
+                            const gfx_paint *pt,
+                            gfx_alpha8 alpha);
+
+// Store count copies of pixel c at p, exactly.
+extern void gfx_store_run(gfx_rgb565 *p, size_t count, gfx_rgb565 c);
+
+#endif /* !GFX_PAINT_included */
@@ -0,0 +1,120 @@
+#ifndef GFX_PATH_included
+#define GFX_PATH_included
+
+#include <stdbool.h>
+
+#include <gfx-types.h>
+
+// A path is a sequence of subpaths made of straight lines and
+// quadratic and cubic Bezier curves.  Its storage belongs to the
+// caller, so a path can be built once, at startup or into static
+// arrays, and drawn every frame.
+//
+//     static uint8_t   ops[8];
+//     static gfx_point points[16];
+//     gfx_path path;
+//
+//     gfx_init_path(&path, ops, 8, points, 16);
+//     gfx_path_move_to(&path, 10, 10);
+//     gfx_path_quad_to(&path, 50, 0, 90, 10);
+//
+// The building functions return false, and leave the path as it was,
+// when the path is full.
+
+typedef enum gfx_path_op {
+    GFX_PATH_MOVE,              // 1 point: start a subpath
+    GFX_PATH_LINE,              // 1 point: end point
+    GFX_PATH_QUAD,              // 2 points: control, end point
+    GFX_PATH_CUBIC,             // 3 points: control, control, end point
+    GFX_PATH_CLOSE,             // 0 points: line back to subpath start
+} gfx_path_op;
+
+typedef struct gfx_path {
+    uint8_t   *ops;             // gfx_path_op
+    gfx_point *points;
+    size_t     op_count, op_max;
+    size_t     point_count, point_max;
+} gfx_path;
+
+// Curves are flattened until no line is farther than this from the
+// curve, in pixels.
+#define GFX_PATH_TOLERANCE 0.25f
+
+extern void gfx_init_path(gfx_path *path,
+                          uint8_t *ops, size_t op_max,
+                          gfx_point *points, size_t point_max);
+extern void gfx_path_clear(gfx_path *path);
+extern bool gfx_path_move_to(gfx_path *path, float x, float y);
+extern bool gfx_path_line_to(gfx_path *path, float x, float y);
+extern bool gfx_path_quad_to(gfx_path *path,
+                             float cx, float cy,
+                             float x, float y);
+extern bool gfx_path_cubic_to(gfx_path *path,
+                              float c1x, float c1y,
+                              float c2x, float c2y,
+                              float x, float y);
+extern bool gfx_path_close(gfx_path *path);
+
+// Flattening turns a path into straight lines.  It calls emit with
+// GFX_PATH_MOVE, GFX_PATH_LINE or GFX_PATH_CLOSE for each step.
+//
+// If tile is not NULL, a segment whose control points' bounding box,
+// grown by margin, misses the tile is emitted as one line to its end
+// point, without flattening.  The curve and that line enclose only
+// points outside the tile, so fills get the same winding inside the
+// tile.  Strokes should pass at least half their width as margin.
+typedef void gfx_path_emit_func(void *closure, gfx_path_op op, gfx_point p);
+
+extern void gfx_flatten_path(const gfx_path *path,
+                             const gfx_pixtile *tile,
+                             float margin,
+                             float tolerance,
+                             gfx_path_emit_func *emit,
+                             void *closure);
+
+// Flatten one quadratic curve from p[0], through control point p[1],
+// to p[2].  Emits only GFX_PATH_LINE, the last to p[2].
+extern void gfx_flatten_quad(const gfx_point p[3],
+                             float tolerance,
+                             gfx_path_emit_func *emit,
+                             void *closure);
+
+// Paths
+// Draw the flattened path's lines.
+extern void gfx_draw_path                          (gfx_pixtile *tile,
+                                                    const gfx_path *path,
+                                                    gfx_rgb888 color);
+extern void gfx_draw_path_aa                       (gfx_pixtile *tile,
+                                                    const gfx_path *path,
+                                                    gfx_rgb888 color);
+extern void gfx_draw_path_blend                    (gfx_pixtile *tile,
+                                                    const gfx_path *path,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_draw_path_aa_blend                 (gfx_pixtile *tile,
+                                                    const gfx_path *path,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+
+// Fill the path's interior.  Every subpath is closed.  (See
+// gfx-polygon.h.)
+extern void gfx_fill_path                          (gfx_pixtile *tile,
+                                                    const gfx_path *path,
+                                                    gfx_fill_rule rule,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_path_aa                       (gfx_pixtile *tile,
+                                                    const gfx_path *path,
+                                                    gfx_fill_rule rule,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_path_blend                    (gfx_pixtile *tile,
+                                                    const gfx_path *path,
+                                                    gfx_fill_rule rule,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_fill_path_aa_blend                 (gfx_pixtile *tile,
+                                                    const gfx_path *path,
+                                                    gfx_fill_rule rule,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+
+#endif /* !GFX_PATH_included */
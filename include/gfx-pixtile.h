@@ -33,4 +33,10 @@ extern void gfx_copy_pixtile(gfx_pixtile       *dest,
                              gfx_pixtile const *src,
                              gfx_ipoint         offset);
 
+// Copy as above, but leave dest alone where src's pixel is key.
+extern void gfx_copy_pixtile_keyed(gfx_pixtile       *dest,
+                                   gfx_pixtile const *src,
+                                   gfx_ipoint         offset,
+                                   gfx_rgb565         key);
+
 #endif /* !GFX_PIXTILE_included */
@@ -0,0 +1,77 @@
+#ifndef GFX_POLYGON_included
+#define GFX_POLYGON_included
+
+#include <stdbool.h>
+
+#include <gfx-path.h>
+#include <gfx-types.h>
+
+// Polygons are scan converted by accumulating each edge's coverage
+// into sparse cells, one per pixel the edge crosses, then sweeping
+// each row's cells left to right.  (This is AGG's cell rasterizer,
+// the one pixmaps/make-button-img.cpp uses offline.)
+//
+// The cells live in a static pool in CCM, GFX_POLYGON_CELLS cells of
+// 13 bytes, eight a row for one pixtile unless libgfx is built with
+// another count.  When an outline needs more cells than that, the
+// tile is filled in bands of rows, a row that still needs more in
+// bands of columns, and the outline is emitted again for each band.
+
+// An outline function emits one or more closed outlines through emit,
+// the way gfx_flatten_path does.  An unclosed subpath is closed by a
+// line back to its start.  Segments that miss band may be skipped or
+// replaced by any line between the same end points outside band.
+typedef void gfx_outline_func(void *closure,
+                              const gfx_pixtile *band,
+                              gfx_path_emit_func *emit,
+                              void *emit_closure);
+
+// Fill the outline's interior.  Without aa, a pixel is painted when
+// the outline covers at least half of it.
+extern void gfx_fill_outline(gfx_pixtile *tile,
+                             gfx_outline_func *outline,
+                             void *closure,
+                             gfx_fill_rule rule,
+                             bool aa,
+                             gfx_rgb888 color,
+                             gfx_alpha8 alpha);
+
+// Render the outline's coverage into an 8 bit mask instead, w x h
+// with the given stride in bytes, whose top left pixel is at screen
+// position (x, y).  Pixels the outline misses are set to zero.
+extern void gfx_rasterize_outline(gfx_alpha8 *pixels,
+                                  int x, int y,
+                                  size_t w, size_t h,
+                                  size_t stride,
+                                  gfx_outline_func *outline,
+                                  void *closure,
+                                  gfx_fill_rule rule,
+                                  bool aa);
+
+// Polygons
+// points[0] through points[count - 1] are the vertices of one closed
+// polygon.  Its edges may cross.
+extern void gfx_fill_polygon                       (gfx_pixtile *tile,
+                                                    const gfx_point *points,
+                                                    size_t count,
+                                                    gfx_fill_rule rule,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_polygon_aa                    (gfx_pixtile *tile,
+                                                    const gfx_point *points,
+                                                    size_t count,
+                                                    gfx_fill_rule rule,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_polygon_blend                 (gfx_pixtile *tile,
+                                                    const gfx_point *points,
+                                                    size_t count,
+                                                    gfx_fill_rule rule,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_fill_polygon_aa_blend              (gfx_pixtile *tile,
+                                                    const gfx_point *points,
+                                                    size_t count,
+                                                    gfx_fill_rule rule,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+
+#endif /* !GFX_POLYGON_included */
@@ -0,0 +1,48 @@
+#ifndef GFX_REGION_included
+#define GFX_REGION_included
+
+#include <stdbool.h>
+
+#include <gfx-types.h>
+
+// A region is a set of pixels, kept as up to GFX_REGION_MAX_RECTS
+// disjoint rects.  It collects damage: the parts of the screen that
+// changed and must be sent again.
+//
+// Adding a rect adds only its pixels not already in the region, as
+// up to four rects around each one it overlaps, and joins rects that
+// together make a rect.  When the region is full, the two rects
+// whose bounding box adds the fewest pixels are replaced by that box,
+// so a region grows only as coarse as it has to.
+
+#define GFX_REGION_MAX_RECTS 16
+
+typedef struct gfx_region {
+    size_t    count;
+    gfx_irect rects[GFX_REGION_MAX_RECTS];
+} gfx_region;
+
+extern void gfx_region_clear(gfx_region *region);
+
+static inline bool gfx_region_is_empty(const gfx_region *region)
+{
+    return region->count == 0;
+}
+
+extern void gfx_region_add_rect(gfx_region *region, gfx_irect rect);
+extern void gfx_region_add_region(gfx_region *region,
+                                  const gfx_region *other);
+
+// Remove the pixels outside rect.
+extern void gfx_region_clip(gfx_region *region, gfx_irect rect);
+
+extern bool gfx_region_intersects_rect(const gfx_region *region,
+                                       gfx_irect rect);
+
+// Smallest rect holding the region.  Empty if the region is.
+extern gfx_irect gfx_region_bounds(const gfx_region *region);
+
+// Number of pixels in the region.
+extern size_t gfx_region_area(const gfx_region *region);
+
+#endif /* !GFX_REGION_included */
@@ -0,0 +1,37 @@
+#ifndef GFX_RLE_included
+#define GFX_RLE_included
+
+#include <gfx-types.h>
+
+// A run length encoded image, as pixmaps/img-to-button writes it.
+// Each row is a sequence of runs that together cover exactly w
+// pixels.  A run starts with a header word holding the run's kind in
+// its top two bits and its length in pixels in the rest.
+//
+//     GFX_RLE_SKIP     transparent; nothing follows
+//     GFX_RLE_FILL     one color; the color follows
+//     GFX_RLE_COPY     different colors; length colors follow
+//
+// rows[j] is the index in data of row j's first run, so drawing
+// starts at the first row in the pixtile without decoding the rows
+// above it.  Fill runs are filled like spans, copy runs are copied,
+// and skip runs leave the pixtile alone.
+
+#define GFX_RLE_SKIP      0x0000
+#define GFX_RLE_FILL      0x4000
+#define GFX_RLE_COPY      0x8000
+#define GFX_RLE_KIND_MASK 0xC000
+#define GFX_RLE_MAX_RUN   0x3FFF
+
+typedef struct gfx_rle_image {
+    const uint16_t *data;       // runs
+    const uint32_t *rows;       // index of each row's first run
+    size_t          w, h;       // size
+} gfx_rle_image;
+
+// Draw the image with its top left pixel at position.
+extern void gfx_draw_rle_image(gfx_pixtile         *tile,
+                               const gfx_rle_image *image,
+                               gfx_ipoint           position);
+
+#endif /* !GFX_RLE_included */
@@ -0,0 +1,81 @@
+#ifndef GFX_STROKE_included
+#define GFX_STROKE_included
+
+#include <gfx-path.h>
+#include <gfx-types.h>
+
+// A stroke is a line of some width along a polyline or path.  Its
+// outline is built from a quadrilateral for each segment and a small
+// polygon for each join and cap, and the pieces are filled together
+// by the polygon rasterizer with the nonzero rule, so every pixel is
+// painted once however much the pieces overlap.  Pieces that miss the
+// pixtile are not emitted at all.
+
+typedef enum gfx_stroke_join {
+    GFX_JOIN_MITER,             // bevel if longer than the miter limit
+    GFX_JOIN_ROUND,
+    GFX_JOIN_BEVEL,
+} gfx_stroke_join;
+
+typedef enum gfx_stroke_cap {
+    GFX_CAP_BUTT,               // end at the end point
+    GFX_CAP_ROUND,
+    GFX_CAP_SQUARE,             // extend half the width past the end point
+} gfx_stroke_cap;
+
+typedef struct gfx_stroke {
+    float           width;
+    gfx_stroke_join join;
+    gfx_stroke_cap  cap;
+} gfx_stroke;
+
+// Miters longer than this many times half the width are beveled.
+#define GFX_STROKE_MITER_LIMIT 4.0f
+
+// Polylines
+// points[0] through points[count - 1] are joined by straight lines.
+extern void gfx_stroke_polyline                    (gfx_pixtile *tile,
+                                                    const gfx_point *points,
+                                                    size_t count,
+                                                    const gfx_stroke *stroke,
+                                                    gfx_rgb888 color);
+extern void gfx_stroke_polyline_aa                 (gfx_pixtile *tile,
+                                                    const gfx_point *points,
+                                                    size_t count,
+                                                    const gfx_stroke *stroke,
+                                                    gfx_rgb888 color);
+extern void gfx_stroke_polyline_blend              (gfx_pixtile *tile,
+                                                    const gfx_point *points,
+                                                    size_t count,
+                                                    const gfx_stroke *stroke,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_stroke_polyline_aa_blend           (gfx_pixtile *tile,
+                                                    const gfx_point *points,
+                                                    size_t count,
+                                                    const gfx_stroke *stroke,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+
+// Paths
+// Closed subpaths are joined at their start; open ones are capped.
+extern void gfx_stroke_path                        (gfx_pixtile *tile,
+                                                    const gfx_path *path,
+                                                    const gfx_stroke *stroke,
+                                                    gfx_rgb888 color);
+extern void gfx_stroke_path_aa                     (gfx_pixtile *tile,
+                                                    const gfx_path *path,
+                                                    const gfx_stroke *stroke,
+                                                    gfx_rgb888 color);
+extern void gfx_stroke_path_blend                  (gfx_pixtile *tile,
+                                                    const gfx_path *path,
+                                                    const gfx_stroke *stroke,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_stroke_path_aa_blend               (gfx_pixtile *tile,
+                                                    const gfx_path *path,
+                                                    const gfx_stroke *stroke,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+
+#endif /* !GFX_STROKE_included */
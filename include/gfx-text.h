@@ -0,0 +1,70 @@
+#ifndef GFX_TEXT_included
+#define GFX_TEXT_included
+
+#include <stdbool.h>
+
+#include <gfx-types.h>
+
+// Text is drawn from a font prerendered by pixmaps/make-font into a
+// C header.  Each glyph is an 8 bit coverage map in the font's atlas,
+// cropped to its inked pixels, and drawing a glyph fills it as a
+// mask.  Only the rows and columns of a glyph that land on the
+// pixtile are composited, and glyphs and whole lines that miss the
+// pixtile are skipped without touching the atlas.
+//
+// An LCD font's glyphs have a coverage sample for each color stripe,
+// three per pixel, and are filled with gfx_fill_mask_lcd.
+//
+// Characters are bytes.  A font covers a contiguous range of them;
+// the rest are skipped.  '\n' starts a new line.
+
+typedef struct gfx_glyph {
+    uint32_t offset;            // first coverage byte in the atlas
+    uint16_t kern_first;        // first kerning pair with this on the left
+    uint8_t  kern_count;        // number of those pairs
+    uint8_t  advance;           // pen advance in pixels
+    uint8_t  w, h;              // coverage size; stride is w
+    int8_t   left;              // coverage left edge right of the pen
+    int8_t   top;               // coverage top edge above the baseline
+} gfx_glyph;
+
+typedef struct gfx_kern_pair {
+    uint8_t  right;             // character on the right
+    int8_t   adjust;            // added to the left glyph's advance
+} gfx_kern_pair;
+
+typedef struct gfx_font {
+    const gfx_alpha8    *atlas;
+    const gfx_glyph     *glyphs;   // one per character in range
+    const gfx_kern_pair *kerning;  // grouped by left glyph, sorted by right
+    uint8_t              first;    // first character in range
+    uint8_t              count;    // number of characters in range
+    uint8_t              ascent;   // highest coverage row above the baseline
+    uint8_t              descent;  // lowest coverage row below it, plus one
+    uint8_t              line_height;
+    bool                 lcd;      // three coverage samples per pixel
+} gfx_font;
+
+// Width in pixels of the text's longest line.
+extern int gfx_text_width(const gfx_font *font, const char *text);
+
+// The smallest rect holding every pixel the text can touch when
+// drawn with origin as below.  Empty if no character has a glyph.
+extern gfx_irect gfx_text_bounds(const gfx_font *font,
+                                 gfx_ipoint origin,
+                                 const char *text);
+
+// origin is the pen position on the first line's baseline.
+extern void gfx_draw_text                          (gfx_pixtile *tile,
+                                                    const gfx_font *font,
+                                                    gfx_ipoint origin,
+                                                    const char *text,
+                                                    gfx_rgb888 color);
+extern void gfx_draw_text_blend                    (gfx_pixtile *tile,
+                                                    const gfx_font *font,
+                                                    gfx_ipoint origin,
+                                                    const char *text,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+
+#endif /* !GFX_TEXT_included */
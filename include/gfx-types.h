@@ -8,7 +8,24 @@ typedef uint16_t gfx_rgb565;
 typedef uint32_t gfx_rgb888;
 typedef uint8_t  gfx_alpha8;
 
+// A gfx_rgb888 is 0xRRGGBB.  Converting it to 565 keeps each
+// channel's high bits; converting back replicates them into the low
+// bits, so a 565 color round trips.
+static inline gfx_rgb565 gfx_rgb888_to_rgb565(gfx_rgb888 c)
+{
+    return (c >> 8 & 0xF800) | (c >> 5 & 0x07E0) | (c >> 3 & 0x001F);
+}
+
+static inline gfx_rgb888 gfx_rgb565_to_rgb888(gfx_rgb565 c)
+{
+    uint32_t r = c >> 11, g = c >> 5 & 0x3F, b = c & 0x1F;
+    return (r << 3 | r >> 2) << 16 |
+           (g << 2 | g >> 4) <<  8 |
+           (b << 3 | b >> 2);
+}
+
 typedef struct gfx_pixtile gfx_pixtile;
+typedef struct gfx_gradient gfx_gradient;
 
 typedef union gfx_point {
     struct {
@@ -24,6 +41,13 @@ typedef union gfx_ipoint {
     int c[2];                   // use p.c[i]
 } gfx_ipoint;
 
+// The pixels x0 <= x < x1, y0 <= y < y1.  Empty when x0 >= x1 or
+// y0 >= y1.
+typedef struct gfx_irect {
+    int x0, y0;
+    int x1, y1;
+} gfx_irect;
+
 typedef struct gfx_trapezoid {
     float xl0, xr0, y0;
     float xl1, xr1, y1;
@@ -33,4 +57,45 @@ typedef struct gfx_triangle {
     gfx_point v[3];
 } gfx_triangle;
 
+// Which points are inside a shape whose outline crosses itself.
+typedef enum gfx_fill_rule {
+    GFX_FILL_NONZERO,           // outline winds around the point
+    GFX_FILL_EVEN_ODD,          // outline crosses a ray an odd number of times
+} gfx_fill_rule;
+
+// How a scaled image is sampled.
+typedef enum gfx_filter {
+    GFX_FILTER_NEAREST,         // nearest source pixel
+    GFX_FILTER_BILINEAR,        // blend of the four nearest
+} gfx_filter;
+
+// Ordered dithering of colors more precise than 565.
+typedef enum gfx_dither {
+    GFX_DITHER_NONE,
+    GFX_DITHER_4X4,             // 4x4 Bayer matrix
+    GFX_DITHER_8X8,             // 8x8 Bayer matrix
+} gfx_dither;
+
+// An 8 bit coverage mask, w x h, whose top left pixel lands on
+// screen at (x, y).
+typedef struct gfx_mask {
+    const gfx_alpha8 *pixels;   // top left pixel
+    int               x, y;     // screen position
+    size_t            w, h;     // size
+    size_t            stride;   // row stride in bytes
+} gfx_mask;
+
+// A 16 bit image with an 8 bit alpha plane, w x h, whose top left
+// pixel lands on screen at (x, y).  Alpha is not premultiplied:
+// the pixel at column i of row j is pixels[j * stride + i], and its
+// opacity is alpha[j * alpha_stride + i].
+typedef struct gfx_sprite {
+    const gfx_rgb565 *pixels;   // top left pixel
+    const gfx_alpha8 *alpha;    // top left pixel's opacity
+    int               x, y;     // screen position
+    size_t            w, h;     // size
+    size_t            stride;   // pixel row stride in pixels
+    size_t            alpha_stride; // alpha row stride in bytes
+} gfx_sprite;
+
 #endif /* !GFX_TYPES_included */
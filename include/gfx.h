@@ -3,6 +3,17 @@
 
 #include <gfx-types.h>
 
+// Colors
+// Colors are gfx_rgb888.  Each call converts its color to 565 once;
+// opaque and blended drawing use the same 565 pixel.
+
+// Dithering
+// While dithering is on, fills, blends, antialiased edges and
+// gradients are dithered to 565 by an ordered matrix on screen
+// coordinates.  Opaque pixels, sprites and the color fringes of LCD
+// text are not.  It is off initially.
+extern void gfx_set_dither(gfx_dither mode);
+
 // Pixels
 extern void gfx_fill_pixel                         (gfx_pixtile *tile,
                                                     int x, int y,
@@ -20,7 +31,7 @@ extern void gfx_fill_pixel_blend_unclipped         (gfx_pixtile *tile,
                                                     gfx_alpha8 alpha);
 
 // Pixel Spans
-// Fill from (x0, y) to (x1, y) inclusive.
+// Fill from (x0, y) up to but not including (x1, y).
 extern void gfx_fill_span                          (gfx_pixtile *tile,
                                                     int x0, int x1, int y,
                                                     gfx_rgb888 color);
@@ -35,9 +46,13 @@ extern void gfx_fill_span_blend_unclipped          (gfx_pixtile *tile,
                                                     int x0, int x1, int y,
                                                     gfx_rgb888 color,
                                                     gfx_alpha8 alpha);
+extern void gfx_fill_span_gradient                 (gfx_pixtile *tile,
+                                                    int x0, int x1, int y,
+                                                    const gfx_gradient *gradient);
 
 // Lines
-// Draw from (x0, y0) to (y0, y1) with subpixel positioning.
+// Draw from (x0, y0) to (x1, y1) with subpixel positioning.
+// Clipped variants clip the segment to the tile before stepping.
 extern void gfx_draw_line                          (gfx_pixtile *tile,
                                                     float x0, float y0,
                                                     float x1, float y1,
@@ -76,6 +91,8 @@ extern void gfx_draw_line_aa_blend_unclipped       (gfx_pixtile *tile,
                                                     gfx_alpha8 alpha);
 
 // Trapezoids
+// Fill between the left edge (xl0, y0)-(xl1, y1) and the right edge
+// (xr0, y0)-(xr1, y1).  Trapezoids with y1 <= y0 are ignored.
 extern void gfx_fill_trapezoids                    (gfx_pixtile *tile,
                                                     gfx_trapezoid *zoids,
                                                     size_t count,
@@ -112,43 +129,258 @@ extern void gfx_fill_trapezoids_aa_blend_unclipped (gfx_pixtile *tile,
                                                     size_t count,
                                                     gfx_rgb888 color,
                                                     gfx_alpha8 alpha);
+extern void gfx_fill_trapezoids_gradient           (gfx_pixtile *tile,
+                                                    gfx_trapezoid *zoids,
+                                                    size_t count,
+                                                    const gfx_gradient *gradient);
 
 // Triangles
+// Each triangle is split into two trapezoids at its middle vertex.
 extern void gfx_fill_triangle                      (gfx_pixtile *tile,
-                                                    gfx_trapezoid *zoids,
+                                                    gfx_triangle *tris,
                                                     size_t count,
                                                     gfx_rgb888 color);
 extern void gfx_fill_triangle_aa                   (gfx_pixtile *tile,
-                                                    gfx_trapezoid *zoids,
+                                                    gfx_triangle *tris,
                                                     size_t count,
                                                     gfx_rgb888 color);
 extern void gfx_fill_triangle_blend                (gfx_pixtile *tile,
-                                                    gfx_trapezoid *zoids,
+                                                    gfx_triangle *tris,
                                                     size_t count,
                                                     gfx_rgb888 color,
                                                     gfx_alpha8 alpha);
 extern void gfx_fill_triangle_aa_blend             (gfx_pixtile *tile,
-                                                    gfx_trapezoid *zoids,
+                                                    gfx_triangle *tris,
                                                     size_t count,
                                                     gfx_rgb888 color,
                                                     gfx_alpha8 alpha);
 extern void gfx_fill_triangle_unclipped            (gfx_pixtile *tile,
-                                                    gfx_trapezoid *zoids,
+                                                    gfx_triangle *tris,
                                                     size_t count,
                                                     gfx_rgb888 color);
 extern void gfx_fill_triangle_aa_unclipped         (gfx_pixtile *tile,
-                                                    gfx_trapezoid *zoids,
+                                                    gfx_triangle *tris,
                                                     size_t count,
                                                     gfx_rgb888 color);
 extern void gfx_fill_triangle_blend_unclipped      (gfx_pixtile *tile,
-                                                    gfx_trapezoid *zoids,
+                                                    gfx_triangle *tris,
                                                     size_t count,
                                                     gfx_rgb888 color,
                                                     gfx_alpha8 alpha);
 extern void gfx_fill_triangle_aa_blend_unclipped   (gfx_pixtile *tile,
-                                                    gfx_trapezoid *zoids,
+                                                    gfx_triangle *tris,
                                                     size_t count,
                                                     gfx_rgb888 color,
                                                     gfx_alpha8 alpha);
 
+// Rectangles
+// Fill the screen aligned rectangle with top left corner (x, y) and
+// size w x h.
+extern void gfx_fill_rect                          (gfx_pixtile *tile,
+                                                    float x, float y,
+                                                    float w, float h,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_rect_aa                       (gfx_pixtile *tile,
+                                                    float x, float y,
+                                                    float w, float h,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_rect_blend                    (gfx_pixtile *tile,
+                                                    float x, float y,
+                                                    float w, float h,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_fill_rect_aa_blend                 (gfx_pixtile *tile,
+                                                    float x, float y,
+                                                    float w, float h,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_fill_rect_unclipped                (gfx_pixtile *tile,
+                                                    float x, float y,
+                                                    float w, float h,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_rect_aa_unclipped             (gfx_pixtile *tile,
+                                                    float x, float y,
+                                                    float w, float h,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_rect_blend_unclipped          (gfx_pixtile *tile,
+                                                    float x, float y,
+                                                    float w, float h,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_fill_rect_aa_blend_unclipped       (gfx_pixtile *tile,
+                                                    float x, float y,
+                                                    float w, float h,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_fill_rect_gradient                 (gfx_pixtile *tile,
+                                                    float x, float y,
+                                                    float w, float h,
+                                                    const gfx_gradient *gradient);
+
+// Circles and Ellipses
+// Fill the circle or axis aligned ellipse centered on (cx, cy).
+extern void gfx_fill_circle                        (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float r,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_circle_aa                     (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float r,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_circle_blend                  (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float r,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_fill_circle_aa_blend               (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float r,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_fill_circle_unclipped              (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float r,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_circle_aa_unclipped           (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float r,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_circle_blend_unclipped        (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float r,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_fill_circle_aa_blend_unclipped     (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float r,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_fill_ellipse                       (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float rx, float ry,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_ellipse_aa                    (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float rx, float ry,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_ellipse_blend                 (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float rx, float ry,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_fill_ellipse_aa_blend              (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float rx, float ry,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_fill_ellipse_unclipped             (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float rx, float ry,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_ellipse_aa_unclipped          (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float rx, float ry,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_ellipse_blend_unclipped       (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float rx, float ry,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_fill_ellipse_aa_blend_unclipped    (gfx_pixtile *tile,
+                                                    float cx, float cy,
+                                                    float rx, float ry,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+
+// Arcs
+// Draw the outline of the circle centered on (cx, cy) from angle a0
+// clockwise to angle a1.  Angles are in radians; 0 points along +x.
+extern void gfx_draw_arc                           (gfx_pixtile *tile,
+                                                    float cx, float cy, float r,
+                                                    float a0, float a1,
+                                                    gfx_rgb888 color);
+extern void gfx_draw_arc_aa                        (gfx_pixtile *tile,
+                                                    float cx, float cy, float r,
+                                                    float a0, float a1,
+                                                    gfx_rgb888 color);
+extern void gfx_draw_arc_blend                     (gfx_pixtile *tile,
+                                                    float cx, float cy, float r,
+                                                    float a0, float a1,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_draw_arc_aa_blend                  (gfx_pixtile *tile,
+                                                    float cx, float cy, float r,
+                                                    float a0, float a1,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_draw_arc_unclipped                 (gfx_pixtile *tile,
+                                                    float cx, float cy, float r,
+                                                    float a0, float a1,
+                                                    gfx_rgb888 color);
+extern void gfx_draw_arc_aa_unclipped              (gfx_pixtile *tile,
+                                                    float cx, float cy, float r,
+                                                    float a0, float a1,
+                                                    gfx_rgb888 color);
+extern void gfx_draw_arc_blend_unclipped           (gfx_pixtile *tile,
+                                                    float cx, float cy, float r,
+                                                    float a0, float a1,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_draw_arc_aa_blend_unclipped        (gfx_pixtile *tile,
+                                                    float cx, float cy, float r,
+                                                    float a0, float a1,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+
+// Masks
+// Composite color through a coverage mask.  Zero coverage leaves the
+// pixel alone; full coverage fills it.
+extern void gfx_fill_mask                          (gfx_pixtile *tile,
+                                                    const gfx_mask *mask,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_mask_blend                    (gfx_pixtile *tile,
+                                                    const gfx_mask *mask,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+extern void gfx_fill_mask_unclipped                (gfx_pixtile *tile,
+                                                    const gfx_mask *mask,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_mask_blend_unclipped          (gfx_pixtile *tile,
+                                                    const gfx_mask *mask,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+
+// Subpixel masks have three coverage samples per pixel, for the red,
+// green and blue stripes of an LCD pixel, left to right.  Each row
+// holds 3 * w samples, and stride counts samples.  Coverage is
+// filtered across neighboring stripes, so the filled area reaches
+// one pixel past each side of the mask.
+extern void gfx_fill_mask_lcd                      (gfx_pixtile *tile,
+                                                    const gfx_mask *mask,
+                                                    gfx_rgb888 color);
+extern void gfx_fill_mask_blend_lcd                (gfx_pixtile *tile,
+                                                    const gfx_mask *mask,
+                                                    gfx_rgb888 color,
+                                                    gfx_alpha8 alpha);
+
+// Sprites
+// Composite a sprite through its own alpha plane.  Transparent runs
+// are skipped and opaque runs copied.  The blend variant scales the
+// sprite's alpha by alpha.
+extern void gfx_draw_sprite                        (gfx_pixtile *tile,
+                                                    const gfx_sprite *sprite);
+extern void gfx_draw_sprite_blend                  (gfx_pixtile *tile,
+                                                    const gfx_sprite *sprite,
+                                                    gfx_alpha8 alpha);
+
+// Scaled Blits
+// Draw all of src, scaled to fill the w x h rectangle with top left
+// corner (x, y).  Only the rectangle's rows and columns in the tile
+// are sampled.
+extern void gfx_blit_scaled                        (gfx_pixtile *tile,
+                                                    const gfx_pixtile *src,
+                                                    int x, int y,
+                                                    size_t w, size_t h,
+                                                    gfx_filter filter);
+
 #endif /* !GFX_included */
@@ -3,21 +3,41 @@
 
 #include <stdbool.h>
 
+#include <gfx-indexed.h>
 #include <gfx-pixtile.h>
+#include <gfx-region.h>
+
+// Bytes of SRAM set aside for an indexed frame, e.g., build with
+// -DLCD_FRAME_BYTES=76800 for a full screen at 8 bits per pixel.  The
+// two DMA tiles share the rest.
+//
+// It sets LCD_MAX_TILE_ROWS, which libgfx compiles in: polygon.c sizes
+// its cells by it, and display-list.c bins calls into bands of it.  So
+// set it for the whole build, libgfx and application alike, not per
+// example.  lcd_init asserts that they agree.
+#ifndef LCD_FRAME_BYTES
+#define LCD_FRAME_BYTES          0
+#endif
 
 #define LCD_WIDTH              240
 #define LCD_HEIGHT             320
-#define LCD_MAX_TILE_BYTES   65536
+#define LCD_MAX_TILE_BYTES   ((131072 - LCD_FRAME_BYTES) / 2 & ~15)
 #define LCD_MAX_TILE_PIXELS  (LCD_MAX_TILE_BYTES / sizeof (gfx_rgb565))
 #define LCD_MAX_TILE_ROWS    (LCD_MAX_TILE_PIXELS / LCD_WIDTH)
+#define LCD_TILE_ALIGN         8    // pixels, one 16 byte DMA burst
 
 // Init the clocks, GPIO pins, timer, DMA controller, ILI9341 chip,
-// and pixtile DMA buffers.
-extern void lcd_init(void);
+// and pixtile DMA buffers.  frame_bytes is the caller's
+// LCD_FRAME_BYTES.
+#define lcd_init() lcd_init_frame(LCD_FRAME_BYTES)
+extern void lcd_init_frame(size_t frame_bytes);
 
 // Use alloc_pixtile to get DMA-capable tiles.
-// Maximum size is 64 KB (32 Kpixels).
+// Maximum size is LCD_MAX_TILE_BYTES, 64 KB (32 Kpixels) when no
+// frame is set aside.
 // Tiles are pre-cleared to the background color.
+// The DMA sends whole 16 byte bursts, so w * h must be a multiple of
+// LCD_TILE_ALIGN pixels.
 gfx_pixtile *lcd_alloc_pixtile(int x, int y, size_t w, size_t h);
 
 // Send pixels to screen and deallocate tile.
@@ -32,5 +52,30 @@ extern void lcd_set_bg_color(gfx_rgb565 color, bool immediate);
 // Get the background pixel color.
 extern gfx_rgb565 lcd_bg_color(void);
 
+// The LCD_FRAME_BYTES of SRAM set aside for an indexed frame, or NULL
+// if none are.
+extern void *lcd_frame_buffer(void);
+
+// Send an indexed frame: allocate tiles as wide as the frame down it,
+// expand the frame through its palette into each, and send it.  The
+// frame may be anywhere in memory; it is only read.  Its w * h must be
+// a multiple of LCD_TILE_ALIGN pixels.
+extern void lcd_send_indexed(const gfx_indexed *frame);
+
+// Draw into a tile allocated by lcd_send_damage.
+typedef void lcd_draw_func(gfx_pixtile *tile, void *closure);
+
+// Send the damaged part of the screen, and clear damage.  Each rect
+// is widened to whole columns of LCD_TILE_ALIGN pixels and covered
+// with tiles as wide as it is, which don't cross the
+// LCD_MAX_TILE_ROWS bands that display lists bin calls into.  Each
+// tile is drawn with draw(tile, closure) and sent.  The ILI9341 keeps
+// the rest of the frame, so if nothing is damaged, nothing is sent.
+//
+// If the background color changed since the last call, the whole
+// screen is damaged.
+extern void lcd_send_damage(gfx_region *damage,
+                            lcd_draw_func *draw,
+                            void *closure);
 
 #endif /* !LCD_included */
@@ -37,23 +37,24 @@
                             })
 
 // FLOOR(x) + FRAC(x) == x
+// 0 <= FRAC(x) < 1
 
 #define FLOOR(x)            FLOOR_H(x, TMPVAR_H())
 #define FLOOR_H(x, t)       ({                                          \
                                 __typeof__ (x) t = (x);                 \
-                                t >= 0 ? (int)t : -(int)-t;             \
+                                (int)t - (t < (int)t);                  \
                             })
 
 #define CEIL(x)            CEIL_H(x, TMPVAR_H())
 #define CEIL_H(x, t)       ({                                           \
                                 __typeof__ (x) t = (x);                 \
-                                t >= 0 ? -(int)-t : (int)t;             \
+                                (int)t + (t > (int)t);                  \
                             })
 
 #define FRAC(x)             FRAC_H(x, TMPVAR_H())
 #define FRAC_H(x, t)        ({                                          \
                                 __typeof__ (x) t = (x);                 \
-                                t >= 0 ? t - (int)t : t + (int)-t;      \
+                                t - FLOOR(t);                           \
                             })
 
 // FRAC(x) + RFRAC(x) == 1
@@ -0,0 +1,497 @@
+// Render a range of a TrueType font's characters into a glyph atlas
+// for gfx_draw_text, and write it as a C header.
+//
+// Each glyph is rendered anti-aliased and hinted at the given pixel
+// size, cropped to its inked pixels, and packed end to end in the
+// atlas with stride equal to its width.  Metrics and advances are
+// rounded to whole pixels.  Kerning pairs within the range that adjust
+// the advance by at least a pixel are kept.
+//
+// With -L, render each glyph three times as wide, for the three color
+// stripes of an LCD pixel, and pad it to whole pixels.  gfx_draw_text
+// fills these glyphs with gfx_fill_mask_lcd.
+//
+// With -O, write the glyphs' quadratic contours instead, unscaled, for
+// gfx_draw_outline_text.  Points, metrics and kerning stay in font
+// units, and -s is ignored.
+
+#include <ctype.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_BBOX_H
+
+struct glyph_info {
+    size_t offset;
+    int    w, h;
+    int    left, top;
+    int    advance;
+    size_t kern_first;
+    size_t kern_count;
+};
+
+struct kern_pair {
+    int right;
+    int adjust;
+};
+
+struct outline_glyph_info {
+    size_t point_first;
+    size_t contour_first;
+    size_t contour_count;
+    int    advance;
+    FT_BBox bbox;
+    size_t kern_first;
+    size_t kern_count;
+};
+
+struct font_params {
+    std::string font_file;
+    std::string ident;
+    int         size;
+    int         first;
+    int         last;
+    bool        outline;
+    bool        lcd;
+
+    font_params()
+        : size(14),
+          first(' '),
+          last('~'),
+          outline(false),
+          lcd(false)
+    {}
+};
+
+static font_params params;
+static const char *outfile = NULL;
+
+static std::vector<unsigned char> atlas;
+static std::vector<glyph_info>    glyphs;
+static std::vector<kern_pair>     kerning;
+static int                        ascent, descent, line_height;
+
+static std::vector<outline_glyph_info> outline_glyphs;
+static std::vector<int>                points;          // x, y pairs
+static std::vector<int>                contour_ends;
+static int                             units_per_em;
+
+static void check(FT_Error err, const char *what)
+{
+    if (err) {
+        fprintf(stderr, "make-font: %s: FreeType error %d\n", what, err);
+        exit(1);
+    }
+}
+
+static int round_26_6(FT_Pos v)
+{
+    return (int)((v + 32) >> 6);
+}
+
+static void render_glyph(FT_Face face, int c)
+{
+    FT_UInt index = FT_Get_Char_Index(face, c);
+    glyph_info g = glyph_info();
+    g.offset = atlas.size();
+    if (index) {
+        check(FT_Load_Glyph(face, index, FT_LOAD_TARGET_LIGHT),
+              "FT_Load_Glyph");
+        check(FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL),
+              "FT_Render_Glyph");
+        const FT_Bitmap& bm = face->glyph->bitmap;
+        g.h       = bm.rows;
+        g.top     = face->glyph->bitmap_top;
+        if (params.lcd) {
+            // The glyph was rendered three times as wide.  Pad it
+            // to whole pixels, keeping its subpixel position.
+            int left = face->glyph->bitmap_left;
+            g.left = left >= 0 ? left / 3 : -((2 - left) / 3);
+            int pad = left - 3 * g.left;
+            g.w = (pad + bm.width + 2) / 3;
+            g.advance = round_26_6(face->glyph->advance.x / 3);
+            for (int y = 0; y < g.h; y++) {
+                const unsigned char *row = bm.buffer + y * bm.pitch;
+                atlas.insert(atlas.end(), pad, 0);
+                atlas.insert(atlas.end(), row, row + bm.width);
+                atlas.insert(atlas.end(), 3 * g.w - pad - bm.width, 0);
+            }
+        } else {
+            g.w       = bm.width;
+            g.left    = face->glyph->bitmap_left;
+            g.advance = round_26_6(face->glyph->advance.x);
+            for (int y = 0; y < g.h; y++) {
+                const unsigned char *row = bm.buffer + y * bm.pitch;
+                atlas.insert(atlas.end(), row, row + g.w);
+            }
+        }
+        if (g.h) {
+            ascent  = std::max(ascent, g.top);
+            descent = std::max(descent, g.h - g.top);
+        }
+    }
+    if (g.w > 255 || g.h > 255 || g.advance > 255 ||
+        g.left < -128 || g.left > 127 || g.top < -128 || g.top > 127) {
+        fprintf(stderr, "make-font: glyph %#x is too big\n", c);
+        exit(1);
+    }
+    glyphs.push_back(g);
+}
+
+static void find_kerning(FT_Face face, int c)
+{
+    glyph_info& g = glyphs[c - params.first];
+    g.kern_first = kerning.size();
+    if (!FT_HAS_KERNING(face))
+        return;
+    FT_UInt left = FT_Get_Char_Index(face, c);
+    for (int r = params.first; left && r <= params.last; r++) {
+        FT_UInt right = FT_Get_Char_Index(face, r);
+        FT_Vector k;
+        if (!right ||
+            FT_Get_Kerning(face, left, right, FT_KERNING_DEFAULT, &k))
+            continue;
+        int adjust = round_26_6(k.x);
+        if (adjust < -128 || adjust > 127) {
+            fprintf(stderr, "make-font: kerning %#x %#x is too big\n", c, r);
+            exit(1);
+        }
+        if (adjust) {
+            kern_pair kp = { r, adjust };
+            kerning.push_back(kp);
+        }
+    }
+    g.kern_count = kerning.size() - g.kern_first;
+    if (g.kern_count > 255 || kerning.size() > 65535) {
+        fprintf(stderr, "make-font: too many kerning pairs\n");
+        exit(1);
+    }
+}
+
+static void make_font(FT_Face face)
+{
+    check(FT_Set_Pixel_Sizes(face, 0, params.size), "FT_Set_Pixel_Sizes");
+    if (params.lcd) {
+        FT_Matrix triple_width = { 3 << 16, 0, 0, 1 << 16 };
+        FT_Set_Transform(face, &triple_width, NULL);
+    }
+
+    for (int c = params.first; c <= params.last; c++)
+        render_glyph(face, c);
+    for (int c = params.first; c <= params.last; c++)
+        find_kerning(face, c);
+    line_height = round_26_6(face->size->metrics.height);
+}
+
+static void extract_outline(FT_Face face, int c)
+{
+    FT_UInt index = FT_Get_Char_Index(face, c);
+    outline_glyph_info g = outline_glyph_info();
+    g.point_first = points.size() / 2;
+    g.contour_first = contour_ends.size();
+    if (index) {
+        check(FT_Load_Glyph(face, index, FT_LOAD_NO_SCALE),
+              "FT_Load_Glyph");
+        const FT_Outline& o = face->glyph->outline;
+        for (int i = 0; i < o.n_points; i++) {
+            int tag = FT_CURVE_TAG(o.tags[i]);
+            if (tag == FT_CURVE_TAG_CUBIC) {
+                fprintf(stderr,
+                        "make-font: glyph %#x has cubic curves\n", c);
+                exit(1);
+            }
+            int x = o.points[i].x, y = o.points[i].y;
+            if (x < -16384 || x > 16383 || y < -32768 || y > 32767) {
+                fprintf(stderr, "make-font: glyph %#x is too big\n", c);
+                exit(1);
+            }
+            points.push_back(x * 2 + (tag == FT_CURVE_TAG_ON));
+            points.push_back(y);
+        }
+        for (int i = 0; i < o.n_contours; i++)
+            contour_ends.push_back(o.contours[i]);
+        g.contour_count = o.n_contours;
+        g.advance = face->glyph->advance.x;
+        if (o.n_points) {
+            check(FT_Outline_Get_BBox(const_cast<FT_Outline *>(&o), &g.bbox),
+                  "FT_Outline_Get_BBox");
+            ascent  = std::max(ascent, (int)g.bbox.yMax);
+            descent = std::min(descent, (int)g.bbox.yMin);
+        }
+    }
+    if (g.contour_count > 255 || points.size() / 2 > 65535) {
+        fprintf(stderr, "make-font: too many points\n");
+        exit(1);
+    }
+    outline_glyphs.push_back(g);
+}
+
+static void find_outline_kerning(FT_Face face, int c)
+{
+    outline_glyph_info& g = outline_glyphs[c - params.first];
+    g.kern_first = kerning.size();
+    if (!FT_HAS_KERNING(face))
+        return;
+    FT_UInt left = FT_Get_Char_Index(face, c);
+    for (int r = params.first; left && r <= params.last; r++) {
+        FT_UInt right = FT_Get_Char_Index(face, r);
+        FT_Vector k;
+        if (!right ||
+            FT_Get_Kerning(face, left, right, FT_KERNING_UNSCALED, &k))
+            continue;
+        if (k.x) {
+            kern_pair kp = { r, (int)k.x };
+            kerning.push_back(kp);
+        }
+    }
+    g.kern_count = kerning.size() - g.kern_first;
+    if (g.kern_count > 255 || kerning.size() > 65535) {
+        fprintf(stderr, "make-font: too many kerning pairs\n");
+        exit(1);
+    }
+}
+
+static void make_outline_font(FT_Face face)
+{
+    for (int c = params.first; c <= params.last; c++)
+        extract_outline(face, c);
+    for (int c = params.first; c <= params.last; c++)
+        find_outline_kerning(face, c);
+    units_per_em = face->units_per_EM;
+    line_height = face->height;
+}
+
+static void load_font(void)
+{
+    FT_Library lib;
+    FT_Face face;
+    check(FT_Init_FreeType(&lib), "FT_Init_FreeType");
+    if (FT_New_Face(lib, params.font_file.c_str(), 0, &face)) {
+        fprintf(stderr,
+                "make-font: can't load font file %s\n",
+                params.font_file.c_str());
+        exit(1);
+    }
+    if (params.outline)
+        make_outline_font(face);
+    else
+        make_font(face);
+    FT_Done_Face(face);
+    FT_Done_FreeType(lib);
+}
+
+static std::string write_prologue(FILE *out, const char *header)
+{
+    std::string guard = params.ident;
+    for (size_t i = 0; i < guard.size(); i++)
+        guard[i] = toupper(guard[i]);
+    guard += "_FONT_included";
+
+    fprintf(out, "#ifndef %s\n", guard.c_str());
+    fprintf(out, "#define %s\n\n", guard.c_str());
+    fprintf(out, "/* This file was automatically generated by make-font.  "
+                 "Do not edit. */\n\n");
+    fprintf(out, "#include \"%s\"\n\n", header);
+    return guard;
+}
+
+static void write_font(FILE *out)
+{
+    const char *id = params.ident.c_str();
+    std::string guard = write_prologue(out, "gfx-text.h");
+
+    fprintf(out, "static const gfx_alpha8 %s_atlas[] = {\n", id);
+    for (size_t i = 0; i < atlas.size(); i++)
+        fprintf(out, "%s%#4x,%s",
+                i % 12 ? " " : "    ",
+                atlas[i],
+                i % 12 == 11 || i + 1 == atlas.size() ? "\n" : "");
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const gfx_glyph %s_glyphs[] = {\n", id);
+    for (size_t i = 0; i < glyphs.size(); i++) {
+        const glyph_info& g = glyphs[i];
+        fprintf(out,
+                "    { %6zu, %4zu, %3zu, %3d, %3d, %3d, %4d, %4d }, // %#x\n",
+                g.offset, g.kern_first, g.kern_count, g.advance,
+                g.w, g.h, g.left, g.top, params.first + (int)i);
+    }
+    fprintf(out, "};\n\n");
+
+    // An empty array isn't C, so there's always one pair.
+    fprintf(out, "static const gfx_kern_pair %s_kerning[] = {\n", id);
+    for (size_t i = 0; i < kerning.size(); i++)
+        fprintf(out, "    { %#4x, %3d },\n",
+                kerning[i].right, kerning[i].adjust);
+    if (kerning.empty())
+        fprintf(out, "    { 0, 0 },\n");
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const gfx_font %s_font = {\n", id);
+    fprintf(out, "    .atlas       = %s_atlas,\n", id);
+    fprintf(out, "    .glyphs      = %s_glyphs,\n", id);
+    fprintf(out, "    .kerning     = %s_kerning,\n", id);
+    fprintf(out, "    .first       = %d,\n", params.first);
+    fprintf(out, "    .count       = %d,\n", params.last - params.first + 1);
+    fprintf(out, "    .ascent      = %d,\n", ascent);
+    fprintf(out, "    .descent     = %d,\n", descent);
+    fprintf(out, "    .line_height = %d,\n", line_height);
+    fprintf(out, "    .lcd         = %s,\n", params.lcd ? "true" : "false");
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "#endif /* !%s */\n", guard.c_str());
+}
+
+static void write_outline_font(FILE *out)
+{
+    const char *id = params.ident.c_str();
+    std::string guard = write_prologue(out, "gfx-font.h");
+
+    fprintf(out, "static const int16_t %s_points[] = {\n", id);
+    for (size_t i = 0; i < points.size(); i += 2)
+        fprintf(out, "%s%6d, %5d,%s",
+                i % 8 ? " " : "    ",
+                points[i], points[i + 1],
+                i % 8 == 6 || i + 2 == points.size() ? "\n" : "");
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const uint16_t %s_contour_ends[] = {\n", id);
+    for (size_t i = 0; i < contour_ends.size(); i++)
+        fprintf(out, "%s%3d,%s",
+                i % 12 ? " " : "    ",
+                contour_ends[i],
+                i % 12 == 11 || i + 1 == contour_ends.size() ? "\n" : "");
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const gfx_outline_glyph %s_glyphs[] = {\n", id);
+    for (size_t i = 0; i < outline_glyphs.size(); i++) {
+        const outline_glyph_info& g = outline_glyphs[i];
+        fprintf(out,
+                "    { %5zu, %4zu, %2zu, %3zu, %4zu, %5d, "
+                "%5ld, %5ld, %5ld, %5ld }, // %#x\n",
+                g.point_first, g.contour_first, g.contour_count,
+                g.kern_count, g.kern_first, g.advance,
+                (long)g.bbox.xMin, (long)g.bbox.yMin,
+                (long)g.bbox.xMax, (long)g.bbox.yMax,
+                params.first + (int)i);
+    }
+    fprintf(out, "};\n\n");
+
+    // An empty array isn't C, so there's always one pair.
+    fprintf(out, "static const gfx_outline_kern_pair %s_kerning[] = {\n", id);
+    for (size_t i = 0; i < kerning.size(); i++)
+        fprintf(out, "    { %#4x, %5d },\n",
+                kerning[i].right, kerning[i].adjust);
+    if (kerning.empty())
+        fprintf(out, "    { 0, 0 },\n");
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const gfx_outline_font %s_font = {\n", id);
+    fprintf(out, "    .glyphs       = %s_glyphs,\n", id);
+    fprintf(out, "    .points       = %s_points,\n", id);
+    fprintf(out, "    .contour_ends = %s_contour_ends,\n", id);
+    fprintf(out, "    .kerning      = %s_kerning,\n", id);
+    fprintf(out, "    .units_per_em = %d,\n", units_per_em);
+    fprintf(out, "    .ascent       = %d,\n", ascent);
+    fprintf(out, "    .descent      = %d,\n", descent);
+    fprintf(out, "    .line_height  = %d,\n", line_height);
+    fprintf(out, "    .first        = %d,\n", params.first);
+    fprintf(out, "    .count        = %d,\n", params.last - params.first + 1);
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "#endif /* !%s */\n", guard.c_str());
+}
+
+static void save_font(const char *file)
+{
+    FILE *f = file ? fopen(file, "w") : stdout;
+    if (!f)
+        perror(file), exit(1);
+    if (params.outline)
+        write_outline_font(f);
+    else
+        write_font(f);
+    if (file)
+        fclose(f);
+}
+
+// use: make-font [-O | -L] [-s size] [-f first] [-l last] [-o file]
+//                font.ttf ident
+
+static void usage(FILE *out)
+{
+    fprintf(out,
+            "use: make-font [-O | -L] [-s size] [-f first] [-l last] "
+            "[-o file] font.ttf ident\n");
+    if (out == stderr)
+        exit(1);
+}
+
+static void parse_args(int argc, char *argv[])
+{
+    static const option longopts[] = {
+        { "outline", no_argument,       NULL, 'O' },
+        { "lcd",     no_argument,       NULL, 'L' },
+        { "size",    required_argument, NULL, 's' },
+        { "first",   required_argument, NULL, 'f' },
+        { "last",    required_argument, NULL, 'l' },
+        { "output",  required_argument, NULL, 'o' },
+        { NULL,      0,                 NULL, 0   },
+    };
+    int ch;
+    while ((ch = getopt_long(argc, argv, "OLs:f:l:o:", longopts, NULL)) != -1) {
+        switch (ch) {
+
+        case 'O':
+            params.outline = true;
+            break;
+
+        case 'L':
+            params.lcd = true;
+            break;
+
+        case 's':
+            params.size = atoi(optarg);
+            break;
+
+        case 'f':
+            params.first = strtol(optarg, NULL, 0);
+            break;
+
+        case 'l':
+            params.last = strtol(optarg, NULL, 0);
+            break;
+
+        case 'o':
+            outfile = optarg;
+            break;
+
+        default:
+            usage(stderr);
+        }
+    }
+    if (optind != argc - 2 || (params.outline && params.lcd))
+        usage(stderr);
+    if (params.size <= 0 ||
+        params.first < 0 || params.last > 255 || params.first > params.last ||
+        params.last - params.first > 254)
+        usage(stderr);
+    params.font_file = argv[optind];
+    params.ident = argv[optind + 1];
+}
+
+
+int main(int argc, char *argv[])
+{
+    parse_args(argc, argv);
+    load_font();
+    save_font(outfile);
+}
@@ -10,12 +10,32 @@ void gfx_button_init(gfx_button *button,
     button->position   = position;
     button->up_image   = up_image;
     button->down_image = down_image;
+    button->up_rle     = NULL;
+    button->down_rle   = NULL;
+}
+
+void gfx_button_init_rle(gfx_button *button,
+                         bool is_down,
+                         gfx_ipoint position,
+                         const gfx_rle_image *up_rle,
+                         const gfx_rle_image *down_rle)
+{
+    button->is_down    = is_down;
+    button->position   = position;
+    button->up_image   = NULL;
+    button->down_image = NULL;
+    button->up_rle     = up_rle;
+    button->down_rle   = down_rle;
 }
 
 bool gfx_point_is_in_button(const gfx_ipoint *pt, const gfx_button *btn)
 {
     int x = pt->x - btn->position.x;
     int y = pt->y - btn->position.y;
+    if (btn->up_rle) {
+        const gfx_rle_image *img = btn->up_rle;
+        return x >= 0 && x < (int)img->w && y >= 0 && y < (int)img->h;
+    }
     const gfx_pixtile *img = btn->up_image;
     if (x < img->x || x >= (int)(img->x + img->w))
         return false;
@@ -26,6 +46,11 @@ bool gfx_point_is_in_button(const gfx_ipoint *pt, const gfx_button *btn)
 
 void gfx_draw_button(gfx_pixtile *tile, const gfx_button *btn)
 {
+    if (btn->up_rle) {
+        const gfx_rle_image *src = btn->is_down ? btn->down_rle : btn->up_rle;
+        gfx_draw_rle_image(tile, src, btn->position);
+        return;
+    }
     const gfx_pixtile *src = btn->is_down ? btn->down_image : btn->up_image;
     gfx_copy_pixtile(tile, src, btn->position);
 }
@@ -0,0 +1,424 @@
+#include <gfx-display-list.h>
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <gfx.h>
+#include <gfx-pixtile.h>
+#include <gfx-region.h>
+#include <lcd.h>
+#include <math-util.h>
+
+// The arena is static, so on the device it lives in CCM with the rest
+// of the data.  16 KB holds nearly three hundred rects, lines and
+// circles.  With the last frame's signatures, the list costs 21 KB.
+#ifndef GFX_DISPLAY_LIST_BYTES
+#define GFX_DISPLAY_LIST_BYTES 16384
+#endif
+
+#define ARENA_BYTES        GFX_DISPLAY_LIST_BYTES
+#define ARENA_ALIGN        8
+
+// The last frame's first calls are remembered to find what changed.
+#define MAX_SIGNATURES     256
+
+#define BAND_ROWS          ((int)LCD_MAX_TILE_ROWS)
+#define BAND_COUNT         ((LCD_HEIGHT + BAND_ROWS - 1) / BAND_ROWS)
+
+// A recorded call.  Its arguments follow it in the arena.
+typedef struct command {
+    gfx_draw_func  *func;
+    gfx_irect       box;        // clipped to the screen
+    struct command *next;       // next in the whole list
+    uint32_t        hash;       // of func, box and arguments
+} command;
+
+#define ARGS_OFFSET                                                     \
+    ((sizeof (command) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+// A command's place in a band.
+typedef struct band_ref {
+    const command   *cmd;
+    struct band_ref *next;
+} band_ref;
+
+// A call of the last frame.
+typedef struct signature {
+    uint32_t  hash;
+    gfx_irect box;
+} signature;
+
+static uint8_t   arena[ARENA_BYTES] __attribute__((aligned(ARENA_ALIGN)));
+static size_t    arena_used;
+static command  *first_command;
+static command **last_command = &first_command;
+static band_ref *first_ref[BAND_COUNT];
+static band_ref **last_ref[BAND_COUNT];
+
+static signature signatures[MAX_SIGNATURES];
+static size_t    signature_count;
+static bool      signatures_known;   // false until the first frame
+                                     // and after one with too many
+
+static void *alloc(size_t size)
+{
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (size > ARENA_BYTES - arena_used)
+        return NULL;
+    void *p = arena + arena_used;
+    arena_used += size;
+    return p;
+}
+
+static inline void *command_args(const command *cmd)
+{
+    return (uint8_t *)cmd + ARGS_OFFSET;
+}
+
+// FNV-1a, a word at a time.
+static uint32_t hash_bytes(uint32_t h, const void *p, size_t size)
+{
+    const uint8_t *b = p;
+    for ( ; size >= 4; size -= 4, b += 4) {
+        uint32_t w;
+        memcpy(&w, b, sizeof w);
+        h = (h ^ w) * 16777619;
+    }
+    for ( ; size; --size)
+        h = (h ^ *b++) * 16777619;
+    return h;
+}
+
+// Hash the call once its arguments are in place.
+static void seal(command *cmd, size_t size)
+{
+    uint32_t h = 2166136261;
+    h = hash_bytes(h, &cmd->func, sizeof cmd->func);
+    h = hash_bytes(h, &cmd->box, sizeof cmd->box);
+    cmd->hash = hash_bytes(h, command_args(cmd), size);
+}
+
+static inline bool boxes_overlap(const gfx_irect *a, const gfx_irect *b)
+{
+    return a->x0 < b->x1 && b->x0 < a->x1 &&
+           a->y0 < b->y1 && b->y0 < a->y1;
+}
+
+void gfx_clear_display_list(void)
+{
+    arena_used = 0;
+    first_command = NULL;
+    last_command = &first_command;
+    for (int i = 0; i < BAND_COUNT; i++) {
+        first_ref[i] = NULL;
+        last_ref[i] = &first_ref[i];
+    }
+}
+
+// Clip the box to the screen.  False if nothing is left.
+static bool clip_to_screen(gfx_irect *box)
+{
+    box->x0 = MAX(box->x0, 0);
+    box->y0 = MAX(box->y0, 0);
+    box->x1 = MIN(box->x1, LCD_WIDTH);
+    box->y1 = MIN(box->y1, LCD_HEIGHT);
+    return box->x0 < box->x1 && box->y0 < box->y1;
+}
+
+// Allocate a command with room for size bytes of arguments, and bin
+// it into the bands its box, clipped to the screen, touches.  NULL if
+// it doesn't fit.
+static command *record(const gfx_irect *box,
+                       gfx_draw_func *func,
+                       size_t size)
+{
+    if (!last_ref[0])
+        gfx_clear_display_list();
+
+    int band0 = box->y0 / BAND_ROWS;
+    int band1 = (box->y1 - 1) / BAND_ROWS;
+    size_t saved = arena_used;
+    command *cmd = alloc(ARGS_OFFSET + size);
+    band_ref *refs = alloc((band1 - band0 + 1) * sizeof *refs);
+    if (!cmd || !refs) {
+        arena_used = saved;
+        return NULL;
+    }
+
+    cmd->func = func;
+    cmd->box = *box;
+    cmd->next = NULL;
+    *last_command = cmd;
+    last_command = &cmd->next;
+    for (int b = band0; b <= band1; b++, refs++) {
+        refs->cmd = cmd;
+        refs->next = NULL;
+        *last_ref[b] = refs;
+        last_ref[b] = &refs->next;
+    }
+    return cmd;
+}
+
+bool gfx_record(gfx_irect box,
+                gfx_draw_func *func,
+                const void *args,
+                size_t size)
+{
+    if (!clip_to_screen(&box))
+        return true;
+    command *cmd = record(&box, func, size);
+    if (!cmd)
+        return false;
+    memcpy(command_args(cmd), args, size);
+    seal(cmd, size);
+    return true;
+}
+
+void gfx_replay_display_list(gfx_pixtile *tile)
+{
+    gfx_irect t = {
+        tile->x,                 tile->y,
+        tile->x + (int)tile->w,  tile->y + (int)tile->h,
+    };
+    if (t.y0 >= 0 && t.y0 < LCD_HEIGHT) {
+        int band = t.y0 / BAND_ROWS;
+        if (t.y1 <= (band + 1) * BAND_ROWS) {
+            for (const band_ref *r = first_ref[band]; r; r = r->next)
+                if (boxes_overlap(&r->cmd->box, &t))
+                    (*r->cmd->func)(tile, command_args(r->cmd));
+            return;
+        }
+    }
+    for (const command *cmd = first_command; cmd; cmd = cmd->next)
+        if (boxes_overlap(&cmd->box, &t))
+            (*cmd->func)(tile, command_args(cmd));
+}
+
+void gfx_damage_display_list(gfx_region *damage)
+{
+    if (!signatures_known)
+        gfx_region_add_rect(damage,
+                            (gfx_irect) { 0, 0, LCD_WIDTH, LCD_HEIGHT });
+
+    // Compare the calls in order.  Where they differ, both the old
+    // call's pixels and the new one's may change.
+    size_t i = 0;
+    for (const command *cmd = first_command; cmd; cmd = cmd->next, i++) {
+        if (i >= MAX_SIGNATURES) {
+            gfx_region_add_rect(damage, cmd->box);
+            continue;
+        }
+        signature *sig = &signatures[i];
+        if (i >= signature_count) {
+            gfx_region_add_rect(damage, cmd->box);
+        } else if (sig->hash != cmd->hash) {
+            gfx_region_add_rect(damage, sig->box);
+            gfx_region_add_rect(damage, cmd->box);
+        }
+        sig->hash = cmd->hash;
+        sig->box = cmd->box;
+    }
+    for (size_t j = i; j < signature_count; j++)
+        gfx_region_add_rect(damage, signatures[j].box);
+
+    signature_count = MIN(i, (size_t)MAX_SIGNATURES);
+    signatures_known = i <= MAX_SIGNATURES;
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Recorders
+
+// The pixels a shape within [x0, x1) x [y0, y1) can touch, with two
+// to spare: anti-aliased lines' end pixels reach past their endpoints.
+// Clamped near the screen first, so any float converts.
+static gfx_irect shape_box(float x0, float y0, float x1, float y1)
+{
+    x0 = CLAMP(-3.0f, LCD_WIDTH  + 3.0f, x0);
+    x1 = CLAMP(-3.0f, LCD_WIDTH  + 3.0f, x1);
+    y0 = CLAMP(-3.0f, LCD_HEIGHT + 3.0f, y0);
+    y1 = CLAMP(-3.0f, LCD_HEIGHT + 3.0f, y1);
+    return (gfx_irect) {
+        (int)floorf(x0) - 2, (int)floorf(y0) - 2,
+        (int)ceilf(x1)  + 2, (int)ceilf(y1)  + 2,
+    };
+}
+
+typedef struct rect_args {
+    float      x, y, w, h;
+    gfx_rgb888 color;
+} rect_args;
+
+typedef struct line_args {
+    float      x0, y0, x1, y1;
+    gfx_rgb888 color;
+} line_args;
+
+typedef struct circle_args {
+    float      cx, cy, r;
+    gfx_rgb888 color;
+} circle_args;
+
+typedef struct mask_args {
+    gfx_mask   mask;
+    gfx_rgb888 color;
+} mask_args;
+
+typedef struct text_args {
+    const gfx_font *font;
+    gfx_ipoint      origin;
+    gfx_rgb888      color;
+    char            text[];
+} text_args;
+
+static void replay_fill_rect(gfx_pixtile *tile, const void *args)
+{
+    const rect_args *a = args;
+    gfx_fill_rect(tile, a->x, a->y, a->w, a->h, a->color);
+}
+
+static void replay_fill_rect_aa(gfx_pixtile *tile, const void *args)
+{
+    const rect_args *a = args;
+    gfx_fill_rect_aa(tile, a->x, a->y, a->w, a->h, a->color);
+}
+
+static void replay_draw_line(gfx_pixtile *tile, const void *args)
+{
+    const line_args *a = args;
+    gfx_draw_line(tile, a->x0, a->y0, a->x1, a->y1, a->color);
+}
+
+static void replay_draw_line_aa(gfx_pixtile *tile, const void *args)
+{
+    const line_args *a = args;
+    gfx_draw_line_aa(tile, a->x0, a->y0, a->x1, a->y1, a->color);
+}
+
+static void replay_fill_circle(gfx_pixtile *tile, const void *args)
+{
+    const circle_args *a = args;
+    gfx_fill_circle(tile, a->cx, a->cy, a->r, a->color);
+}
+
+static void replay_fill_circle_aa(gfx_pixtile *tile, const void *args)
+{
+    const circle_args *a = args;
+    gfx_fill_circle_aa(tile, a->cx, a->cy, a->r, a->color);
+}
+
+static void replay_fill_mask(gfx_pixtile *tile, const void *args)
+{
+    const mask_args *a = args;
+    gfx_fill_mask(tile, &a->mask, a->color);
+}
+
+static void replay_draw_text(gfx_pixtile *tile, const void *args)
+{
+    const text_args *a = args;
+    gfx_draw_text(tile, a->font, a->origin, a->text, a->color);
+}
+
+static bool record_rect(gfx_draw_func *func,
+                        float x, float y, float w, float h,
+                        gfx_rgb888 color)
+{
+    rect_args a = { x, y, w, h, color };
+    return gfx_record(shape_box(x, y, x + w, y + h), func, &a, sizeof a);
+}
+
+static bool record_line(gfx_draw_func *func,
+                        float x0, float y0, float x1, float y1,
+                        gfx_rgb888 color)
+{
+    line_args a = { x0, y0, x1, y1, color };
+    gfx_irect box = shape_box(MIN(x0, x1), MIN(y0, y1),
+                              MAX(x0, x1), MAX(y0, y1));
+    return gfx_record(box, func, &a, sizeof a);
+}
+
+static bool record_circle(gfx_draw_func *func,
+                          float cx, float cy, float r,
+                          gfx_rgb888 color)
+{
+    circle_args a = { cx, cy, r, color };
+    gfx_irect box = shape_box(cx - r, cy - r, cx + r, cy + r);
+    return gfx_record(box, func, &a, sizeof a);
+}
+
+bool gfx_record_fill_rect(float x, float y,
+                          float w, float h,
+                          gfx_rgb888 color)
+{
+    return record_rect(replay_fill_rect, x, y, w, h, color);
+}
+
+bool gfx_record_fill_rect_aa(float x, float y,
+                             float w, float h,
+                             gfx_rgb888 color)
+{
+    return record_rect(replay_fill_rect_aa, x, y, w, h, color);
+}
+
+bool gfx_record_draw_line(float x0, float y0,
+                          float x1, float y1,
+                          gfx_rgb888 color)
+{
+    return record_line(replay_draw_line, x0, y0, x1, y1, color);
+}
+
+bool gfx_record_draw_line_aa(float x0, float y0,
+                             float x1, float y1,
+                             gfx_rgb888 color)
+{
+    return record_line(replay_draw_line_aa, x0, y0, x1, y1, color);
+}
+
+bool gfx_record_fill_circle(float cx, float cy,
+                            float r,
+                            gfx_rgb888 color)
+{
+    return record_circle(replay_fill_circle, cx, cy, r, color);
+}
+
+bool gfx_record_fill_circle_aa(float cx, float cy,
+                               float r,
+                               gfx_rgb888 color)
+{
+    return record_circle(replay_fill_circle_aa, cx, cy, r, color);
+}
+
+bool gfx_record_fill_mask(const gfx_mask *mask, gfx_rgb888 color)
+{
+    // Padding is hashed too.
+    mask_args a;
+    memset(&a, 0, sizeof a);
+    a.mask = *mask;
+    a.color = color;
+    gfx_irect box = {
+        mask->x,                 mask->y,
+        mask->x + (int)mask->w,  mask->y + (int)mask->h,
+    };
+    return gfx_record(box, replay_fill_mask, &a, sizeof a);
+}
+
+bool gfx_record_draw_text(const gfx_font *font,
+                          gfx_ipoint origin,
+                          const char *text,
+                          gfx_rgb888 color)
+{
+    size_t size = offsetof(text_args, text) + strlen(text) + 1;
+    gfx_irect box = gfx_text_bounds(font, origin, text);
+    if (!clip_to_screen(&box))
+        return true;
+    command *cmd = record(&box, replay_draw_text, size);
+    if (!cmd)
+        return false;
+    text_args *a = command_args(cmd);
+    a->font = font;
+    a->origin = origin;
+    a->color = color;
+    strcpy(a->text, text);
+    seal(cmd, size);
+    return true;
+}
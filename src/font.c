@@ -0,0 +1,481 @@
+#include <gfx-font.h>
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <gfx.h>
+#include <gfx-path.h>
+#include <gfx-pixtile.h>
+#include <gfx-polygon.h>
+#include <math-util.h>
+
+// The glyph cache is static, so on the device it lives in CCM with
+// the rest of the data.  8 KB holds the printable ASCII characters of
+// a 16 pixel font with room to spare; with its entries, the cache
+// costs 10 KB.  A glyph may use at most a quarter of it; bigger ones
+// are not cached.
+#ifndef GFX_GLYPH_CACHE_BYTES
+#define GFX_GLYPH_CACHE_BYTES 8192
+#endif
+
+#define CACHE_BYTES        GFX_GLYPH_CACHE_BYTES
+#define CACHE_ENTRIES      128
+#define MAX_CACHED_BYTES   (CACHE_BYTES / 4)
+#define HASH_BUCKETS       64   // power of two
+#define NO_ENTRY           0xFF
+
+_Static_assert(CACHE_ENTRIES < NO_ENTRY, "entry indices must fit in a byte");
+_Static_assert(CACHE_BYTES <= 0x10000, "offsets must fit in 16 bits");
+
+// Sizes are cached in sixteenths of a pixel per em.
+#define SIZE_SHIFT         4
+
+typedef struct cache_entry {
+    const gfx_outline_font *font;       // NULL if the entry is free
+    uint32_t                last_used;
+    uint16_t                offset;     // coverage in cache_pixels
+    uint16_t                bytes;
+    uint16_t                size;       // pixels per em << SIZE_SHIFT
+    uint8_t                 c;
+    uint8_t                 next;       // hash chain
+} cache_entry;
+
+static gfx_alpha8  cache_pixels[CACHE_BYTES];
+static cache_entry cache_entries[CACHE_ENTRIES];
+static uint8_t     cache_buckets[HASH_BUCKETS] = {
+    [0 ... HASH_BUCKETS - 1] = NO_ENTRY
+};
+static size_t      cache_end;           // first byte never allocated
+static size_t      cache_live;          // bytes held by entries
+static uint32_t    cache_clock;         // last_used of the newest use
+
+// A glyph at one size, with its pen on a pixel corner.  The box
+// bounds its coverage, in pixels from the pen.
+typedef struct sized_glyph {
+    const gfx_outline_font  *font;
+    const gfx_outline_glyph *glyph;
+    uint8_t                  c;
+    uint16_t                 size;      // pixels per em << SIZE_SHIFT
+    float                    scale;     // pixels per font unit
+    int                      left, top; // top is rows above the baseline
+    int                      w, h;
+} sized_glyph;
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Outlines
+
+typedef struct glyph_outline {
+    const sized_glyph  *sg;
+    float               pen_x, pen_y;
+    gfx_path_emit_func *emit;
+    void               *emit_closure;
+    gfx_point           current;
+} glyph_outline;
+
+static inline gfx_point glyph_point(const glyph_outline *go,
+                                    const int16_t *p,
+                                    bool *on_curve)
+{
+    *on_curve = p[0] & 1;
+    return (gfx_point) {{
+        go->pen_x + (p[0] >> 1) * go->sg->scale,
+        go->pen_y - p[1] * go->sg->scale,
+    }};
+}
+
+static inline gfx_point midpoint(gfx_point a, gfx_point b)
+{
+    return (gfx_point) {{ (a.x + b.x) / 2, (a.y + b.y) / 2 }};
+}
+
+static void contour_line(glyph_outline *go, gfx_point p)
+{
+    go->emit(go->emit_closure, GFX_PATH_LINE, p);
+    go->current = p;
+}
+
+static void contour_quad(glyph_outline *go, gfx_point c, gfx_point p)
+{
+    gfx_point q[3] = { go->current, c, p };
+    gfx_flatten_quad(q, GFX_PATH_TOLERANCE, go->emit, go->emit_closure);
+    go->current = p;
+}
+
+// Emit one contour of n points, starting on the curve.
+static void emit_contour(glyph_outline *go, const int16_t *pts, size_t n)
+{
+    bool on0, on_last;
+    gfx_point p0 = glyph_point(go, pts, &on0);
+    gfx_point p_last = glyph_point(go, pts + 2 * (n - 1), &on_last);
+
+    gfx_point start;
+    size_t i = 0, end = n;
+    if (on0) {
+        start = p0;
+        i = 1;
+    } else if (on_last) {
+        start = p_last;
+        end = n - 1;
+    } else
+        start = midpoint(p_last, p0);
+    go->emit(go->emit_closure, GFX_PATH_MOVE, start);
+    go->current = start;
+
+    bool have_control = false;
+    gfx_point control = start;
+    for ( ; i < end; i++) {
+        bool on;
+        gfx_point p = glyph_point(go, pts + 2 * i, &on);
+        if (on) {
+            if (have_control)
+                contour_quad(go, control, p);
+            else
+                contour_line(go, p);
+            have_control = false;
+        } else {
+            if (have_control)
+                contour_quad(go, control, midpoint(control, p));
+            control = p;
+            have_control = true;
+        }
+    }
+    if (have_control)
+        contour_quad(go, control, start);
+    else
+        contour_line(go, start);
+}
+
+static void emit_glyph_outline(void *closure,
+                               const gfx_pixtile *band,
+                               gfx_path_emit_func *emit,
+                               void *emit_closure)
+{
+    (void)band;
+    glyph_outline *go = closure;
+    const gfx_outline_font *font = go->sg->font;
+    const gfx_outline_glyph *g = go->sg->glyph;
+    const int16_t *pts = font->points + 2 * g->point_first;
+    const uint16_t *ends = font->contour_ends + g->contour_first;
+
+    go->emit = emit;
+    go->emit_closure = emit_closure;
+    size_t first = 0;
+    for (size_t i = 0; i < g->contour_count; i++) {
+        size_t last = ends[i];
+        emit_contour(go, pts + 2 * first, last - first + 1);
+        first = last + 1;
+    }
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Glyph Cache
+
+static unsigned hash_key(const gfx_outline_font *font,
+                         uint8_t c,
+                         uint16_t size)
+{
+    uint32_t h = (uint32_t)(uintptr_t)font;
+    h ^= c * 0x9E3779B1u ^ size * 0x85EBCA77u;
+    return (h ^ h >> 16) & (HASH_BUCKETS - 1);
+}
+
+static void evict_entry(size_t i)
+{
+    cache_entry *e = &cache_entries[i];
+    uint8_t *link = &cache_buckets[hash_key(e->font, e->c, e->size)];
+    while (*link != i)
+        link = &cache_entries[*link].next;
+    *link = e->next;
+    cache_live -= e->bytes;
+    e->font = NULL;
+}
+
+// Evict the least recently used entry.
+static void evict_lru(void)
+{
+    size_t lru = CACHE_ENTRIES;
+    for (size_t i = 0; i < CACHE_ENTRIES; i++) {
+        const cache_entry *e = &cache_entries[i];
+        if (!e->font)
+            continue;
+        if (lru == CACHE_ENTRIES ||
+            (int32_t)(e->last_used - cache_entries[lru].last_used) < 0)
+            lru = i;
+    }
+    evict_entry(lru);
+}
+
+// Slide the live glyphs down over the holes left by evicted ones,
+// in their order in the cache.
+static void compact_cache(void)
+{
+    size_t end = 0;
+    while (true) {
+        cache_entry *next = NULL;
+        for (size_t i = 0; i < CACHE_ENTRIES; i++) {
+            cache_entry *e = &cache_entries[i];
+            if (e->font && e->offset >= end &&
+                (!next || e->offset < next->offset))
+                next = e;
+        }
+        if (!next)
+            break;
+        if (next->offset != end) {
+            memmove(cache_pixels + end,
+                    cache_pixels + next->offset,
+                    next->bytes);
+            next->offset = end;
+        }
+        end += next->bytes;
+    }
+    cache_end = end;
+}
+
+// Allocate an entry with bytes of coverage, evicting as needed.
+static cache_entry *alloc_entry(size_t bytes)
+{
+    while (true) {
+        if (cache_live + bytes <= CACHE_BYTES) {
+            for (size_t i = 0; i < CACHE_ENTRIES; i++)
+                if (!cache_entries[i].font)
+                    goto found;
+        }
+        evict_lru();
+    }
+found:
+    if (cache_end + bytes > CACHE_BYTES)
+        compact_cache();
+    for (size_t i = 0; i < CACHE_ENTRIES; i++) {
+        cache_entry *e = &cache_entries[i];
+        if (!e->font) {
+            e->offset = cache_end;
+            e->bytes = bytes;
+            cache_end += bytes;
+            cache_live += bytes;
+            return e;
+        }
+    }
+    return NULL;                // not reached
+}
+
+// Find the glyph's coverage in the cache, or rasterize it there.
+static const gfx_alpha8 *cached_coverage(const sized_glyph *sg)
+{
+    unsigned bucket = hash_key(sg->font, sg->c, sg->size);
+    for (uint8_t i = cache_buckets[bucket]; i != NO_ENTRY; ) {
+        cache_entry *e = &cache_entries[i];
+        if (e->font == sg->font && e->c == sg->c && e->size == sg->size) {
+            e->last_used = ++cache_clock;
+            return cache_pixels + e->offset;
+        }
+        i = e->next;
+    }
+
+    cache_entry *e = alloc_entry(sg->w * sg->h);
+    e->font      = sg->font;
+    e->c         = sg->c;
+    e->size      = sg->size;
+    e->last_used = ++cache_clock;
+    e->next      = cache_buckets[bucket];
+    cache_buckets[bucket] = e - cache_entries;
+
+    glyph_outline go = { .sg = sg, .pen_x = 0, .pen_y = 0 };
+    gfx_rasterize_outline(cache_pixels + e->offset,
+                          sg->left, -sg->top,
+                          sg->w, sg->h,
+                          sg->w,
+                          emit_glyph_outline, &go,
+                          GFX_FILL_NONZERO, true);
+    return cache_pixels + e->offset;
+}
+
+void gfx_flush_glyph_cache(void)
+{
+    for (size_t i = 0; i < CACHE_ENTRIES; i++)
+        cache_entries[i].font = NULL;
+    for (size_t i = 0; i < HASH_BUCKETS; i++)
+        cache_buckets[i] = NO_ENTRY;
+    cache_end = cache_live = 0;
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Text
+
+static inline const gfx_outline_glyph *find_glyph(const gfx_outline_font *font,
+                                                  unsigned char c)
+{
+    unsigned i = c - font->first;
+    return i < font->count ? &font->glyphs[i] : NULL;
+}
+
+static int kerning(const gfx_outline_font *font,
+                   const gfx_outline_glyph *left,
+                   unsigned char right)
+{
+    const gfx_outline_kern_pair *k = font->kerning + left->kern_first;
+    for (size_t i = 0; i < left->kern_count && k[i].right <= right; i++)
+        if (k[i].right == right)
+            return k[i].adjust;
+    return 0;
+}
+
+// Quantize the size, and return pixels per em << SIZE_SHIFT, or 0 if
+// nothing should be drawn.
+static uint16_t size_key(float size)
+{
+    float q = size * (1 << SIZE_SHIFT) + 0.5f;
+    if (!(q >= 1))
+        return 0;
+    return q < 0xFFFF ? (uint16_t)q : 0xFFFF;
+}
+
+float gfx_outline_text_width(const gfx_outline_font *font,
+                             float size,
+                             const char *text)
+{
+    float scale = size / font->units_per_em;
+    int w = 0, x = 0;
+    const gfx_outline_glyph *prev = NULL;
+    for (const char *p = text; ; p++) {
+        if (!*p || *p == '\n') {
+            w = MAX(w, x);
+            if (!*p)
+                return w * scale;
+            x = 0;
+            prev = NULL;
+            continue;
+        }
+        unsigned char c = *p;
+        const gfx_outline_glyph *g = find_glyph(font, c);
+        if (!g)
+            continue;
+        if (prev)
+            x += kerning(font, prev, c);
+        x += g->advance;
+        prev = g;
+    }
+}
+
+static void draw_glyph(gfx_pixtile *tile,
+                       const sized_glyph *sg,
+                       int pen_x, int pen_y,
+                       gfx_rgb888 color,
+                       gfx_alpha8 alpha,
+                       bool blend)
+{
+    int gx0 = pen_x + sg->left, gx1 = gx0 + sg->w;
+    int gy0 = pen_y - sg->top,  gy1 = gy0 + sg->h;
+    int x0 = MAX(gx0, tile->x), x1 = MIN(gx1, tile->x + (int)tile->w);
+    int y0 = MAX(gy0, tile->y), y1 = MIN(gy1, tile->y + (int)tile->h);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    if (sg->w > 255 || sg->h > 255 || sg->w * sg->h > MAX_CACHED_BYTES) {
+        glyph_outline go = { .sg = sg, .pen_x = pen_x, .pen_y = pen_y };
+        gfx_fill_outline(tile, emit_glyph_outline, &go,
+                         GFX_FILL_NONZERO, true, color, alpha);
+        return;
+    }
+
+    gfx_mask mask = {
+        .pixels = cached_coverage(sg) + (y0 - gy0) * sg->w + (x0 - gx0),
+        .x      = x0,
+        .y      = y0,
+        .w      = x1 - x0,
+        .h      = y1 - y0,
+        .stride = sg->w,
+    };
+    if (blend)
+        gfx_fill_mask_blend_unclipped(tile, &mask, color, alpha);
+    else
+        gfx_fill_mask_unclipped(tile, &mask, color);
+}
+
+static void draw_outline_text(gfx_pixtile *tile,
+                              const gfx_outline_font *font,
+                              float size,
+                              gfx_point origin,
+                              const char *text,
+                              gfx_rgb888 color,
+                              gfx_alpha8 alpha,
+                              bool blend)
+{
+    if (blend && alpha == 0)
+        return;
+    uint16_t key = size_key(size);
+    if (!key)
+        return;
+
+    float scale = (float)key / (font->units_per_em << SIZE_SHIFT);
+    int clip_y0 = tile->y, clip_y1 = tile->y + (int)tile->h;
+    float above = font->ascent * scale, below = -font->descent * scale;
+
+    for (float line_y = origin.y; ; line_y += font->line_height * scale) {
+        int y = FLOOR(line_y + 0.5f);
+
+        // Lines are drawn top to bottom, so once one is below the
+        // tile, the rest are too.
+        if (y - above >= clip_y1)
+            return;
+
+        if (y + below <= clip_y0) {
+            text = strchr(text, '\n');
+            if (!text++)
+                return;
+            continue;           // -> next line
+        }
+
+        const gfx_outline_glyph *prev = NULL;
+        int x = 0;              // font units
+        for ( ; *text && *text != '\n'; text++) {
+            unsigned char c = *text;
+            const gfx_outline_glyph *g = find_glyph(font, c);
+            if (!g)
+                continue;
+            if (prev)
+                x += kerning(font, prev, c);
+            prev = g;
+            if (g->x_min < g->x_max && g->y_min < g->y_max) {
+                sized_glyph sg = {
+                    .font  = font,
+                    .glyph = g,
+                    .c     = c,
+                    .size  = key,
+                    .scale = scale,
+                    .left  = FLOOR(g->x_min * scale),
+                    .top   = CEIL(g->y_max * scale),
+                };
+                sg.w = CEIL(g->x_max * scale) - sg.left;
+                sg.h = sg.top - FLOOR(g->y_min * scale);
+                draw_glyph(tile, &sg,
+                           FLOOR(origin.x + x * scale + 0.5f), y,
+                           color, alpha, blend);
+            }
+            x += g->advance;
+        }
+        if (!*text++)
+            return;
+    }
+}
+
+void gfx_draw_outline_text(gfx_pixtile *tile,
+                           const gfx_outline_font *font,
+                           float size,
+                           gfx_point origin,
+                           const char *text,
+                           gfx_rgb888 color)
+{
+    draw_outline_text(tile, font, size, origin, text, color, 0xFF, false);
+}
+
+void gfx_draw_outline_text_blend(gfx_pixtile *tile,
+                                 const gfx_outline_font *font,
+                                 float size,
+                                 gfx_point origin,
+                                 const char *text,
+                                 gfx_rgb888 color,
+                                 gfx_alpha8 alpha)
+{
+    draw_outline_text(tile, font, size, origin, text, color, alpha, true);
+}
@@ -1,38 +1,462 @@
 #include <gfx.h>
 
 #include <assert.h>
+#include <math.h>
 #include <stdbool.h>
+#include <string.h>
 
+#include <gfx-gradient.h>
+#include <gfx-paint.h>
 #include <gfx-pixtile.h>
 #include <math-util.h>
 
 // --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
-// Pixels
+// Fixed Point
+
+// 16.16 fixed point.  Screen coordinates fit with lots of room.
+typedef int32_t fix16;
+
+#define FIX16_ONE  0x10000
+#define FIX16_HALF 0x08000
+
+static inline fix16 float_to_fix16(float f)
+{
+    return (fix16)(f * FIX16_ONE);
+}
+
+static inline fix16 fix16_mul(fix16 a, fix16 b)
+{
+    return (fix16)((int64_t)a * b >> 16);
+}
+
+static inline int fix16_floor(fix16 f)
+{
+    return f >> 16;
+}
+
+static inline int fix16_ceil(fix16 f)
+{
+    return (f + FIX16_ONE - 1) >> 16;
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Variants
+
+// Most primitives are written once, as an inline function
+// parameterized by these flags.  Each public entry point passes
+// constant flags, so the compiler generates a specialized copy with
+// the unused paths removed.
+
+typedef enum variant_flags {
+    VF_AA        = 1 << 0,
+    VF_BLEND     = 1 << 1,
+    VF_UNCLIPPED = 1 << 2,
+    VF_GRADIENT  = 1 << 3,
+} variant_flags;
+
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+#define NEVER_INLINE  __attribute__((noinline))
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Blending
+
+// Blending works on pixels in "spread" form, with green moved to the
+// high halfword.
+//
+//     ----- gggggg ----- rrrrr ------ bbbbb
+//
+// Every field has at least five clear bits above it, so a spread
+// pixel can be scaled by a 5 bit alpha, 0 .. 32, with one multiply
+// and no carries between channels.
+
+#define SPREAD_MASK 0x07E0F81Fu
+#define SPREAD_HALF 0x02008010  // one half in each field, for rounding
+
+static ALWAYS_INLINE uint32_t ror16(uint32_t w)
+{
+    return w << 16 | w >> 16;
+}
+
+static ALWAYS_INLINE uint32_t spread_rgb565(gfx_rgb565 c)
+{
+    return (c | (uint32_t)c << 16) & SPREAD_MASK;
+}
+
+static ALWAYS_INLINE gfx_rgb565 unspread(uint32_t s)
+{
+    return s | s >> 16;
+}
+
+static ALWAYS_INLINE uint32_t alpha5(gfx_alpha8 alpha)
+{
+    return (alpha + 4) >> 3;
+}
+
+// Blend one spread pixel.  src_term is the spread source times
+// alpha plus SPREAD_HALF, inv_alpha is 32 - alpha.
+static ALWAYS_INLINE uint32_t blend_spread(uint32_t dest,
+                                           uint32_t src_term,
+                                           uint32_t inv_alpha)
+{
+    return (dest * inv_alpha + src_term) >> 5 & SPREAD_MASK;
+}
+
+// Linear interpolation between spread pixels, f in 0 .. 32.
+static ALWAYS_INLINE uint32_t lerp_spread(uint32_t a, uint32_t b, uint32_t f)
+{
+    return blend_spread(a, b * f + SPREAD_HALF, 32 - f);
+}
+
+// Blend a word holding two pixels.  Masking the word as is spreads
+// the first pixel's red and blue and the second pixel's green;
+// masking it rotated spreads the rest.  Both halves have the same
+// layout as a spread pixel, so they blend with the same src_term,
+// and rotating one back recombines them.
+static ALWAYS_INLINE uint32_t blend_pair(uint32_t dest,
+                                         uint32_t src_term,
+                                         uint32_t inv_alpha)
+{
+    uint32_t lo = blend_spread(dest & SPREAD_MASK, src_term, inv_alpha);
+    uint32_t hi = blend_spread(ror16(dest) & SPREAD_MASK,
+                               src_term, inv_alpha);
+    return lo | ror16(hi);
+}
+
+// a * b / 255
+static ALWAYS_INLINE gfx_alpha8 mul_alpha(uint32_t a, uint32_t b)
+{
+    return a * b * 0x8081 >> 23;
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Dithering
+
+// A blend's result is truncated to 565 after adding a rounding half
+// (SPREAD_HALF) in every field.  Ordered dithering adds a threshold
+// from a Bayer matrix instead, chosen by the pixel's screen position,
+// so the pattern is continuous across tiles.  Each threshold is
+// 0 .. 31, a 565 step in 32nds, in all three fields of a spread word,
+// so one add dithers all three channels.  The 4x4 matrix is repeated
+// to 8x8 so both are indexed the same way.
+
+#define DT(v) ((uint32_t)(v) * 0x00200801)
+#define DITHER_ROW(a, b, c, d, e, f, g, h)                              \
+    { DT(a), DT(b), DT(c), DT(d), DT(e), DT(f), DT(g), DT(h) }
+
+static const uint32_t dither_matrix[2][8][8] = {
+    {
+        DITHER_ROW( 1, 17,  5, 21,  1, 17,  5, 21),
+        DITHER_ROW(25,  9, 29, 13, 25,  9, 29, 13),
+        DITHER_ROW( 7, 23,  3, 19,  7, 23,  3, 19),
+        DITHER_ROW(31, 15, 27, 11, 31, 15, 27, 11),
+        DITHER_ROW( 1, 17,  5, 21,  1, 17,  5, 21),
+        DITHER_ROW(25,  9, 29, 13, 25,  9, 29, 13),
+        DITHER_ROW( 7, 23,  3, 19,  7, 23,  3, 19),
+        DITHER_ROW(31, 15, 27, 11, 31, 15, 27, 11),
+    },
+    {
+        DITHER_ROW( 0, 16,  4, 20,  1, 17,  5, 21),
+        DITHER_ROW(24,  8, 28, 12, 25,  9, 29, 13),
+        DITHER_ROW( 6, 22,  2, 18,  7, 23,  3, 19),
+        DITHER_ROW(30, 14, 26, 10, 31, 15, 27, 11),
+        DITHER_ROW( 1, 17,  5, 21,  0, 16,  4, 20),
+        DITHER_ROW(25,  9, 29, 13, 24,  8, 28, 12),
+        DITHER_ROW( 7, 23,  3, 19,  6, 22,  2, 18),
+        DITHER_ROW(31, 15, 27, 11, 30, 14, 26, 10),
+    },
+};
+
+static gfx_dither dither_mode = GFX_DITHER_NONE;
+
+void gfx_set_dither(gfx_dither mode)
+{
+    dither_mode = mode;
+}
+
+// Thresholds for screen row y, indexed by x & 7, or NULL when not
+// dithering.
+static inline const uint32_t *dither_row(int y)
+{
+    if (dither_mode == GFX_DITHER_NONE)
+        return NULL;
+    return dither_matrix[dither_mode - GFX_DITHER_4X4][y & 7];
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Paint
+
+// Each call converts its color once, into the forms its inner loops
+// use, so no loop unpacks a gfx_rgb888.  Opaque and blended drawing
+// both use the color's 565 pixel, so they agree.  While dithering,
+// they both use the exact color instead.
+
+// The struct is in gfx-paint.h, for the other drawing modules.
+typedef gfx_paint paint;
+
+// The exact color times 5 bit alpha a, in 32nds of a 565 step.  Each
+// field of frac * a holds at most ten bits, so shifting the word
+// leaves each field's whole part where the mask keeps it.
+static ALWAYS_INLINE uint32_t exact_term(const paint *pt, uint32_t a)
+{
+    return pt->whole * a + ((pt->frac * a) >> 5 & SPREAD_MASK);
+}
+
+static ALWAYS_INLINE void init_paint(paint *pt,
+                                     gfx_rgb888 color,
+                                     gfx_alpha8 alpha)
+{
+    uint32_t a = alpha5(alpha);
+    pt->pixel     = gfx_rgb888_to_rgb565(color);
+    pt->alpha     = alpha;
+    pt->spread    = spread_rgb565(pt->pixel);
+    pt->src_term  = pt->spread * a + SPREAD_HALF;
+    pt->inv_alpha = 32 - a;
+    pt->dither    = NULL;
+    pt->whole     = 0;
+    pt->frac      = 0;
+    pt->dither_term = 0;
+    pt->dithers   = false;
+    if (dither_mode != GFX_DITHER_NONE) {
+        uint32_t r = ((color >> 16 & 0xFF) * 31 * 32 + 127) / 255;
+        uint32_t g = ((color >>  8 & 0xFF) * 63 * 32 + 127) / 255;
+        uint32_t b = ((color       & 0xFF) * 31 * 32 + 127) / 255;
+        uint32_t exact = g << 21 | r << 11 | b;
+        pt->dither = dither_matrix[dither_mode - GFX_DITHER_4X4];
+        pt->whole = exact >> 5 & SPREAD_MASK;
+        pt->frac = exact - (pt->whole << 5);
+        pt->dither_term = exact_term(pt, a);
+        pt->dithers = (pt->dither_term & ~(SPREAD_MASK << 5)) != 0;
+    }
+}
+
+// Blend one pixel at screen position (x, y) toward the paint's color
+// with its own alpha.  With alpha 0xFF, this is the opaque pixel,
+// dithered.
+static ALWAYS_INLINE gfx_rgb565 blend_paint(gfx_rgb565 dest,
+                                            const paint *pt,
+                                            int x, int y)
+{
+    uint32_t src_term = pt->src_term;
+    if (pt->dither)
+        src_term = pt->dither_term + pt->dither[y & 7][x & 7];
+    return unspread(blend_spread(spread_rgb565(dest),
+                                 src_term, pt->inv_alpha));
+}
+
+// Dithered blends are kept out of line, so the usual blend stays
+// small in the loops it's inlined into.
+static NEVER_INLINE gfx_rgb565 blend_pixel_dither(gfx_rgb565 dest,
+                                                  const paint *pt,
+                                                  uint32_t a,
+                                                  int x, int y)
+{
+    uint32_t src_term = exact_term(pt, a) + pt->dither[y & 7][x & 7];
+    return unspread(blend_spread(spread_rgb565(dest), src_term, 32 - a));
+}
+
+// Blend one pixel toward the paint's color with another alpha, e.g.,
+// coverage.
+static ALWAYS_INLINE gfx_rgb565 blend_pixel(gfx_rgb565 dest,
+                                            const paint *pt,
+                                            gfx_alpha8 alpha,
+                                            int x, int y)
+{
+    uint32_t a = alpha5(alpha);
+    if (pt->dither)
+        return blend_pixel_dither(dest, pt, a, x, y);
+    return unspread(blend_spread(spread_rgb565(dest),
+                                 pt->spread * a + SPREAD_HALF,
+                                 32 - a));
+}
+
+// Two adjacent pixels, stored as one word.  may_alias because the
+// pixels are also accessed as gfx_rgb565.
+typedef uint32_t __attribute__((may_alias)) pixel_pair;
+
+// Fill a run of pixels.  Store one pixel to reach a word boundary,
+// then two pixels per word in bursts of 32 bytes, then the tail.
+static void fill_run(gfx_rgb565 *p, size_t count, gfx_rgb565 c)
+{
+    if (count && ((uintptr_t)p & 2)) {
+        *p++ = c;
+        --count;
+    }
+    uint32_t cc = (uint32_t)c * 0x00010001u;
+    pixel_pair *q = (pixel_pair *)p;
+    for ( ; count >= 16; count -= 16, q += 8) {
+        q[0] = cc; q[1] = cc; q[2] = cc; q[3] = cc;
+        q[4] = cc; q[5] = cc; q[6] = cc; q[7] = cc;
+    }
+    if (count & 8) {
+        q[0] = cc; q[1] = cc; q[2] = cc; q[3] = cc;
+        q += 4;
+    }
+    if (count & 4) {
+        q[0] = cc; q[1] = cc;
+        q += 2;
+    }
+    if (count & 2)
+        *q++ = cc;
+    if (count & 1)
+        *(gfx_rgb565 *)q = c;
+}
+
+// Fill a w by h block of pixels whose rows are stride pixels apart.
+// Rows that abut are filled as one run; a one pixel wide block is a
+// column, stored four pixels per iteration.
+static void fill_block(gfx_rgb565 *p,
+                       size_t w, size_t h,
+                       ssize_t stride,
+                       gfx_rgb565 c)
+{
+    if ((ssize_t)w == stride) {
+        fill_run(p, w * h, c);
+    } else if (w == 1) {
+        for ( ; h >= 4; h -= 4, p += 4 * stride) {
+            p[0 * stride] = c;
+            p[1 * stride] = c;
+            p[2 * stride] = c;
+            p[3 * stride] = c;
+        }
+        for ( ; h; --h, p += stride)
+            *p = c;
+    } else {
+        for ( ; h; --h, p += stride)
+            fill_run(p, w, c);
+    }
+}
+
+// Blend a run of pixels, two per word.
+static void blend_run(gfx_rgb565 *p, size_t count,
+                      uint32_t src_term, uint32_t inv_alpha)
+{
+    if (count && ((uintptr_t)p & 2)) {
+        *p = unspread(blend_spread(spread_rgb565(*p), src_term, inv_alpha));
+        p++;
+        --count;
+    }
+    pixel_pair *q = (pixel_pair *)p;
+    for ( ; count >= 2; count -= 2, q++)
+        *q = blend_pair(*q, src_term, inv_alpha);
+    if (count) {
+        p = (gfx_rgb565 *)q;
+        *p = unspread(blend_spread(spread_rgb565(*p), src_term, inv_alpha));
+    }
+}
+
+// Dithered runs start at screen column x, and row holds the
+// thresholds for their screen row.  An opaque run repeats a pattern
+// of eight pixels.  term is the color times alpha, exact to a 32nd of
+// a 565 step.
+static NEVER_INLINE void fill_run_dither(gfx_rgb565 *p, size_t count,
+                                         int x, const uint32_t *row,
+                                         uint32_t term)
+{
+    gfx_rgb565 pattern[8];
+    for (int i = 0; i < 8; i++)
+        pattern[i] = unspread((term + row[i]) >> 5 & SPREAD_MASK);
+    for (size_t i = 0; i < count; i++, x++)
+        p[i] = pattern[x & 7];
+}
+
+static NEVER_INLINE void blend_run_dither(gfx_rgb565 *p, size_t count,
+                                          int x, const uint32_t *row,
+                                          uint32_t term,
+                                          uint32_t inv_alpha)
+{
+    uint32_t terms[8];
+    for (int i = 0; i < 8; i++)
+        terms[i] = term + row[i];
+    for (size_t i = 0; i < count; i++, x++)
+        p[i] = unspread(blend_spread(spread_rgb565(p[i]),
+                                     terms[x & 7],
+                                     inv_alpha));
+}
+
+// Fill or blend a run of row y from column x with the paint's own
+// alpha, dithered if dithering is on.  Opaque runs need dithering
+// only when the color is between 565 pixels.
+static ALWAYS_INLINE void paint_run(gfx_rgb565 *p, size_t count,
+                                    int x, int y,
+                                    const paint *pt,
+                                    variant_flags flags)
+{
+    if ((flags & VF_BLEND) && pt->alpha != 0xFF) {
+        if (pt->dither)
+            blend_run_dither(p, count, x, pt->dither[y & 7],
+                             pt->dither_term, pt->inv_alpha);
+        else
+            blend_run(p, count, pt->src_term, pt->inv_alpha);
+    } else {
+        if (pt->dithers)
+            fill_run_dither(p, count, x, pt->dither[y & 7],
+                            pt->dither_term);
+        else
+            fill_run(p, count, pt->pixel);
+    }
+}
+
+// Fill or blend a run with alpha, which need not be the paint's, e.g.,
+// coverage.
+static ALWAYS_INLINE void fill_or_blend_run(gfx_rgb565 *p, size_t count,
+                                            int x, int y,
+                                            const paint *pt,
+                                            gfx_alpha8 alpha)
+{
+    if (alpha == pt->alpha) {
+        if (alpha)
+            paint_run(p, count, x, y, pt, VF_BLEND);
+    } else if (alpha) {
+        uint32_t a = alpha5(alpha);
+        if (pt->dither)
+            blend_run_dither(p, count, x, pt->dither[y & 7],
+                             exact_term(pt, a), 32 - a);
+        else if (alpha == 0xFF)
+            fill_run(p, count, pt->pixel);
+        else
+            blend_run(p, count, pt->spread * a + SPREAD_HALF, 32 - a);
+    }
+}
+
+void gfx_init_paint(gfx_paint *pt, gfx_rgb888 color, gfx_alpha8 alpha)
+{
+    init_paint(pt, color, alpha);
+}
+
+void gfx_paint_run(gfx_rgb565 *p, size_t count,
+                   int x, int y,
+                   const gfx_paint *pt,
+                   gfx_alpha8 alpha)
+{
+    fill_or_blend_run(p, count, x, y, pt, alpha);
+}
+
+void gfx_paint_pixel(gfx_rgb565 *p,
+                     int x, int y,
+                     const gfx_paint *pt,
+                     gfx_alpha8 alpha)
+{
+    if (alpha == 0xFF && !pt->dither)
+        *p = pt->pixel;
+    else if (alpha)
+        *p = blend_pixel(*p, pt, alpha, x, y);
+}
 
-static gfx_rgb565 blend_pixel(gfx_rgb565 dest, gfx_rgb888 src, gfx_alpha8 alpha)
+void gfx_store_run(gfx_rgb565 *p, size_t count, gfx_rgb565 c)
 {
-    uint32_t dr5 = dest >> 11 & 0x1f;
-    uint32_t dg5 = dest >>  5 & 0x3f;
-    uint32_t db5 = dest >>  0 & 0x1f;
-    uint32_t dr8 = dr5 << 3 | dr5 >> 2;
-    uint32_t dg8 = dg5 << 2 | dg5 >> 4;
-    uint32_t db8 = db5 << 3 | db5 >> 2;
-    uint32_t sr8 = src >> 16 & 0xFF;
-    uint32_t sg8 = src >>  8 & 0xFF;
-    uint32_t sb8 = src >>  0 & 0xFF;
-    dr8 += (sr8 - dr8) * (alpha * 0x8081) >> 23; // divide by 255
-    dg8 += (sg8 - dg8) * (alpha * 0x8081) >> 23;
-    db8 += (sb8 - db8) * (alpha * 0x8081) >> 23;
-    return (dr8 << 8 & 0xf800) | (dg8 << 3 & 0x07e0) | (db8 >> 3 & 0x001f);
+    fill_run(p, count, c);
 }
 
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Pixels
+
 void gfx_fill_pixel(gfx_pixtile *tile,
                     int x, int y,
                     gfx_rgb888 color)
 {
     gfx_rgb565 *p = gfx_pixel_address(tile, x, y);
     if (p)
-        *p = color;
+        *p = gfx_rgb888_to_rgb565(color);
 }
 
 void gfx_fill_pixel_blend(gfx_pixtile *tile,
@@ -44,10 +468,9 @@ void gfx_fill_pixel_blend(gfx_pixtile *tile,
         return;
     gfx_rgb565 *p = gfx_pixel_address(tile, x, y);
     if (p) {
-        if (alpha == 0xFF)
-            *p = color;
-        else
-            *p = blend_pixel(*p, color, alpha);
+        paint pt;
+        init_paint(&pt, color, alpha);
+        *p = blend_paint(*p, &pt, x, y);
     }
 }
 
@@ -56,7 +479,7 @@ void gfx_fill_pixel_unclipped(gfx_pixtile *tile,
                               gfx_rgb888 color)
 {
     gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, x, y);
-    *p = color;
+    *p = gfx_rgb888_to_rgb565(color);
 }
 
 void gfx_fill_pixel_blend_unclipped(gfx_pixtile *tile,
@@ -65,11 +488,205 @@ void gfx_fill_pixel_blend_unclipped(gfx_pixtile *tile,
                                     gfx_alpha8 alpha)
 {
     gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, x, y);
-    *p = blend_pixel(*p, color, alpha);
+    paint pt;
+    init_paint(&pt, color, alpha);
+    *p = blend_paint(*p, &pt, x, y);
 }
 
 // --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
-// Pixels
+// Gradients
+
+// Gradients are evaluated along a span with t in 0.16 fixed point.
+// A linear gradient's t steps by a constant.  A radial gradient steps
+// the squared distance s by second differences, in 4.28 fixed point,
+// and looks up t = sqrt(s) in sqrt_table, interpolating between
+// entries.  Only the part of a span inside the circle is stepped;
+// the rest is the last color, filled as runs.
+
+// sqrt(i / 256) in 0.16 fixed point.
+static const uint16_t sqrt_table[257] = {
+        0,  4096,  5793,  7094,  8192,  9159, 10033, 10837,
+    11585, 12288, 12953, 13585, 14189, 14768, 15326, 15864,
+    16384, 16888, 17378, 17854, 18318, 18770, 19212, 19644,
+    20066, 20480, 20886, 21283, 21674, 22058, 22435, 22806,
+    23170, 23530, 23884, 24232, 24576, 24915, 25249, 25580,
+    25905, 26227, 26545, 26859, 27170, 27477, 27780, 28081,
+    28378, 28672, 28963, 29251, 29537, 29819, 30099, 30377,
+    30652, 30924, 31194, 31462, 31727, 31991, 32252, 32511,
+    32768, 33023, 33276, 33527, 33776, 34024, 34270, 34514,
+    34756, 34996, 35235, 35472, 35708, 35942, 36175, 36406,
+    36636, 36864, 37091, 37316, 37540, 37763, 37985, 38205,
+    38424, 38642, 38858, 39073, 39287, 39500, 39712, 39923,
+    40132, 40341, 40548, 40755, 40960, 41164, 41368, 41570,
+    41771, 41972, 42171, 42369, 42567, 42763, 42959, 43154,
+    43348, 43541, 43733, 43925, 44115, 44305, 44494, 44682,
+    44869, 45056, 45242, 45427, 45611, 45795, 45977, 46160,
+    46341, 46522, 46702, 46881, 47059, 47237, 47415, 47591,
+    47767, 47942, 48117, 48291, 48465, 48637, 48809, 48981,
+    49152, 49322, 49492, 49661, 49830, 49998, 50166, 50332,
+    50499, 50665, 50830, 50995, 51159, 51323, 51486, 51649,
+    51811, 51972, 52134, 52294, 52454, 52614, 52773, 52932,
+    53090, 53248, 53405, 53562, 53719, 53874, 54030, 54185,
+    54340, 54494, 54647, 54801, 54954, 55106, 55258, 55410,
+    55561, 55712, 55862, 56012, 56162, 56311, 56459, 56608,
+    56756, 56903, 57051, 57198, 57344, 57490, 57636, 57781,
+    57926, 58071, 58215, 58359, 58503, 58646, 58789, 58931,
+    59073, 59215, 59357, 59498, 59639, 59779, 59919, 60059,
+    60199, 60338, 60477, 60615, 60753, 60891, 61029, 61166,
+    61303, 61440, 61576, 61712, 61848, 61984, 62119, 62254,
+    62388, 62523, 62657, 62790, 62924, 63057, 63190, 63323,
+    63455, 63587, 63719, 63850, 63982, 64113, 64243, 64374,
+    64504, 64634, 64763, 64893, 65022, 65151, 65279, 65408,
+    65535,
+};
+
+// A gradient, for one call.
+typedef struct gradient_paint {
+    const gfx_gradient *g;
+} gradient_paint;
+
+static void init_gradient_paint(gradient_paint *gp, const gfx_gradient *g)
+{
+    gp->g = g;
+}
+
+// Each channel is interpolated between the stops in 32nds of a 565
+// step, with 8 bits of fraction, then packed with room for the 32nds
+// below each field of a spread word, so one add rounds or dithers all
+// three.  thr is SPREAD_HALF, or a dither threshold.  Dithering needs
+// the interpolation's fraction, so it ignores the ramp.
+static ALWAYS_INLINE gfx_rgb565 gradient_color(const gradient_paint *gp,
+                                               uint32_t t,
+                                               bool ramp,
+                                               uint32_t thr)
+{
+    const gfx_gradient *g = gp->g;
+    if (ramp)
+        return g->ramp[t >> 8];
+    size_t k = 0;
+    while (t >= g->stop_t[k + 1] && k + 2 < g->stop_count)
+        k++;
+    int32_t f = MIN((t - g->stop_t[k]) * g->stop_scale[k] >> 16, 256u);
+    const uint16_t *c0 = g->stop_rgb[k], *c1 = g->stop_rgb[k + 1];
+    uint32_t r = c0[0] + ((c1[0] - c0[0]) * f >> 8);
+    uint32_t gr = c0[1] + ((c1[1] - c0[1]) * f >> 8);
+    uint32_t b = c0[2] + ((c1[2] - c0[2]) * f >> 8);
+    uint32_t exact = gr << 21 | r << 11 | b;
+    return unspread((exact + thr) >> 5 & SPREAD_MASK);
+}
+
+// row is the dither thresholds for row y, or NULL.
+static ALWAYS_INLINE void linear_span(gfx_rgb565 *p, size_t count,
+                                      int x, int y,
+                                      const gradient_paint *gp,
+                                      bool ramp,
+                                      const uint32_t *row)
+{
+    const gfx_gradient *g = gp->g;
+
+    // t is stepped from the row's column 0 by a rounded step, so a
+    // pixel gets the same t whichever tile it is drawn in.
+    float t = (0.5f - g->x0) * g->tx + (y + 0.5f - g->y0) * g->ty;
+    int32_t dt = FLOOR(g->tx * 0x10000 + 0.5f);
+    int32_t ti = CLAMP(-0x4000, 0x4000, t) * 0x10000;
+    ti += x * dt;
+
+    // Across a span, a vertical gradient is one color, or one
+    // repeating row of the dither pattern.
+    if (dt == 0) {
+        uint32_t tc = CLAMP(0, 0xFFFF, ti);
+        if (!row) {
+            fill_run(p, count, gradient_color(gp, tc, ramp, SPREAD_HALF));
+            return;
+        }
+        gfx_rgb565 pattern[8];
+        for (int i = 0; i < 8; i++)
+            pattern[i] = gradient_color(gp, tc, false, row[i]);
+        for (size_t i = 0; i < count; i++, x++)
+            p[i] = pattern[x & 7];
+        return;
+    }
+    for ( ; count; --count, ti += dt, x++) {
+        uint32_t thr = row ? row[x & 7] : SPREAD_HALF;
+        *p++ = gradient_color(gp, CLAMP(0, 0xFFFF, ti), ramp, thr);
+    }
+}
+
+static ALWAYS_INLINE void radial_span(gfx_rgb565 *p, size_t count,
+                                      int x, int y,
+                                      const gradient_paint *gp,
+                                      bool ramp,
+                                      const uint32_t *row)
+{
+    const gfx_gradient *g = gp->g;
+    gfx_rgb565 outer = gradient_color(gp, 0xFFFF, ramp, SPREAD_HALF);
+    int x1 = x + count;
+
+    // Pixel centers inside the circle.
+    float dy = y + 0.5f - g->y0;
+    float h2 = g->r2 - dy * dy;
+    int cx0 = x1, ix0 = x1, ix1 = x1;
+    if (h2 > 0) {
+        float half = sqrtf(h2);
+        cx0 = CEIL(g->x0 - half - 0.5f);
+        ix0 = CLAMP(x, x1, cx0);
+        ix1 = CLAMP(ix0, x1, CEIL(g->x0 + half - 0.5f));
+    }
+
+    fill_run(p, ix0 - x, outer);
+    p += ix0 - x;
+    if (ix0 < ix1) {
+        // s is stepped from the row's first pixel inside the circle,
+        // then advanced to ix0 exactly, so a pixel gets the same s
+        // whichever tile it is drawn in.
+        float k = g->r2_inv * (1 << 28);
+        float dx = cx0 + 0.5f - g->x0;
+        int32_t s = (dx * dx + dy * dy) * k;
+        int32_t ds = (2 * dx + 1) * k;
+        int32_t dds = 2 * k;
+        int64_t n = ix0 - cx0;
+        s += n * ds + n * (n - 1) / 2 * dds;
+        ds += n * dds;
+        for (int i = ix0; i < ix1; i++, s += ds, ds += dds) {
+            uint32_t sc = CLAMP(0, (1 << 28) - 1, s);
+            uint32_t j = sc >> 20, frac = sc >> 12 & 0xFF;
+            uint32_t t = sqrt_table[j] +
+                ((sqrt_table[j + 1] - sqrt_table[j]) * frac >> 8);
+            uint32_t thr = row ? row[i & 7] : SPREAD_HALF;
+            *p++ = gradient_color(gp, t, ramp, thr);
+        }
+    }
+    fill_run(p, x1 - ix1, outer);
+}
+
+// Paint pixels [x0, x1) of row y, which are in the tile.
+static void gradient_span(gfx_pixtile *tile,
+                          int x0, int x1, int y,
+                          const gradient_paint *gp)
+{
+    gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, x0, y);
+    size_t count = x1 - x0;
+    const uint32_t *row = dither_row(y);
+    bool ramp = gp->g->ramp != NULL;
+    if (gp->g->radial) {
+        if (row)
+            radial_span(p, count, x0, y, gp, false, row);
+        else if (ramp)
+            radial_span(p, count, x0, y, gp, true, NULL);
+        else
+            radial_span(p, count, x0, y, gp, false, NULL);
+    } else {
+        if (row)
+            linear_span(p, count, x0, y, gp, false, row);
+        else if (ramp)
+            linear_span(p, count, x0, y, gp, true, NULL);
+        else
+            linear_span(p, count, x0, y, gp, false, NULL);
+    }
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Spans
 
 static gfx_rgb565 *span_clip(gfx_pixtile *tile,
                              int x0, int x1, int y,
@@ -95,9 +712,11 @@ void gfx_fill_span(gfx_pixtile *tile,
         return;
     size_t count;
     gfx_rgb565 *p = span_clip(tile, x0, x1, y, &count);
-    if (p)
-        for (size_t i = 0; i < count; i++)
-            *p++ = color;
+    if (p) {
+        paint pt;
+        init_paint(&pt, color, 0xFF);
+        paint_run(p, count, MAX(x0, tile->x), y, &pt, 0);
+    }
 }
 
 void gfx_fill_span_blend(gfx_pixtile *tile,
@@ -111,16 +730,10 @@ void gfx_fill_span_blend(gfx_pixtile *tile,
         return;
     size_t count;
     gfx_rgb565 *p = span_clip(tile, x0, x1, y, &count);
-    if (!p)
-        return;
-    if (alpha == 0xFF) {
-        for (size_t i = 0; i < count; i++)
-            *p++ = color;
-    } else {
-        for (size_t i = 0; i < count; i++) {
-            *p = blend_pixel(*p, color, alpha);
-            p++;
-        }
+    if (p) {
+        paint pt;
+        init_paint(&pt, color, alpha);
+        paint_run(p, count, MAX(x0, tile->x), y, &pt, VF_BLEND);
     }
 }
 
@@ -128,9 +741,12 @@ void gfx_fill_span_unclipped(gfx_pixtile *tile,
                              int x0, int x1, int y,
                              gfx_rgb888 color)
 {
-    gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, x0, y);
-    for (int i = x0; i < x1; i++)
-        *p++ = color;
+    if (x0 < x1) {
+        paint pt;
+        init_paint(&pt, color, 0xFF);
+        paint_run(gfx_pixel_address_unchecked(tile, x0, y), x1 - x0,
+                  x0, y, &pt, 0);
+    }
 }
 
 void gfx_fill_span_blend_unclipped(gfx_pixtile *tile,
@@ -138,110 +754,318 @@ void gfx_fill_span_blend_unclipped(gfx_pixtile *tile,
                                    gfx_rgb888 color,
                                    gfx_alpha8 alpha)
 {
-    gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, x0, y);
-    for (int i = x0; i < x1; i++) {
-        *p = blend_pixel(*p, color, alpha);
-        p++;
+    if (x0 < x1) {
+        paint pt;
+        init_paint(&pt, color, alpha);
+        paint_run(gfx_pixel_address_unchecked(tile, x0, y), x1 - x0,
+                  x0, y, &pt, VF_BLEND);
     }
 }
 
+void gfx_fill_span_gradient(gfx_pixtile *tile,
+                            int x0, int x1, int y,
+                            const gfx_gradient *gradient)
+{
+    if (y < tile->y || y >= (ssize_t)(tile->y + tile->h))
+        return;
+    x0 = MAX(x0, tile->x);
+    x1 = MIN(x1, tile->x + (int)tile->w);
+    if (x0 >= x1)
+        return;
+    gradient_paint gp;
+    init_gradient_paint(&gp, gradient);
+    gradient_span(tile, x0, x1, y, &gp);
+}
+
 // --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
 // Lines
 
+// Lines are rasterized in major/minor axis coordinates: i runs along
+// the major axis, one pixel per step, and j along the minor axis.
+// Steep lines have y as the major axis.
 
-// Bresenham, jaggy.
-void gfx_draw_line(gfx_pixtile *tile,
-                   float x0, float y0,
-                   float x1, float y1,
-                   gfx_rgb888 color)
+static ALWAYS_INLINE gfx_rgb565 *line_pixel_address(gfx_pixtile *tile,
+                                                    bool steep,
+                                                    int i, int j)
 {
-    int min_x = tile->x;
-    int max_x = min_x + tile->w;
-    int min_y = tile->y;
-    int max_y = min_y + tile->h;
+    if (steep)
+        return gfx_pixel_address_unchecked(tile, j, i);
+    else
+        return gfx_pixel_address_unchecked(tile, i, j);
+}
 
-    if (y0 == y1) {
+// Plot the pixel at p, at screen position (x, y).
+static ALWAYS_INLINE void plot(gfx_rgb565 *p,
+                               int x, int y,
+                               const paint *pt,
+                               variant_flags flags)
+{
+    if ((flags & VF_BLEND) || pt->dithers)
+        *p = blend_paint(*p, pt, x, y);
+    else
+        *p = pt->pixel;
+}
 
-        // Horizontal
+// The same, in major/minor axis coordinates.
+static ALWAYS_INLINE void plot_line(gfx_rgb565 *p,
+                                    bool steep,
+                                    int i, int j,
+                                    const paint *pt,
+                                    variant_flags flags)
+{
+    plot(p, steep ? j : i, steep ? i : j, pt, flags);
+}
 
-        gfx_fill_span(tile, (int)x0, (int)x1, (int)y0, color);
+// Combine antialiasing coverage with the blend alpha.
+static ALWAYS_INLINE gfx_alpha8 line_alpha(int coverage,
+                                           gfx_alpha8 alpha,
+                                           variant_flags flags)
+{
+    if (flags & VF_BLEND)
+        return mul_alpha(coverage, alpha);
+    return coverage;
+}
 
-    } else if (x0 == x1) {
+// Liang-Barsky.  Clip the segment from (x0, y0) to (x0 + dx, y0 + dy)
+// to the rectangle [min_x, max_x] x [min_y, max_y].  On entry, *t0
+// and *t1 are the parameter range; on exit, they're narrowed to the
+// part inside the rectangle.  Returns false if no part is inside.
+static bool clip_line(float x0, float y0,
+                      float dx, float dy,
+                      float min_x, float min_y,
+                      float max_x, float max_y,
+                      float *t0, float *t1)
+{
+    const float p[4] = { -dx, +dx, -dy, +dy };
+    const float q[4] = { x0 - min_x, max_x - x0, y0 - min_y, max_y - y0 };
+    for (size_t k = 0; k < 4; k++) {
+        if (p[k] == 0) {
+            if (q[k] < 0)
+                return false;   // parallel and outside
+        } else {
+            float r = q[k] / p[k];
+            if (p[k] < 0) {
+                if (r > *t1)
+                    return false;
+                if (r > *t0)
+                    *t0 = r;
+            } else {
+                if (r < *t0)
+                    return false;
+                if (r < *t1)
+                    *t1 = r;
+            }
+        }
+    }
+    return true;
+}
 
-        // Vertical
+// Bounds of the tile in major/minor axis coordinates.
+typedef struct line_bounds {
+    int min_i, max_i;
+    int min_j, max_j;
+} line_bounds;
 
-        int x = (int)x0;
-        if (min_x <= x && x < max_x) {
-            int first_y = MAX(min_y,     (int)MIN(y0, y1));
-            int last_y  = MIN(max_y - 1, (int)MAX(y0, y1));
-            for (int y = first_y; y <= last_y; y++)
-                *gfx_pixel_address_unchecked(tile, x, y) = color;
-        }
+static ALWAYS_INLINE line_bounds tile_line_bounds(const gfx_pixtile *tile,
+                                                  bool steep)
+{
+    int min_x = tile->x, max_x = min_x + tile->w;
+    int min_y = tile->y, max_y = min_y + tile->h;
+    if (steep)
+        return (line_bounds) { min_y, max_y, min_x, max_x };
+    else
+        return (line_bounds) { min_x, max_x, min_y, max_y };
+}
 
-    } else if (ABS(x1 - x0) >= ABS(y1 - y0)) {
+// Clip the major axis pixel range [*i0, *i1] of the line from (x0, y0)
+// with slope dy/dx to the part whose minor axis coordinate, padded by
+// pad_j pixels, is inside the bounds.  The result is conservative by
+// a pixel at either end; callers check the minor axis there.
+static ALWAYS_INLINE bool clip_line_range(const line_bounds *b,
+                                          float x0, float y0,
+                                          float dx, float dy,
+                                          int pad_j,
+                                          int *i0, int *i1)
+{
+    // Trivially accept lines well inside the bounds.  (x0 <= x1.)
+    float y1 = y0 + dy;
+    if (b->min_i + 1 <= x0 && x0 + dx < b->max_i - 1 &&
+        b->min_j + 1 <= MIN(y0, y1) && MAX(y0, y1) < b->max_j - 1)
+        return *i0 <= *i1;
 
-        // Horizontalish
+    float t0 = 0, t1 = 1;
+    if (!clip_line(x0, y0, dx, dy,
+                   b->min_i, b->min_j - pad_j,
+                   b->max_i, b->max_j,
+                   &t0, &t1))
+        return false;
+    *i0 = MAX(*i0, MAX(b->min_i,     FLOOR(x0 + t0 * dx) - 1));
+    *i1 = MIN(*i1, MIN(b->max_i - 1, FLOOR(x0 + t1 * dx) + 1));
+    return *i0 <= *i1;
+}
 
-        if (x1 < x0) {
-            float xt = x0; x0 = x1; x1 = xt;
-            float yt = y0; y0 = y1; y1 = yt;
-        }
-        float dx = x1 - x0;
-        float dy = ABS(y1 - y0);
-        float d = 2 * dy - dx;
-        d -= FRAC(x0) * dy;
-        d += FRAC(y0) * dx;
-        float y = y0;
-        float y_inc = (y1 > y0) ? +1.0f : -1.0f;
-        for (int ix = FLOOR(x0); ix <= FLOOR(x1); ix++) {
-            int iy = FLOOR(y);
-            gfx_rgb565 *p = gfx_pixel_address(tile, ix, iy);
-            if (p)
-                *p = color;
-            if (d >= 0) {
-                y += y_inc;
-                d -= dx;
-            }
-            d += dy;
-        }
+static ALWAYS_INLINE void draw_line(gfx_pixtile *tile,
+                                    float x0, float y0,
+                                    float x1, float y1,
+                                    gfx_rgb888 color,
+                                    gfx_alpha8 alpha,
+                                    variant_flags flags)
+{
+    if ((flags & VF_BLEND) && alpha == 0)
+        return;
+    paint pt;
+    init_paint(&pt, color, alpha);
 
-    } else {
+    bool steep = ABS(y1 - y0) > ABS(x1 - x0);
+    if (steep) {
+        float t0 = x0; x0 = y0; y0 = t0;
+        float t1 = x1; x1 = y1; y1 = t1;
+    }
+    if (x1 < x0) {
+        float xt = x0; x0 = x1; x1 = xt;
+        float yt = y0; y0 = y1; y1 = yt;
+    }
+    float dx = x1 - x0;
+    float dy = y1 - y0;
+    float slope = dx ? dy / dx : 0;
+    int i0 = FLOOR(x0);
+    int i1 = FLOOR(x1);
+    line_bounds b = tile_line_bounds(tile, steep);
+
+    if (dy == 0) {
 
-        // Verticalish
+        // Axis aligned: a span or a column.
 
-        if (y1 < y0) {
-            float xt = x0; x0 = x1; x1 = xt;
-            float yt = y0; y0 = y1; y1 = yt;
+        int j = FLOOR(y0);
+        if (!(flags & VF_UNCLIPPED)) {
+            if (j < b.min_j || j >= b.max_j)
+                return;
+            i0 = MAX(i0, b.min_i);
+            i1 = MIN(i1, b.max_i - 1);
         }
-        float dy = y1 - y0;
-        float dx = ABS(x1 - x0);
-        float d = 2 * dx - dy;
-        d -= FRAC(y0) * dx;
-        d += FRAC(x0) * dy;
-        float x = x0;
-        float x_inc = (x1 > x0) ? +1.0f : -1.0f;
-        for (int iy = FLOOR(y0); iy <= FLOOR(y1); iy++) {
-            int ix = FLOOR(x);
-            gfx_rgb565 *p = gfx_pixel_address(tile, ix, iy);
-            if (p)
-                *p = color;
-            if (d >= 0) {
-                x += x_inc;
-                d -= dy;
-            }
-            d += dx;
-        }            
+        if (i0 > i1)
+            return;
+        gfx_rgb565 *p = line_pixel_address(tile, steep, i0, j);
+        if (!steep) {
+            paint_run(p, i1 - i0 + 1, i0, j, &pt, flags);
+        } else if ((flags & VF_BLEND) || pt.dithers) {
+            for (int i = i0; i <= i1; i++, p += tile->stride)
+                plot(p, j, i, &pt, flags);
+        } else {
+            fill_block(p, 1, i1 - i0 + 1, tile->stride, pt.pixel);
+        }
+        return;
+    }
+
+    // Sample the line at each pixel center along the major axis.
+    // j_at(i) = FLOOR(y_first + (i - i_first) * slope).  y_first is
+    // the only rounded value, so clipping can jump ahead exactly.
+    int i_first = i0;
+    fix16 y_first = float_to_fix16(y0 + (i_first + 0.5f - x0) * slope);
+    fix16 dydi = float_to_fix16(slope);
+    if (!(flags & VF_UNCLIPPED)) {
+        if (!clip_line_range(&b, x0, y0, dx, dy, 0, &i0, &i1))
+            return;
+        // Pixel center sampling can step one pixel outside the
+        // clipped segment at either end, so trim those.
+        while (i0 <= i1) {
+            int j = fix16_floor(y_first + (i0 - i_first) * dydi);
+            if (b.min_j <= j && j < b.max_j)
+                break;
+            i0++;
+        }
+        while (i0 <= i1) {
+            int j = fix16_floor(y_first + (i1 - i_first) * dydi);
+            if (b.min_j <= j && j < b.max_j)
+                break;
+            --i1;
+        }
+        if (i0 > i1)
+            return;
+    }
+
+    // Step the pixel pointer along the major axis, and along the
+    // minor axis when y crosses a pixel boundary.
+    ssize_t major_step = steep ? tile->stride : 1;
+    ssize_t minor_step = steep ? 1 : tile->stride;
+    fix16 y = y_first + (i0 - i_first) * dydi;
+    int j = fix16_floor(y);
+    gfx_rgb565 *p = line_pixel_address(tile, steep, i0, j);
+    for (int i = i0; ; i++) {
+        plot_line(p, steep, i, j, &pt, flags);
+        if (i == i1)
+            break;
+        y += dydi;
+        int next_j = fix16_floor(y);
+        p += major_step + (next_j - j) * minor_step;
+        j = next_j;
     }
 }
 
-// Line, anti-aliased using Xiaolin Wu's algorithm
-void gfx_draw_line_aa(gfx_pixtile *tile,
-                      float x0, float y0,
-                      float x1, float y1,
-                      gfx_rgb888 color)
+// Blend the pixel at major/minor axis coordinates (i, j).
+static ALWAYS_INLINE gfx_rgb565 blend_line_pixel(gfx_rgb565 dest,
+                                                 bool steep,
+                                                 int i, int j,
+                                                 const paint *pt,
+                                                 gfx_alpha8 alpha)
+{
+    return blend_pixel(dest, pt, alpha, steep ? j : i, steep ? i : j);
+}
+
+// Plot a pixel of an antialiased line's endpoint.  There are only
+// four per line, so check bounds here instead of clipping.
+static ALWAYS_INLINE void plot_line_end_aa(gfx_pixtile *tile,
+                                           bool steep,
+                                           int i, int j,
+                                           const paint *pt,
+                                           int coverage,
+                                           variant_flags flags)
+{
+    gfx_rgb565 *p;
+    if (flags & VF_UNCLIPPED)
+        p = line_pixel_address(tile, steep, i, j);
+    else if (steep)
+        p = gfx_pixel_address(tile, j, i);
+    else
+        p = gfx_pixel_address(tile, i, j);
+    if (p)
+        *p = blend_line_pixel(*p, steep, i, j, pt,
+                              line_alpha(coverage, pt->alpha, flags));
+}
+
+// Coverage of the two pixels an endpoint straddles.  xgap is how
+// much of the endpoint's pixel the line covers along the major axis.
+static ALWAYS_INLINE void plot_line_ends_aa(gfx_pixtile *tile,
+                                            bool steep,
+                                            int i, fix16 y, fix16 xgap,
+                                            const paint *pt,
+                                            variant_flags flags)
+{
+    int j = fix16_floor(y);
+    uint32_t fy = (y & 0xFFFF) >> 8;            // 0 .. 255
+    uint32_t gap = xgap >> 8;                   // 0 .. 256
+    plot_line_end_aa(tile, steep, i, j,
+                     pt, (255 - fy) * gap >> 8, flags);
+    plot_line_end_aa(tile, steep, i, j + 1,
+                     pt, fy * gap >> 8, flags);
+}
+
+// Line, anti-aliased using Xiaolin Wu's algorithm, in 16.16 fixed
+// point.  Endpoints keep their subpixel positions; the main loop
+// steps y by the gradient and uses its fraction as coverage.
+static ALWAYS_INLINE void draw_line_aa(gfx_pixtile *tile,
+                                       float x0, float y0,
+                                       float x1, float y1,
+                                       gfx_rgb888 color,
+                                       gfx_alpha8 alpha,
+                                       variant_flags flags)
 {
-    // Cribbed directly from en.wikipedia.org/wiki/Xiaolin_Wu%27s_line_algorithm
-    // XXX Could be optimized by clipping earlier.
+    // Derived from en.wikipedia.org/wiki/Xiaolin_Wu%27s_line_algorithm
+
+    if ((flags & VF_BLEND) && alpha == 0)
+        return;
+    paint pt;
+    init_paint(&pt, color, alpha);
 
     bool steep = ABS(y1 - y0) > ABS(x1 - x0);
     if (steep) {
@@ -256,77 +1080,1873 @@ void gfx_draw_line_aa(gfx_pixtile *tile,
     float dy = y1 - y0;
     if (dx == 0)
         return;                 // x0 == x1, y0 == y1, ∴ no line
-    float gradient = dy / dx;
+    fix16 gradient = float_to_fix16(dy / dx);
+    fix16 fx0 = float_to_fix16(x0), fy0 = float_to_fix16(y0);
+    fix16 fx1 = float_to_fix16(x1), fy1 = float_to_fix16(y1);
 
     // handle first endpoint
-    float xend = ROUND(x0);
-    float yend = y0 + gradient * (xend - x0);
-    float xgap = 255.0f * RFRAC(x0 + 0.5f);
-    int xpxl1 = xend;
-    int ypxl1 = FLOOR(yend);
-    if (steep) {
-        gfx_rgb565 *p = gfx_pixel_address(tile, ypxl1, xpxl1);
-        if (p)
-            *p = blend_pixel(*p, color, RFRAC(yend) * xgap);
-        p = gfx_pixel_address(tile, ypxl1 + 1, xpxl1);
-        if (p)
-            *p = blend_pixel(*p, color, FRAC(yend) * xgap);
-    } else {
-        gfx_rgb565 *p = gfx_pixel_address(tile, xpxl1, ypxl1);
-        if (p)
-            *p = blend_pixel(*p, color, RFRAC(yend) * xgap);
-        p = gfx_pixel_address(tile, xpxl1, ypxl1 + 1);
-        if (p)
-            *p = blend_pixel(*p, color, FRAC(yend) * xgap);
-    }
-    float intery = yend + gradient; // first y-intersection for the main loop
+    int xpxl1 = fix16_floor(fx0 + FIX16_HALF);
+    fix16 yend = fy0 + fix16_mul(gradient, xpxl1 * FIX16_ONE - fx0);
+    fix16 xgap = FIX16_ONE - ((fx0 + FIX16_HALF) & 0xFFFF);
+    plot_line_ends_aa(tile, steep, xpxl1, yend, xgap, &pt, flags);
+    fix16 intery = yend + gradient; // first y-intersection for the main loop
 
     // handle second endpoint
-    xend = ROUND(x1);
-    yend = y1 + gradient * (xend - x1);
-    xgap = 255.0f * FRAC(x1 + 0.5f);
-    int xpxl2 = xend;
-    int ypxl2 = FLOOR(yend);
-    if (steep) {
-        gfx_rgb565 *p = gfx_pixel_address(tile, ypxl2, xpxl2);
-        if (p)
-            *p = blend_pixel(*p, color, RFRAC(yend) * xgap);
-        p = gfx_pixel_address(tile, ypxl2 + 1, xpxl2);
-        if (p)
-            *p = blend_pixel(*p, color, FRAC(yend) * xgap);
+    int xpxl2 = fix16_floor(fx1 + FIX16_HALF);
+    yend = fy1 + fix16_mul(gradient, xpxl2 * FIX16_ONE - fx1);
+    xgap = (fx1 + FIX16_HALF) & 0xFFFF;
+    plot_line_ends_aa(tile, steep, xpxl2, yend, xgap, &pt, flags);
+
+    // main loop
+    int i0 = xpxl1 + 1;
+    int i1 = xpxl2 - 1;
+    line_bounds b = tile_line_bounds(tile, steep);
+    if (!(flags & VF_UNCLIPPED)) {
+        // Each step touches j and j + 1, so pad the minor axis by one.
+        if (!clip_line_range(&b, x0, y0, dx, dy, 1, &i0, &i1))
+            return;
+        intery += gradient * (i0 - (xpxl1 + 1));
+    }
+    ssize_t major_step = steep ? tile->stride : 1;
+    ssize_t minor_step = steep ? 1 : tile->stride;
+    unsigned j_range = b.max_j - b.min_j;
+    int j = fix16_floor(intery);
+    gfx_rgb565 *p = line_pixel_address(tile, steep, i0, j);
+    for (int i = i0; i <= i1; i++) {
+        uint32_t f = (intery & 0xFFFF) >> 8;
+        if ((flags & VF_UNCLIPPED) || (unsigned)(j - b.min_j) < j_range)
+            *p = blend_line_pixel(*p, steep, i, j, &pt,
+                                  line_alpha(255 - f, alpha, flags));
+        if ((flags & VF_UNCLIPPED) || (unsigned)(j + 1 - b.min_j) < j_range)
+            p[minor_step] = blend_line_pixel(p[minor_step], steep, i, j + 1,
+                                             &pt, line_alpha(f, alpha, flags));
+        intery += gradient;
+        int next_j = fix16_floor(intery);
+        p += major_step + (next_j - j) * minor_step;
+        j = next_j;
+    }
+}
+
+// Bresenham, jaggy.
+void gfx_draw_line(gfx_pixtile *tile,
+                   float x0, float y0,
+                   float x1, float y1,
+                   gfx_rgb888 color)
+{
+    draw_line(tile, x0, y0, x1, y1, color, 0xFF, 0);
+}
+
+// Line, anti-aliased using Xiaolin Wu's algorithm
+void gfx_draw_line_aa(gfx_pixtile *tile,
+                      float x0, float y0,
+                      float x1, float y1,
+                      gfx_rgb888 color)
+{
+    draw_line_aa(tile, x0, y0, x1, y1, color, 0xFF, VF_AA);
+}
+
+void gfx_draw_line_blend(gfx_pixtile *tile,
+                         float x0, float y0,
+                         float x1, float y1,
+                         gfx_rgb888 color,
+                         gfx_alpha8 alpha)
+{
+    draw_line(tile, x0, y0, x1, y1, color, alpha, VF_BLEND);
+}
+
+void gfx_draw_line_aa_blend(gfx_pixtile *tile,
+                            float x0, float y0,
+                            float x1, float y1,
+                            gfx_rgb888 color,
+                            gfx_alpha8 alpha)
+{
+    draw_line_aa(tile, x0, y0, x1, y1, color, alpha, VF_AA | VF_BLEND);
+}
+
+void gfx_draw_line_unclipped(gfx_pixtile *tile,
+                             float x0, float y0,
+                             float x1, float y1,
+                             gfx_rgb888 color)
+{
+    draw_line(tile, x0, y0, x1, y1, color, 0xFF, VF_UNCLIPPED);
+}
+
+void gfx_draw_line_aa_unclipped(gfx_pixtile *tile,
+                                float x0, float y0,
+                                float x1, float y1,
+                                gfx_rgb888 color)
+{
+    draw_line_aa(tile, x0, y0, x1, y1, color, 0xFF, VF_AA | VF_UNCLIPPED);
+}
+
+void gfx_draw_line_blend_unclipped(gfx_pixtile *tile,
+                                   float x0, float y0,
+                                   float x1, float y1,
+                                   gfx_rgb888 color,
+                                   gfx_alpha8 alpha)
+{
+    draw_line(tile, x0, y0, x1, y1, color, alpha,
+              VF_BLEND | VF_UNCLIPPED);
+}
+
+void gfx_draw_line_aa_blend_unclipped(gfx_pixtile *tile,
+                                      float x0, float y0,
+                                      float x1, float y1,
+                                      gfx_rgb888 color,
+                                      gfx_alpha8 alpha)
+{
+    draw_line_aa(tile, x0, y0, x1, y1, color, alpha,
+                 VF_AA | VF_BLEND | VF_UNCLIPPED);
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Trapezoids
+
+// An edge, stepped down the trapezoid one scan line at a time.
+typedef struct zoid_edge {
+    fix16 x;                    // x at the current y
+    fix16 dxdy;                 // slope
+    fix16 dydx;                 // inverse slope (aa only)
+    bool  is_steep;             // |dxdy| too small for dydx (aa only)
+} zoid_edge;
+
+// An edge with |dx/dy| below this is treated as vertical within
+// one scan line when computing coverage.
+#define STEEP_DXDY (FIX16_ONE / 16)
+
+static ALWAYS_INLINE void init_zoid_edge(zoid_edge *e,
+                                         float x0, float x1,
+                                         float y0, float y1,
+                                         float y_start,
+                                         variant_flags flags)
+{
+    float dxdy = CLAMP(-32767.0f, +32767.0f, (x1 - x0) / (y1 - y0));
+    e->dxdy = float_to_fix16(dxdy);
+    e->x = float_to_fix16(x0 + (y_start - y0) * dxdy);
+    if (flags & VF_AA) {
+        e->is_steep = ABS(e->dxdy) < STEEP_DXDY;
+        e->dydx = e->is_steep ? 0 : float_to_fix16(1.0f / dxdy);
+    }
+}
+
+// Integral of clamp(u, 0, 1) from 0 to u.
+static inline fix16 coverage_integral(fix16 u)
+{
+    if (u <= 0)
+        return 0;
+    if (u <= FIX16_ONE) {
+        uint32_t u8 = u >> 8;
+        return u8 * u8 >> 1;
+    }
+    return u - FIX16_HALF;
+}
+
+// Area of pixel column [px, px + 1) that is right of the edge, within
+// a scan line slab of height h where the edge runs from xa to xb.
+static inline fix16 area_right_of_edge(const zoid_edge *e,
+                                       fix16 xa, fix16 xb,
+                                       fix16 h, int px)
+{
+    fix16 right = (px + 1) * FIX16_ONE;
+    fix16 ua = right - xa;
+    fix16 ub = right - xb;
+    if (e->is_steep) {
+        fix16 um = CLAMP(0, FIX16_ONE, (ua >> 1) + (ub >> 1));
+        return (um >> 8) * (h >> 8);
+    }
+    fix16 a = fix16_mul(coverage_integral(ua) - coverage_integral(ub),
+                        e->dydx);
+    return CLAMP(0, h, a);
+}
+
+// Scale coverage (0 .. FIX16_ONE) by alpha.
+static inline gfx_alpha8 coverage_alpha(fix16 coverage, gfx_alpha8 alpha)
+{
+    return (coverage >> 8) * alpha >> 8;
+}
+
+// One trapezoid's part of one scan line: a slab h high, where the
+// left edge runs from xla to xlb and the right edge from xra to xrb.
+typedef struct zoid_slab {
+    const zoid_edge *le, *re;
+    fix16            xla, xlb;
+    fix16            xra, xrb;
+    fix16            h;
+} zoid_slab;
+
+// Advance a trapezoid's edges through the slab from y to y + h.
+static ALWAYS_INLINE void step_zoid_slab(zoid_slab *s,
+                                         zoid_edge *le, zoid_edge *re,
+                                         fix16 h)
+{
+    s->le  = le;
+    s->re  = re;
+    s->h   = h;
+    s->xla = le->x;
+    s->xra = re->x;
+    if (h == FIX16_ONE) {
+        le->x += le->dxdy;
+        re->x += re->dxdy;
     } else {
-        gfx_rgb565 *p = gfx_pixel_address(tile, xpxl2, ypxl2);
-        if (p)
-            *p = blend_pixel(*p, color, RFRAC(yend) * xgap);
-        p = gfx_pixel_address(tile, xpxl2, ypxl2 + 1);
-        if (p)
-            *p = blend_pixel(*p, color, FRAC(yend) * xgap);
+        le->x += fix16_mul(le->dxdy, h);
+        re->x += fix16_mul(re->dxdy, h);
     }
+    s->xlb = le->x;
+    s->xrb = re->x;
+}
 
-    // main loop
-    if (steep) {
-        for (int x = xpxl1 + 1; x < xpxl2; x++) {
-            int y = FLOOR(intery);
-            int f = 256.0f * FRAC(intery);
-            gfx_rgb565 *p = gfx_pixel_address(tile, y, x);
-            if (p)
-                *p = blend_pixel(*p, color, 255  - f);
-            p = gfx_pixel_address(tile, y + 1, x);
-            if (p)
-                *p = blend_pixel(*p, color, f);
-            intery += gradient;
+// Render one scan line of antialiased coverage.  The scan line is
+// covered by one slab, or by two when a trapezoid pair meets inside
+// it.  Coverage of the slabs is summed, so there is no seam.
+static ALWAYS_INLINE void fill_slabs_aa(gfx_pixtile *tile, int y,
+                                        const zoid_slab *slabs,
+                                        size_t slab_count,
+                                        const paint *pt,
+                                        variant_flags flags)
+{
+    int x0  = INT32_MAX;        // first partial column
+    int xf0 = INT32_MIN;        // first full column
+    int xf1 = INT32_MAX;        // end of full columns
+    int x1  = INT32_MIN;        // end of partial columns
+    fix16 h = 0;
+    for (size_t i = 0; i < slab_count; i++) {
+        const zoid_slab *s = &slabs[i];
+        x0  = MIN(x0,  fix16_floor(MIN(s->xla, s->xlb)));
+        xf0 = MAX(xf0, fix16_ceil (MAX(s->xla, s->xlb)));
+        xf1 = MIN(xf1, fix16_floor(MIN(s->xra, s->xrb)));
+        x1  = MAX(x1,  fix16_ceil (MAX(s->xra, s->xrb)));
+        h += s->h;
+    }
+    if (!(flags & VF_UNCLIPPED)) {
+        int min_x = tile->x;
+        int max_x = min_x + tile->w;
+        x0  = MAX(x0,  min_x);
+        xf0 = MAX(xf0, min_x);
+        xf1 = MIN(xf1, max_x);
+        x1  = MIN(x1,  max_x);
+    }
+    if (xf0 >= xf1)
+        xf0 = xf1 = x1;         // edges overlap: no full columns
+
+    gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, x0, y);
+    for (int x = x0; x < x1; x++, p++) {
+        if (x == xf0) {
+            gfx_alpha8 a = coverage_alpha(h, pt->alpha);
+            fill_or_blend_run(p, xf1 - xf0, x, y, pt, a);
+            p += xf1 - xf0 - 1;
+            x = xf1 - 1;
+            continue;
+        }
+        fix16 c = 0;
+        for (size_t i = 0; i < slab_count; i++) {
+            const zoid_slab *s = &slabs[i];
+            c += area_right_of_edge(s->le, s->xla, s->xlb, s->h, x) -
+                 area_right_of_edge(s->re, s->xra, s->xrb, s->h, x);
+        }
+        if (c <= 0)
+            continue;
+        gfx_alpha8 a = coverage_alpha(MIN(c, FIX16_ONE), pt->alpha);
+        if (a == 0xFF && !pt->dither)
+            *p = pt->pixel;
+        else if (a)
+            *p = blend_pixel(*p, pt, a, x, y);
+    }
+}
+
+// Antialias a trapezoid, or a pair of trapezoids where the second's
+// top is the first's bottom.  (A triangle is such a pair.)  Either
+// may be NULL, but not both.
+static ALWAYS_INLINE void fill_zoid_pair_aa(gfx_pixtile *tile,
+                                            const gfx_trapezoid *top,
+                                            const gfx_trapezoid *bot,
+                                            const paint *pt,
+                                            variant_flags flags)
+{
+    const gfx_trapezoid *first = top ? top : bot;
+    const gfx_trapezoid *last  = bot ? bot : top;
+    fix16 y0 = float_to_fix16(first->y0);
+    fix16 ym = top ? float_to_fix16(top->y1) : y0;
+    fix16 y1 = float_to_fix16(last->y1);
+    int iy0 = fix16_floor(y0);
+    int iy1 = fix16_ceil(y1);
+    fix16 ya = y0;
+    if (!(flags & VF_UNCLIPPED)) {
+        if (iy0 < tile->y) {
+            iy0 = tile->y;
+            ya = iy0 * FIX16_ONE;
+        }
+        iy1 = MIN(iy1, tile->y + (int)tile->h);
+    }
+    if (iy0 >= iy1)
+        return;
+
+    zoid_edge tle = { 0 }, tre = { 0 }, ble = { 0 }, bre = { 0 };
+    if (top && ya < ym) {
+        float y_start = (float)ya / FIX16_ONE;
+        init_zoid_edge(&tle, top->xl0, top->xl1, top->y0, top->y1,
+                       y_start, flags);
+        init_zoid_edge(&tre, top->xr0, top->xr1, top->y0, top->y1,
+                       y_start, flags);
+    }
+    if (bot) {
+        float y_start = (float)MAX(ya, ym) / FIX16_ONE;
+        init_zoid_edge(&ble, bot->xl0, bot->xl1, bot->y0, bot->y1,
+                       y_start, flags);
+        init_zoid_edge(&bre, bot->xr0, bot->xr1, bot->y0, bot->y1,
+                       y_start, flags);
+    }
+
+    for (int iy = iy0; iy < iy1; iy++) {
+        fix16 yb = MIN(y1, (iy + 1) * FIX16_ONE);
+        zoid_slab slabs[2] = { { 0 } };
+        size_t n = 0;
+        if (top && ya < ym)
+            step_zoid_slab(&slabs[n++], &tle, &tre, MIN(yb, ym) - ya);
+        if (bot && yb > ym)
+            step_zoid_slab(&slabs[n++], &ble, &bre, yb - MAX(ya, ym));
+        fill_slabs_aa(tile, iy, slabs, n, pt, flags);
+        ya = yb;
+    }
+}
+
+// Non-antialiased trapezoids sample at pixel centers.
+static ALWAYS_INLINE void fill_zoid(gfx_pixtile *tile,
+                                    const gfx_trapezoid *z,
+                                    const paint *pt,
+                                    const gradient_paint *gp,
+                                    variant_flags flags)
+{
+    // Rows whose centers are in [y0, y1).
+    int iy0 = fix16_ceil(float_to_fix16(z->y0) - FIX16_HALF);
+    int iy1 = fix16_ceil(float_to_fix16(z->y1) - FIX16_HALF);
+    if (!(flags & VF_UNCLIPPED)) {
+        iy0 = MAX(iy0, tile->y);
+        iy1 = MIN(iy1, tile->y + (int)tile->h);
+    }
+    if (iy0 >= iy1)
+        return;
+
+    float y_start = iy0 + 0.5f;
+    zoid_edge le, re;
+    init_zoid_edge(&le, z->xl0, z->xl1, z->y0, z->y1, y_start, flags);
+    init_zoid_edge(&re, z->xr0, z->xr1, z->y0, z->y1, y_start, flags);
+
+    // Offset by -1/2 so ceil() finds the first pixel center inside.
+    fix16 xl = le.x - FIX16_HALF;
+    fix16 xr = re.x - FIX16_HALF;
+    for (int iy = iy0; iy < iy1; iy++) {
+        int ix0 = fix16_ceil(xl);
+        int ix1 = fix16_ceil(xr);
+        if (!(flags & VF_UNCLIPPED)) {
+            ix0 = MAX(ix0, tile->x);
+            ix1 = MIN(ix1, tile->x + (int)tile->w);
+        }
+        if (ix0 < ix1) {
+            gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, ix0, iy);
+            if (flags & VF_GRADIENT)
+                gradient_span(tile, ix0, ix1, iy, gp);
+            else
+                paint_run(p, ix1 - ix0, ix0, iy, pt, flags);
+        }
+        xl += le.dxdy;
+        xr += re.dxdy;
+    }
+}
+
+static ALWAYS_INLINE void fill_trapezoids(gfx_pixtile *tile,
+                                          const gfx_trapezoid *zoids,
+                                          size_t count,
+                                          gfx_rgb888 color,
+                                          gfx_alpha8 alpha,
+                                          const gradient_paint *gp,
+                                          variant_flags flags)
+{
+    if ((flags & VF_BLEND) && alpha == 0)
+        return;
+    paint pt;
+    init_paint(&pt, color, alpha);
+    float min_y = tile->y;
+    float max_y = tile->y + tile->h;
+    for (size_t i = 0; i < count; i++) {
+        const gfx_trapezoid *z = &zoids[i];
+        if (!(z->y0 < z->y1))
+            continue;
+        if (!(flags & VF_UNCLIPPED) && (z->y1 <= min_y || z->y0 >= max_y))
+            continue;
+        if (flags & VF_AA)
+            fill_zoid_pair_aa(tile, z, NULL, &pt, flags);
+        else
+            fill_zoid(tile, z, &pt, gp, flags);
+    }
+}
+
+void gfx_fill_trapezoids(gfx_pixtile *tile,
+                         gfx_trapezoid *zoids,
+                         size_t count,
+                         gfx_rgb888 color)
+{
+    fill_trapezoids(tile, zoids, count, color, 0xFF, NULL, 0);
+}
+
+void gfx_fill_trapezoids_aa(gfx_pixtile *tile,
+                            gfx_trapezoid *zoids,
+                            size_t count,
+                            gfx_rgb888 color)
+{
+    fill_trapezoids(tile, zoids, count, color, 0xFF, NULL, VF_AA);
+}
+
+void gfx_fill_trapezoids_blend(gfx_pixtile *tile,
+                               gfx_trapezoid *zoids,
+                               size_t count,
+                               gfx_rgb888 color,
+                               gfx_alpha8 alpha)
+{
+    fill_trapezoids(tile, zoids, count, color, alpha, NULL, VF_BLEND);
+}
+
+void gfx_fill_trapezoids_aa_blend(gfx_pixtile *tile,
+                                  gfx_trapezoid *zoids,
+                                  size_t count,
+                                  gfx_rgb888 color,
+                                  gfx_alpha8 alpha)
+{
+    fill_trapezoids(tile, zoids, count, color, alpha, NULL,
+                    VF_AA | VF_BLEND);
+}
+
+void gfx_fill_trapezoids_unclipped(gfx_pixtile *tile,
+                                   gfx_trapezoid *zoids,
+                                   size_t count,
+                                   gfx_rgb888 color)
+{
+    fill_trapezoids(tile, zoids, count, color, 0xFF, NULL, VF_UNCLIPPED);
+}
+
+void gfx_fill_trapezoids_aa_unclipped(gfx_pixtile *tile,
+                                      gfx_trapezoid *zoids,
+                                      size_t count,
+                                      gfx_rgb888 color)
+{
+    fill_trapezoids(tile, zoids, count, color, 0xFF, NULL,
+                    VF_AA | VF_UNCLIPPED);
+}
+
+void gfx_fill_trapezoids_blend_unclipped(gfx_pixtile *tile,
+                                         gfx_trapezoid *zoids,
+                                         size_t count,
+                                         gfx_rgb888 color,
+                                         gfx_alpha8 alpha)
+{
+    fill_trapezoids(tile, zoids, count, color, alpha, NULL,
+                    VF_BLEND | VF_UNCLIPPED);
+}
+
+void gfx_fill_trapezoids_aa_blend_unclipped(gfx_pixtile *tile,
+                                            gfx_trapezoid *zoids,
+                                            size_t count,
+                                            gfx_rgb888 color,
+                                            gfx_alpha8 alpha)
+{
+    fill_trapezoids(tile, zoids, count, color, alpha, NULL,
+                    VF_AA | VF_BLEND | VF_UNCLIPPED);
+}
+
+void gfx_fill_trapezoids_gradient(gfx_pixtile *tile,
+                                  gfx_trapezoid *zoids,
+                                  size_t count,
+                                  const gfx_gradient *gradient)
+{
+    gradient_paint gp;
+    init_gradient_paint(&gp, gradient);
+    fill_trapezoids(tile, zoids, count, 0, 0xFF, &gp, VF_GRADIENT);
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Triangles
+
+// Sort a triangle's vertices by y, then split it at the middle vertex
+// into a top and a bottom trapezoid.  Either may have zero height.
+static ALWAYS_INLINE void split_triangle(const gfx_triangle *tri,
+                                         gfx_trapezoid *top,
+                                         gfx_trapezoid *bot)
+{
+    const gfx_point *a = &tri->v[0];
+    const gfx_point *b = &tri->v[1];
+    const gfx_point *c = &tri->v[2];
+    const gfx_point *t;
+    if (b->y < a->y) { t = a; a = b; b = t; }
+    if (c->y < b->y) { t = b; b = c; c = t; }
+    if (b->y < a->y) { t = a; a = b; b = t; }
+
+    // x of the long edge, a-c, where it passes b.
+    float xm = a->x;
+    if (a->y < c->y)
+        xm += (c->x - a->x) * (b->y - a->y) / (c->y - a->y);
+    float xl = MIN(xm, b->x);
+    float xr = MAX(xm, b->x);
+
+    *top = (gfx_trapezoid) {
+        .xl0 = a->x, .xr0 = a->x, .y0 = a->y,
+        .xl1 = xl,   .xr1 = xr,   .y1 = b->y,
+    };
+    *bot = (gfx_trapezoid) {
+        .xl0 = xl,   .xr0 = xr,   .y0 = b->y,
+        .xl1 = c->x, .xr1 = c->x, .y1 = c->y,
+    };
+}
+
+static ALWAYS_INLINE bool triangle_misses_tile(const gfx_pixtile *tile,
+                                               const gfx_triangle *tri)
+{
+    const gfx_point *v = tri->v;
+    float min_x = MIN(v[0].x, MIN(v[1].x, v[2].x));
+    float max_x = MAX(v[0].x, MAX(v[1].x, v[2].x));
+    float min_y = MIN(v[0].y, MIN(v[1].y, v[2].y));
+    float max_y = MAX(v[0].y, MAX(v[1].y, v[2].y));
+    return max_y <= tile->y || min_y >= (float)(tile->y + tile->h) ||
+           max_x <= tile->x || min_x >= (float)(tile->x + tile->w);
+}
+
+static ALWAYS_INLINE void fill_triangles(gfx_pixtile *tile,
+                                         const gfx_triangle *tris,
+                                         size_t count,
+                                         gfx_rgb888 color,
+                                         gfx_alpha8 alpha,
+                                         variant_flags flags)
+{
+    if ((flags & VF_BLEND) && alpha == 0)
+        return;
+    paint pt;
+    init_paint(&pt, color, alpha);
+    for (size_t i = 0; i < count; i++) {
+        const gfx_triangle *tri = &tris[i];
+        if (!(flags & VF_UNCLIPPED) && triangle_misses_tile(tile, tri))
+            continue;
+        gfx_trapezoid top, bot;
+        split_triangle(tri, &top, &bot);
+        bool has_top = top.y0 < top.y1;
+        bool has_bot = bot.y0 < bot.y1;
+        if (flags & VF_AA) {
+            if (has_top || has_bot)
+                fill_zoid_pair_aa(tile,
+                                  has_top ? &top : NULL,
+                                  has_bot ? &bot : NULL,
+                                  &pt, flags);
+        } else {
+            if (has_top)
+                fill_zoid(tile, &top, &pt, NULL, flags);
+            if (has_bot)
+                fill_zoid(tile, &bot, &pt, NULL, flags);
+        }
+    }
+}
+
+void gfx_fill_triangle(gfx_pixtile *tile,
+                       gfx_triangle *tris,
+                       size_t count,
+                       gfx_rgb888 color)
+{
+    fill_triangles(tile, tris, count, color, 0xFF, 0);
+}
+
+void gfx_fill_triangle_aa(gfx_pixtile *tile,
+                          gfx_triangle *tris,
+                          size_t count,
+                          gfx_rgb888 color)
+{
+    fill_triangles(tile, tris, count, color, 0xFF, VF_AA);
+}
+
+void gfx_fill_triangle_blend(gfx_pixtile *tile,
+                             gfx_triangle *tris,
+                             size_t count,
+                             gfx_rgb888 color,
+                             gfx_alpha8 alpha)
+{
+    fill_triangles(tile, tris, count, color, alpha, VF_BLEND);
+}
+
+void gfx_fill_triangle_aa_blend(gfx_pixtile *tile,
+                                gfx_triangle *tris,
+                                size_t count,
+                                gfx_rgb888 color,
+                                gfx_alpha8 alpha)
+{
+    fill_triangles(tile, tris, count, color, alpha, VF_AA | VF_BLEND);
+}
+
+void gfx_fill_triangle_unclipped(gfx_pixtile *tile,
+                                 gfx_triangle *tris,
+                                 size_t count,
+                                 gfx_rgb888 color)
+{
+    fill_triangles(tile, tris, count, color, 0xFF, VF_UNCLIPPED);
+}
+
+void gfx_fill_triangle_aa_unclipped(gfx_pixtile *tile,
+                                    gfx_triangle *tris,
+                                    size_t count,
+                                    gfx_rgb888 color)
+{
+    fill_triangles(tile, tris, count, color, 0xFF, VF_AA | VF_UNCLIPPED);
+}
+
+void gfx_fill_triangle_blend_unclipped(gfx_pixtile *tile,
+                                       gfx_triangle *tris,
+                                       size_t count,
+                                       gfx_rgb888 color,
+                                       gfx_alpha8 alpha)
+{
+    fill_triangles(tile, tris, count, color, alpha,
+                   VF_BLEND | VF_UNCLIPPED);
+}
+
+void gfx_fill_triangle_aa_blend_unclipped(gfx_pixtile *tile,
+                                          gfx_triangle *tris,
+                                          size_t count,
+                                          gfx_rgb888 color,
+                                          gfx_alpha8 alpha)
+{
+    fill_triangles(tile, tris, count, color, alpha,
+                   VF_AA | VF_BLEND | VF_UNCLIPPED);
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Rectangles
+
+// A rectangle's extent along one axis, in pixels.  Pixels [f0, f1)
+// are fully covered.  Antialiased rectangles may also partly cover
+// pixel i0 (if i0 < f0) and pixel f1 (if f1 < i1).
+typedef struct rect_axis {
+    int        i0, i1;          // pixels touched
+    int        f0, f1;          // pixels fully covered
+    gfx_alpha8 a0, a1;          // coverage of pixels i0 and f1
+} rect_axis;
+
+// Find the pixels covered by [lo, hi), then clip them to [min, max).
+static ALWAYS_INLINE void init_rect_axis(rect_axis *ax,
+                                         float lo, float hi,
+                                         int min, int max,
+                                         variant_flags flags)
+{
+    if (flags & VF_AA) {
+        ax->i0 = FLOOR(lo);
+        ax->i1 = CEIL(hi);
+        if (ax->i1 - ax->i0 == 1) {
+            // Inside one pixel.
+            ax->f0 = ax->f1 = ax->i1;
+            ax->a0 = (hi - lo) * 255 + 0.5f;
+            ax->a1 = 0;
+        } else {
+            ax->f0 = CEIL(lo);
+            ax->f1 = FLOOR(hi);
+            ax->a0 = (ax->f0 - lo) * 255 + 0.5f;
+            ax->a1 = (hi - ax->f1) * 255 + 0.5f;
+        }
+    } else {
+        // Pixel centers in [lo, hi).
+        ax->i0 = ax->f0 = CEIL(lo - 0.5f);
+        ax->i1 = ax->f1 = CEIL(hi - 0.5f);
+        ax->a0 = ax->a1 = 0;
+    }
+    if (!(flags & VF_UNCLIPPED)) {
+        ax->i0 = MAX(ax->i0, min);
+        ax->i1 = MIN(ax->i1, max);
+        ax->f0 = CLAMP(ax->i0, ax->i1, ax->f0);
+        ax->f1 = CLAMP(ax->f0, ax->i1, ax->f1);
+    }
+}
+
+// One row of an antialiased rectangle, whose vertical coverage is
+// row_alpha.
+static ALWAYS_INLINE void fill_rect_row_aa(gfx_pixtile *tile, int y,
+                                           const rect_axis *xa,
+                                           const paint *pt,
+                                           gfx_alpha8 row_alpha)
+{
+    gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, xa->i0, y);
+    if (xa->i0 < xa->f0) {
+        *p = blend_pixel(*p, pt, mul_alpha(xa->a0, row_alpha), xa->i0, y);
+        p++;
+    }
+    fill_or_blend_run(p, xa->f1 - xa->f0, xa->f0, y, pt, row_alpha);
+    p += xa->f1 - xa->f0;
+    if (xa->f1 < xa->i1)
+        *p = blend_pixel(*p, pt, mul_alpha(xa->a1, row_alpha), xa->f1, y);
+}
+
+static ALWAYS_INLINE void fill_rect(gfx_pixtile *tile,
+                                    float x, float y,
+                                    float w, float h,
+                                    gfx_rgb888 color,
+                                    gfx_alpha8 alpha,
+                                    variant_flags flags)
+{
+    if ((flags & VF_BLEND) && alpha == 0)
+        return;
+    paint pt;
+    init_paint(&pt, color, alpha);
+    if (!(w > 0 && h > 0))
+        return;
+
+    rect_axis xa, ya;
+    init_rect_axis(&xa, x, x + w, tile->x, tile->x + tile->w, flags);
+    init_rect_axis(&ya, y, y + h, tile->y, tile->y + tile->h, flags);
+    if (xa.i0 >= xa.i1 || ya.i0 >= ya.i1)
+        return;
+
+    if (!(flags & VF_AA)) {
+        gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, xa.i0, ya.i0);
+        size_t nx = xa.i1 - xa.i0, ny = ya.i1 - ya.i0;
+        if ((flags & VF_BLEND) || pt.dithers)
+            for (int iy = ya.i0; iy < ya.i1; iy++, p += tile->stride)
+                paint_run(p, nx, xa.i0, iy, &pt, flags);
+        else
+            fill_block(p, nx, ny, tile->stride, pt.pixel);
+        return;
+    }
+
+    // Partial top row, full rows, partial bottom row.
+    if (ya.i0 < ya.f0)
+        fill_rect_row_aa(tile, ya.i0, &xa, &pt, mul_alpha(ya.a0, alpha));
+    if (ya.f0 < ya.f1) {
+        if (!(flags & VF_BLEND) && !pt.dither && xa.f0 < xa.f1) {
+            // Fill the interior as a block, then the side columns.
+            gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, xa.f0, ya.f0);
+            fill_block(p, xa.f1 - xa.f0, ya.f1 - ya.f0, tile->stride,
+                       pt.pixel);
+            for (int iy = ya.f0; iy < ya.f1; iy++, p += tile->stride) {
+                if (xa.i0 < xa.f0)
+                    p[-1] = blend_pixel(p[-1], &pt, xa.a0, xa.i0, iy);
+                if (xa.f1 < xa.i1)
+                    p[xa.f1 - xa.f0] = blend_pixel(p[xa.f1 - xa.f0],
+                                                   &pt, xa.a1, xa.f1, iy);
+            }
+        } else {
+            for (int iy = ya.f0; iy < ya.f1; iy++)
+                fill_rect_row_aa(tile, iy, &xa, &pt, alpha);
+        }
+    }
+    if (ya.f1 < ya.i1)
+        fill_rect_row_aa(tile, ya.f1, &xa, &pt, mul_alpha(ya.a1, alpha));
+}
+
+void gfx_fill_rect(gfx_pixtile *tile,
+                   float x, float y,
+                   float w, float h,
+                   gfx_rgb888 color)
+{
+    fill_rect(tile, x, y, w, h, color, 0xFF, 0);
+}
+
+void gfx_fill_rect_aa(gfx_pixtile *tile,
+                      float x, float y,
+                      float w, float h,
+                      gfx_rgb888 color)
+{
+    fill_rect(tile, x, y, w, h, color, 0xFF, VF_AA);
+}
+
+void gfx_fill_rect_blend(gfx_pixtile *tile,
+                         float x, float y,
+                         float w, float h,
+                         gfx_rgb888 color,
+                         gfx_alpha8 alpha)
+{
+    fill_rect(tile, x, y, w, h, color, alpha, VF_BLEND);
+}
+
+void gfx_fill_rect_aa_blend(gfx_pixtile *tile,
+                            float x, float y,
+                            float w, float h,
+                            gfx_rgb888 color,
+                            gfx_alpha8 alpha)
+{
+    fill_rect(tile, x, y, w, h, color, alpha, VF_AA | VF_BLEND);
+}
+
+void gfx_fill_rect_unclipped(gfx_pixtile *tile,
+                             float x, float y,
+                             float w, float h,
+                             gfx_rgb888 color)
+{
+    fill_rect(tile, x, y, w, h, color, 0xFF, VF_UNCLIPPED);
+}
+
+void gfx_fill_rect_aa_unclipped(gfx_pixtile *tile,
+                                float x, float y,
+                                float w, float h,
+                                gfx_rgb888 color)
+{
+    fill_rect(tile, x, y, w, h, color, 0xFF, VF_AA | VF_UNCLIPPED);
+}
+
+void gfx_fill_rect_blend_unclipped(gfx_pixtile *tile,
+                                   float x, float y,
+                                   float w, float h,
+                                   gfx_rgb888 color,
+                                   gfx_alpha8 alpha)
+{
+    fill_rect(tile, x, y, w, h, color, alpha, VF_BLEND | VF_UNCLIPPED);
+}
+
+void gfx_fill_rect_aa_blend_unclipped(gfx_pixtile *tile,
+                                      float x, float y,
+                                      float w, float h,
+                                      gfx_rgb888 color,
+                                      gfx_alpha8 alpha)
+{
+    fill_rect(tile, x, y, w, h, color, alpha, VF_AA | VF_BLEND | VF_UNCLIPPED);
+}
+
+void gfx_fill_rect_gradient(gfx_pixtile *tile,
+                            float x, float y,
+                            float w, float h,
+                            const gfx_gradient *gradient)
+{
+    if (!(w > 0 && h > 0))
+        return;
+    rect_axis xa, ya;
+    init_rect_axis(&xa, x, x + w, tile->x, tile->x + tile->w, 0);
+    init_rect_axis(&ya, y, y + h, tile->y, tile->y + tile->h, 0);
+    if (xa.i0 >= xa.i1 || ya.i0 >= ya.i1)
+        return;
+    gradient_paint gp;
+    init_gradient_paint(&gp, gradient);
+    for (int iy = ya.i0; iy < ya.i1; iy++)
+        gradient_span(tile, xa.i0, xa.i1, iy, &gp);
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Ellipses
+
+// Ellipses are axis aligned.  A circle is an ellipse with rx == ry.
+// Only the scan lines that intersect the tile are visited, and each
+// costs one square root.
+
+// Half width of the ellipse at dy from its center.
+static inline float ellipse_half_width(float rx, float inv_ry, float dy)
+{
+    float t = dy * inv_ry;
+    t = 1 - t * t;
+    return t > 0 ? rx * sqrtf(t) : 0;
+}
+
+// Non-antialiased ellipses sample at pixel centers.
+static ALWAYS_INLINE void fill_ellipse_spans(gfx_pixtile *tile,
+                                             float cx, float cy,
+                                             float rx, float ry,
+                                             const paint *pt,
+                                             variant_flags flags)
+{
+    // Rows whose centers are in (cy - ry, cy + ry).
+    int iy0 = CEIL(cy - ry - 0.5f);
+    int iy1 = CEIL(cy + ry - 0.5f);
+    if (!(flags & VF_UNCLIPPED)) {
+        iy0 = MAX(iy0, tile->y);
+        iy1 = MIN(iy1, tile->y + (int)tile->h);
+    }
+    float inv_ry = 1 / ry;
+    for (int iy = iy0; iy < iy1; iy++) {
+        float hw = ellipse_half_width(rx, inv_ry, iy + 0.5f - cy);
+        int ix0 = CEIL(cx - hw - 0.5f);
+        int ix1 = CEIL(cx + hw - 0.5f);
+        if (!(flags & VF_UNCLIPPED)) {
+            ix0 = MAX(ix0, tile->x);
+            ix1 = MIN(ix1, tile->x + (int)tile->w);
+        }
+        if (ix0 < ix1) {
+            gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, ix0, iy);
+            paint_run(p, ix1 - ix0, ix0, iy, pt, flags);
+        }
+    }
+}
+
+// Most scan lines are covered by one slab.  The middle one is split at
+// cy, where the edges turn, and the ones near the top and bottom, where
+// the edges are nearly horizontal, are split so each chord stays close
+// to the curve.
+#define ELLIPSE_MAX_SLABS 8
+#define ELLIPSE_MAX_SPLIT 4
+
+// Antialiased ellipses approximate each scan line's part of the edge
+// by chords and use the trapezoid coverage code on those.
+static ALWAYS_INLINE void fill_ellipse_aa(gfx_pixtile *tile,
+                                          float cx, float cy,
+                                          float rx, float ry,
+                                          const paint *pt,
+                                          variant_flags flags)
+{
+    float top = cy - ry;
+    float bottom = cy + ry;
+    int iy0 = FLOOR(top);
+    int iy1 = CEIL(bottom);
+    if (!(flags & VF_UNCLIPPED)) {
+        iy0 = MAX(iy0, tile->y);
+        iy1 = MIN(iy1, tile->y + (int)tile->h);
+    }
+    float inv_ry = 1 / ry;
+    for (int iy = iy0; iy < iy1; iy++) {
+        float ya = MAX(top, (float)iy);
+        float yb = MIN(bottom, (float)iy + 1);
+        float halves[2][2] = { { ya, yb } };
+        size_t half_count = 1;
+        if (ya < cy && cy < yb) {
+            halves[0][1] = halves[1][0] = cy;
+            halves[1][1] = yb;
+            half_count = 2;
         }
+
+        zoid_edge edges[ELLIPSE_MAX_SLABS][2];
+        zoid_slab slabs[ELLIPSE_MAX_SLABS];
+        size_t n = 0;
+        for (size_t i = 0; i < half_count; i++) {
+            float y0 = halves[i][0], y1 = halves[i][1];
+            float hw0 = ellipse_half_width(rx, inv_ry, y0 - cy);
+            float hw1 = ellipse_half_width(rx, inv_ry, y1 - cy);
+            int split = MIN(ELLIPSE_MAX_SPLIT, CEIL(ABS(hw1 - hw0)));
+            split = MAX(split, 1);
+            for (int j = 0; j < split; j++) {
+                float sa = y0 + (y1 - y0) * j / split;
+                float sb = j + 1 < split ? y0 + (y1 - y0) * (j + 1) / split
+                                         : y1;
+                if (!(sa < sb))
+                    continue;
+                float hwa = j ? ellipse_half_width(rx, inv_ry, sa - cy) : hw0;
+                float hwb = j + 1 < split
+                          ? ellipse_half_width(rx, inv_ry, sb - cy) : hw1;
+                zoid_edge *le = &edges[n][0], *re = &edges[n][1];
+                init_zoid_edge(le, cx - hwa, cx - hwb, sa, sb, sa, flags);
+                init_zoid_edge(re, cx + hwa, cx + hwb, sa, sb, sa, flags);
+                fix16 h = float_to_fix16(sb - sa);
+                step_zoid_slab(&slabs[n], le, re, h);
+                // Step from the exact end points, not the slope.
+                slabs[n].xlb = float_to_fix16(cx - hwb);
+                slabs[n].xrb = float_to_fix16(cx + hwb);
+                n++;
+            }
+        }
+        if (n)
+            fill_slabs_aa(tile, iy, slabs, n, pt, flags);
+    }
+}
+
+static ALWAYS_INLINE void fill_ellipse(gfx_pixtile *tile,
+                                       float cx, float cy,
+                                       float rx, float ry,
+                                       gfx_rgb888 color,
+                                       gfx_alpha8 alpha,
+                                       variant_flags flags)
+{
+    if ((flags & VF_BLEND) && alpha == 0)
+        return;
+    paint pt;
+    init_paint(&pt, color, alpha);
+    if (!(rx > 0 && ry > 0))
+        return;
+    if (!(flags & VF_UNCLIPPED) &&
+        (cx + rx <= tile->x || cx - rx >= tile->x + (int)tile->w))
+        return;
+    if (flags & VF_AA)
+        fill_ellipse_aa(tile, cx, cy, rx, ry, &pt, flags);
+    else
+        fill_ellipse_spans(tile, cx, cy, rx, ry, &pt, flags);
+}
+
+void gfx_fill_circle(gfx_pixtile *tile,
+                     float cx, float cy,
+                     float r,
+                     gfx_rgb888 color)
+{
+    fill_ellipse(tile, cx, cy, r, r, color, 0xFF, 0);
+}
+
+void gfx_fill_circle_aa(gfx_pixtile *tile,
+                        float cx, float cy,
+                        float r,
+                        gfx_rgb888 color)
+{
+    fill_ellipse(tile, cx, cy, r, r, color, 0xFF, VF_AA);
+}
+
+void gfx_fill_circle_blend(gfx_pixtile *tile,
+                           float cx, float cy,
+                           float r,
+                           gfx_rgb888 color,
+                           gfx_alpha8 alpha)
+{
+    fill_ellipse(tile, cx, cy, r, r, color, alpha, VF_BLEND);
+}
+
+void gfx_fill_circle_aa_blend(gfx_pixtile *tile,
+                              float cx, float cy,
+                              float r,
+                              gfx_rgb888 color,
+                              gfx_alpha8 alpha)
+{
+    fill_ellipse(tile, cx, cy, r, r, color, alpha, VF_AA | VF_BLEND);
+}
+
+void gfx_fill_circle_unclipped(gfx_pixtile *tile,
+                               float cx, float cy,
+                               float r,
+                               gfx_rgb888 color)
+{
+    fill_ellipse(tile, cx, cy, r, r, color, 0xFF, VF_UNCLIPPED);
+}
+
+void gfx_fill_circle_aa_unclipped(gfx_pixtile *tile,
+                                  float cx, float cy,
+                                  float r,
+                                  gfx_rgb888 color)
+{
+    fill_ellipse(tile, cx, cy, r, r, color, 0xFF, VF_AA | VF_UNCLIPPED);
+}
+
+void gfx_fill_circle_blend_unclipped(gfx_pixtile *tile,
+                                     float cx, float cy,
+                                     float r,
+                                     gfx_rgb888 color,
+                                     gfx_alpha8 alpha)
+{
+    fill_ellipse(tile, cx, cy, r, r, color, alpha, VF_BLEND | VF_UNCLIPPED);
+}
+
+void gfx_fill_circle_aa_blend_unclipped(gfx_pixtile *tile,
+                                        float cx, float cy,
+                                        float r,
+                                        gfx_rgb888 color,
+                                        gfx_alpha8 alpha)
+{
+    fill_ellipse(tile, cx, cy, r, r, color, alpha,
+                 VF_AA | VF_BLEND | VF_UNCLIPPED);
+}
+
+void gfx_fill_ellipse(gfx_pixtile *tile,
+                      float cx, float cy,
+                      float rx, float ry,
+                      gfx_rgb888 color)
+{
+    fill_ellipse(tile, cx, cy, rx, ry, color, 0xFF, 0);
+}
+
+void gfx_fill_ellipse_aa(gfx_pixtile *tile,
+                         float cx, float cy,
+                         float rx, float ry,
+                         gfx_rgb888 color)
+{
+    fill_ellipse(tile, cx, cy, rx, ry, color, 0xFF, VF_AA);
+}
+
+void gfx_fill_ellipse_blend(gfx_pixtile *tile,
+                            float cx, float cy,
+                            float rx, float ry,
+                            gfx_rgb888 color,
+                            gfx_alpha8 alpha)
+{
+    fill_ellipse(tile, cx, cy, rx, ry, color, alpha, VF_BLEND);
+}
+
+void gfx_fill_ellipse_aa_blend(gfx_pixtile *tile,
+                               float cx, float cy,
+                               float rx, float ry,
+                               gfx_rgb888 color,
+                               gfx_alpha8 alpha)
+{
+    fill_ellipse(tile, cx, cy, rx, ry, color, alpha, VF_AA | VF_BLEND);
+}
+
+void gfx_fill_ellipse_unclipped(gfx_pixtile *tile,
+                                float cx, float cy,
+                                float rx, float ry,
+                                gfx_rgb888 color)
+{
+    fill_ellipse(tile, cx, cy, rx, ry, color, 0xFF, VF_UNCLIPPED);
+}
+
+void gfx_fill_ellipse_aa_unclipped(gfx_pixtile *tile,
+                                   float cx, float cy,
+                                   float rx, float ry,
+                                   gfx_rgb888 color)
+{
+    fill_ellipse(tile, cx, cy, rx, ry, color, 0xFF, VF_AA | VF_UNCLIPPED);
+}
+
+void gfx_fill_ellipse_blend_unclipped(gfx_pixtile *tile,
+                                      float cx, float cy,
+                                      float rx, float ry,
+                                      gfx_rgb888 color,
+                                      gfx_alpha8 alpha)
+{
+    fill_ellipse(tile, cx, cy, rx, ry, color, alpha, VF_BLEND | VF_UNCLIPPED);
+}
+
+void gfx_fill_ellipse_aa_blend_unclipped(gfx_pixtile *tile,
+                                         float cx, float cy,
+                                         float rx, float ry,
+                                         gfx_rgb888 color,
+                                         gfx_alpha8 alpha)
+{
+    fill_ellipse(tile, cx, cy, rx, ry, color, alpha,
+                 VF_AA | VF_BLEND | VF_UNCLIPPED);
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Arcs
+
+// An arc is the part of a circle's outline from angle a0 clockwise to
+// angle a1.  Angles are in radians, with 0 along +x and pi / 2 along
+// +y (down the screen).  The outline is one pixel wide, centered on
+// the radius.
+
+typedef struct arc_ends {
+    float sx, sy;               // unit vector toward a0
+    float ex, ey;               // unit vector toward a1
+    bool  is_full;              // whole circle, no ends
+    bool  is_major;             // sweep is more than half a turn
+} arc_ends;
+
+static ALWAYS_INLINE void init_arc_ends(arc_ends *ends, float a0, float a1)
+{
+    float sweep = a1 - a0;
+    ends->is_full  = ABS(sweep) >= 2 * (float)M_PI;
+    if (!ends->is_full) {
+        sweep = fmodf(sweep, 2 * (float)M_PI);
+        if (sweep < 0)
+            sweep += 2 * (float)M_PI;
+    }
+    ends->is_major = sweep > (float)M_PI;
+    ends->sx = cosf(a0);
+    ends->sy = sinf(a0);
+    ends->ex = cosf(a0 + sweep);
+    ends->ey = sinf(a0 + sweep);
+}
+
+// How much of the point (dx, dy), relative to the center, is inside
+// the arc's angular range.  Each end is a half plane through the
+// center; the signed distance to it gives one pixel of antialiasing.
+static ALWAYS_INLINE float arc_angle_coverage(const arc_ends *ends,
+                                              float dx, float dy,
+                                              variant_flags flags)
+{
+    if (ends->is_full)
+        return 1;
+    float ds = ends->sx * dy - ends->sy * dx;   // >= 0 past the start
+    float de = ends->ey * dx - ends->ex * dy;   // >= 0 before the end
+    if (flags & VF_AA) {
+        ds = CLAMP(0.0f, 1.0f, ds + 0.5f);
+        de = CLAMP(0.0f, 1.0f, de + 0.5f);
     } else {
-        for (int x = xpxl1 + 1; x < xpxl2; x++) {
-            int y = FLOOR(intery);
-            int f = 256.0f * FRAC(intery);
-            gfx_rgb565 *p = gfx_pixel_address(tile, x, y);
-            if (p)
-                *p = blend_pixel(*p, color, 255 - f);
-            p = gfx_pixel_address(tile, x, y + 1);
-            if (p)
-                *p = blend_pixel(*p, color, f);
-            intery += gradient;
+        ds = ds >= 0;
+        de = de >= 0;
+    }
+    return ends->is_major ? MAX(ds, de) : MIN(ds, de);
+}
+
+static ALWAYS_INLINE void draw_arc(gfx_pixtile *tile,
+                                   float cx, float cy, float r,
+                                   float a0, float a1,
+                                   gfx_rgb888 color,
+                                   gfx_alpha8 alpha,
+                                   variant_flags flags)
+{
+    if ((flags & VF_BLEND) && alpha == 0)
+        return;
+    paint pt;
+    init_paint(&pt, color, alpha);
+    if (!(r > 0))
+        return;
+
+    // Pixels whose centers are within half_width of the radius can
+    // be touched.
+    float half_width = (flags & VF_AA) ? 1.0f : 0.5f;
+    float ro = r + half_width;
+    float ri = r - half_width;
+    int iy0 = FLOOR(cy - ro);
+    int iy1 = CEIL(cy + ro);
+    int min_x = INT32_MIN, max_x = INT32_MAX;
+    if (!(flags & VF_UNCLIPPED)) {
+        iy0 = MAX(iy0, tile->y);
+        iy1 = MIN(iy1, tile->y + (int)tile->h);
+        min_x = tile->x;
+        max_x = tile->x + (int)tile->w;
+    }
+    if (iy0 >= iy1)
+        return;
+
+    float r2 = r * r, inv_2r = 0.5f / r;
+    float ro2 = ro * ro, ri2 = ri > 0 ? ri * ri : 0;
+    arc_ends ends;
+    init_arc_ends(&ends, a0, a1);
+    for (int iy = iy0; iy < iy1; iy++) {
+        float dy = iy + 0.5f - cy;
+        if (dy * dy >= ro2)
+            continue;
+        float ho = sqrtf(ro2 - dy * dy);
+        float hi = dy * dy < ri2 ? sqrtf(ri2 - dy * dy) : -1;
+
+        // The ring crosses this row as one run, or as two runs either
+        // side of the hole.
+        int runs[2][2] = { { FLOOR(cx - ho), CEIL(cx + ho) } };
+        size_t run_count = 1;
+        if (hi >= 0) {
+            runs[0][1] = CEIL(cx - hi);
+            runs[1][0] = MAX(FLOOR(cx + hi), runs[0][1]);
+            runs[1][1] = CEIL(cx + ho);
+            run_count = 2;
+        }
+
+        for (size_t i = 0; i < run_count; i++) {
+            int ix0 = MAX(runs[i][0], min_x);
+            int ix1 = MIN(runs[i][1], max_x);
+            if (ix0 >= ix1)
+                continue;
+            gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, ix0, iy);
+            for (int ix = ix0; ix < ix1; ix++, p++) {
+                float dx = ix + 0.5f - cx;
+                float d2 = dx * dx + dy * dy;
+                if (!(flags & VF_AA)) {
+                    if (ri2 <= d2 && d2 < ro2 &&
+                        arc_angle_coverage(&ends, dx, dy, flags) > 0)
+                        plot(p, ix, iy, &pt, flags);
+                    continue;
+                }
+                // Distance from the radius, without a square root:
+                // d - r = (d^2 - r^2) / (d + r), and d + r is within a
+                // pixel of 2r here.
+                float c = 1 - ABS((d2 - r2) * inv_2r);
+                if (c <= 0)
+                    continue;
+                c *= arc_angle_coverage(&ends, dx, dy, flags);
+                if (c <= 0)
+                    continue;
+                gfx_alpha8 a = (int)(c * 255 + 0.5f);
+                if (flags & VF_BLEND)
+                    a = mul_alpha(a, alpha);
+                if (a == 0xFF && !pt.dither)
+                    *p = pt.pixel;
+                else if (a)
+                    *p = blend_pixel(*p, &pt, a, ix, iy);
+            }
+        }
+    }
+}
+
+void gfx_draw_arc(gfx_pixtile *tile,
+                  float cx, float cy, float r,
+                  float a0, float a1,
+                  gfx_rgb888 color)
+{
+    draw_arc(tile, cx, cy, r, a0, a1, color, 0xFF, 0);
+}
+
+void gfx_draw_arc_aa(gfx_pixtile *tile,
+                     float cx, float cy, float r,
+                     float a0, float a1,
+                     gfx_rgb888 color)
+{
+    draw_arc(tile, cx, cy, r, a0, a1, color, 0xFF, VF_AA);
+}
+
+void gfx_draw_arc_blend(gfx_pixtile *tile,
+                        float cx, float cy, float r,
+                        float a0, float a1,
+                        gfx_rgb888 color,
+                        gfx_alpha8 alpha)
+{
+    draw_arc(tile, cx, cy, r, a0, a1, color, alpha, VF_BLEND);
+}
+
+void gfx_draw_arc_aa_blend(gfx_pixtile *tile,
+                           float cx, float cy, float r,
+                           float a0, float a1,
+                           gfx_rgb888 color,
+                           gfx_alpha8 alpha)
+{
+    draw_arc(tile, cx, cy, r, a0, a1, color, alpha, VF_AA | VF_BLEND);
+}
+
+void gfx_draw_arc_unclipped(gfx_pixtile *tile,
+                            float cx, float cy, float r,
+                            float a0, float a1,
+                            gfx_rgb888 color)
+{
+    draw_arc(tile, cx, cy, r, a0, a1, color, 0xFF, VF_UNCLIPPED);
+}
+
+void gfx_draw_arc_aa_unclipped(gfx_pixtile *tile,
+                               float cx, float cy, float r,
+                               float a0, float a1,
+                               gfx_rgb888 color)
+{
+    draw_arc(tile, cx, cy, r, a0, a1, color, 0xFF, VF_AA | VF_UNCLIPPED);
+}
+
+void gfx_draw_arc_blend_unclipped(gfx_pixtile *tile,
+                                  float cx, float cy, float r,
+                                  float a0, float a1,
+                                  gfx_rgb888 color,
+                                  gfx_alpha8 alpha)
+{
+    draw_arc(tile, cx, cy, r, a0, a1, color, alpha, VF_BLEND | VF_UNCLIPPED);
+}
+
+void gfx_draw_arc_aa_blend_unclipped(gfx_pixtile *tile,
+                                     float cx, float cy, float r,
+                                     float a0, float a1,
+                                     gfx_rgb888 color,
+                                     gfx_alpha8 alpha)
+{
+    draw_arc(tile, cx, cy, r, a0, a1, color, alpha,
+             VF_AA | VF_BLEND | VF_UNCLIPPED);
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Masks
+
+// Length of the run of zero coverage at m, at most n.  Skips four
+// mask pixels per load.
+static ALWAYS_INLINE size_t transparent_run(const gfx_alpha8 *m, size_t n)
+{
+    size_t i = 0;
+    for ( ; i + 4 <= n; i += 4) {
+        uint32_t w;
+        memcpy(&w, m + i, sizeof w);
+        if (w)
+            break;
+    }
+    while (i < n && !m[i])
+        i++;
+    return i;
+}
+
+static ALWAYS_INLINE size_t opaque_run(const gfx_alpha8 *m, size_t n)
+{
+    size_t i = 0;
+    while (i < n && m[i] == 0xFF)
+        i++;
+    return i;
+}
+
+static ALWAYS_INLINE void fill_mask(gfx_pixtile *tile,
+                                    const gfx_mask *mask,
+                                    gfx_rgb888 color,
+                                    gfx_alpha8 alpha,
+                                    variant_flags flags)
+{
+    if ((flags & VF_BLEND) && alpha == 0)
+        return;
+    paint pt;
+    init_paint(&pt, color, alpha);
+
+    int x0 = mask->x, x1 = mask->x + (int)mask->w;
+    int y0 = mask->y, y1 = mask->y + (int)mask->h;
+    if (!(flags & VF_UNCLIPPED)) {
+        x0 = MAX(x0, tile->x);
+        x1 = MIN(x1, tile->x + (int)tile->w);
+        y0 = MAX(y0, tile->y);
+        y1 = MIN(y1, tile->y + (int)tile->h);
+    }
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    size_t n = x1 - x0;
+    const gfx_alpha8 *m =
+        mask->pixels + (y0 - mask->y) * mask->stride + (x0 - mask->x);
+    gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, x0, y0);
+    for (int y = y0; y < y1; y++, m += mask->stride, p += tile->stride) {
+        size_t i = 0;
+        while (i < n) {
+            if (!m[i]) {
+                i += transparent_run(m + i, n - i);
+            } else if (m[i] == 0xFF) {
+                size_t run = opaque_run(m + i, n - i);
+                fill_or_blend_run(p + i, run, x0 + i, y, &pt, alpha);
+                i += run;
+            } else {
+                gfx_alpha8 a = m[i];
+                if (flags & VF_BLEND)
+                    a = mul_alpha(a, alpha);
+                p[i] = blend_pixel(p[i], &pt, a, x0 + i, y);
+                i++;
+            }
+        }
+    }
+}
+
+void gfx_fill_mask(gfx_pixtile *tile,
+                   const gfx_mask *mask,
+                   gfx_rgb888 color)
+{
+    fill_mask(tile, mask, color, 0xFF, 0);
+}
+
+void gfx_fill_mask_blend(gfx_pixtile *tile,
+                         const gfx_mask *mask,
+                         gfx_rgb888 color,
+                         gfx_alpha8 alpha)
+{
+    fill_mask(tile, mask, color, alpha, VF_BLEND);
+}
+
+void gfx_fill_mask_unclipped(gfx_pixtile *tile,
+                             const gfx_mask *mask,
+                             gfx_rgb888 color)
+{
+    fill_mask(tile, mask, color, 0xFF, VF_UNCLIPPED);
+}
+
+void gfx_fill_mask_blend_unclipped(gfx_pixtile *tile,
+                                   const gfx_mask *mask,
+                                   gfx_rgb888 color,
+                                   gfx_alpha8 alpha)
+{
+    fill_mask(tile, mask, color, alpha, VF_BLEND | VF_UNCLIPPED);
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Sprites
+
+static ALWAYS_INLINE gfx_rgb565 blend_sprite_pixel(gfx_rgb565 dest,
+                                                   gfx_rgb565 src,
+                                                   gfx_alpha8 alpha)
+{
+    uint32_t a = alpha5(alpha);
+    return unspread(blend_spread(spread_rgb565(dest),
+                                 spread_rgb565(src) * a + SPREAD_HALF,
+                                 32 - a));
+}
+
+// The alpha plane is scanned the way a mask is.  Opaque runs are
+// copied whole, unless the sprite as a whole is translucent.
+static ALWAYS_INLINE void draw_sprite(gfx_pixtile *tile,
+                                      const gfx_sprite *sprite,
+                                      gfx_alpha8 alpha,
+                                      variant_flags flags)
+{
+    if ((flags & VF_BLEND) && alpha == 0)
+        return;
+
+    int x0 = MAX(sprite->x, tile->x);
+    int x1 = MIN(sprite->x + (int)sprite->w, tile->x + (int)tile->w);
+    int y0 = MAX(sprite->y, tile->y);
+    int y1 = MIN(sprite->y + (int)sprite->h, tile->y + (int)tile->h);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    bool copy = !(flags & VF_BLEND) || alpha == 0xFF;
+    size_t n = x1 - x0;
+    size_t dx = x0 - sprite->x, dy = y0 - sprite->y;
+    const gfx_rgb565 *s = sprite->pixels + dy * sprite->stride + dx;
+    const gfx_alpha8 *m = sprite->alpha + dy * sprite->alpha_stride + dx;
+    gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, x0, y0);
+    for (int y = y0; y < y1; y++) {
+        size_t i = 0;
+        while (i < n) {
+            if (!m[i]) {
+                i += transparent_run(m + i, n - i);
+            } else if (m[i] == 0xFF) {
+                size_t run = opaque_run(m + i, n - i);
+                if (copy)
+                    memcpy(p + i, s + i, run * sizeof *p);
+                else
+                    for (size_t j = i; j < i + run; j++)
+                        p[j] = blend_sprite_pixel(p[j], s[j], alpha);
+                i += run;
+            } else {
+                gfx_alpha8 a = m[i];
+                if (flags & VF_BLEND)
+                    a = mul_alpha(a, alpha);
+                p[i] = blend_sprite_pixel(p[i], s[i], a);
+                i++;
+            }
+        }
+        s += sprite->stride;
+        m += sprite->alpha_stride;
+        p += tile->stride;
+    }
+}
+
+void gfx_draw_sprite(gfx_pixtile *tile, const gfx_sprite *sprite)
+{
+    draw_sprite(tile, sprite, 0xFF, 0);
+}
+
+void gfx_draw_sprite_blend(gfx_pixtile *tile,
+                           const gfx_sprite *sprite,
+                           gfx_alpha8 alpha)
+{
+    draw_sprite(tile, sprite, alpha, VF_BLEND);
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Subpixel Masks
+
+// The LCD filter spreads each subpixel's coverage over itself and two
+// neighbors on each side, weighted 3/9, 2/9 and 1/9, the way
+// lcd_distribution_lut does for pixmaps/make-button-img.cpp.  So
+// color fringes stay faint and every channel sees the same total
+// coverage.  lcd_filter[k][a] is a times weight k, in 8.8 fixed point,
+// and the five terms of a subpixel add to at most 255.99.
+
+#define LCD_WEIGHT(w, a) (((a) * (w) * 256 + 4) / 9)
+#define LCD_ROW4(w, a)   LCD_WEIGHT(w, (a) + 0), LCD_WEIGHT(w, (a) + 1),   \
+                         LCD_WEIGHT(w, (a) + 2), LCD_WEIGHT(w, (a) + 3)
+#define LCD_ROW16(w, a)  LCD_ROW4(w, (a) +  0), LCD_ROW4(w, (a) +  4),     \
+                         LCD_ROW4(w, (a) +  8), LCD_ROW4(w, (a) + 12)
+#define LCD_ROW64(w, a)  LCD_ROW16(w, (a) +  0), LCD_ROW16(w, (a) + 16),   \
+                         LCD_ROW16(w, (a) + 32), LCD_ROW16(w, (a) + 48)
+#define LCD_TABLE(w)     { LCD_ROW64(w,   0), LCD_ROW64(w,  64),           \
+                           LCD_ROW64(w, 128), LCD_ROW64(w, 192) }
+
+static const uint16_t lcd_filter[3][256] = {
+    LCD_TABLE(3),               // the subpixel itself
+    LCD_TABLE(2),               // its neighbors
+    LCD_TABLE(1),               // their neighbors
+};
+
+// Sample k of a row of n samples.  Samples off the row are zero.
+// Unless checked, k is known to be on the row.
+static ALWAYS_INLINE uint32_t lcd_sample(const gfx_alpha8 *s, int n, int k,
+                                         bool checked)
+{
+    return !checked || (unsigned)k < (unsigned)n ? s[k] : 0;
+}
+
+// Blend one pixel toward color with a coverage for each channel.
+static ALWAYS_INLINE gfx_rgb565 blend_pixel_lcd(gfx_rgb565 dest,
+                                                const paint *pt,
+                                                uint32_t ar,
+                                                uint32_t ag,
+                                                uint32_t ab)
+{
+    uint32_t sr = pt->pixel >> 11;
+    uint32_t sg = pt->pixel >>  5 & 0x3F;
+    uint32_t sb = pt->pixel       & 0x1F;
+    uint32_t a5r = alpha5(ar), a5b = alpha5(ab);
+    uint32_t a6g = (ag + 2) >> 2;
+    uint32_t r = ((dest >> 11)        * (32 - a5r) + sr * a5r + 16) >> 5;
+    uint32_t g = ((dest >>  5 & 0x3F) * (64 - a6g) + sg * a6g + 32) >> 6;
+    uint32_t b = ((dest       & 0x1F) * (32 - a5b) + sb * a5b + 16) >> 5;
+    return r << 11 | g << 5 | b;
+}
+
+// Composite a run of pixels from screen position (x, y).  The run's
+// first pixel covers subpixel j of the mask row s, which has n
+// subpixels, and its filter window is subpixels j - 2 through j + 4.
+// Where the window is uniform, as in a glyph's stems and around the
+// glyph, the filter is skipped, since its weights add to one, and
+// unchecked runs of uniformly clear or opaque windows are skipped or
+// filled whole.  Only pixels whose channels' coverage differs are not
+// dithered.
+static ALWAYS_INLINE void fill_mask_lcd_run(gfx_rgb565 *p, size_t count,
+                                            int x, int y,
+                                            const gfx_alpha8 *s,
+                                            int n, int j,
+                                            const paint *pt,
+                                            variant_flags flags,
+                                            bool checked)
+{
+    const uint16_t *p3 = lcd_filter[0];
+    const uint16_t *p2 = lcd_filter[1];
+    const uint16_t *p1 = lcd_filter[2];
+    for (size_t i = 0; i < count; ) {
+        uint32_t w0 = lcd_sample(s, n, j - 2, checked);
+        if (!checked && (w0 == 0 || w0 == 0xFF)) {
+            const gfx_alpha8 *w = s + j - 2;
+            size_t limit = 3 * (count - i) + 4;
+            size_t run = w0 ? opaque_run(w, limit)
+                            : transparent_run(w, limit);
+            if (run >= 7) {
+                size_t pixels = (run - 7) / 3 + 1;
+                if (w0)
+                    fill_or_blend_run(p + i, pixels, x + i, y,
+                                      pt, pt->alpha);
+                i += pixels;
+                j += 3 * pixels;
+                continue;
+            }
+        }
+        uint32_t w1 = lcd_sample(s, n, j - 1, checked);
+        uint32_t w2 = lcd_sample(s, n, j,     checked);
+        uint32_t w3 = lcd_sample(s, n, j + 1, checked);
+        uint32_t w4 = lcd_sample(s, n, j + 2, checked);
+        uint32_t w5 = lcd_sample(s, n, j + 3, checked);
+        uint32_t w6 = lcd_sample(s, n, j + 4, checked);
+        uint32_t ar, ag, ab;
+        if (!((w0 ^ w1) | (w0 ^ w2) | (w0 ^ w3) |
+              (w0 ^ w4) | (w0 ^ w5) | (w0 ^ w6))) {
+            ar = ag = ab = w0;
+        } else {
+            ar = MIN(255, (p3[w2] + p2[w1] + p2[w3] + p1[w0] + p1[w4]) >> 8);
+            ag = MIN(255, (p3[w3] + p2[w2] + p2[w4] + p1[w1] + p1[w5]) >> 8);
+            ab = MIN(255, (p3[w4] + p2[w3] + p2[w5] + p1[w2] + p1[w6]) >> 8);
         }
+        if (ar | ag | ab) {
+            if (flags & VF_BLEND) {
+                ar = mul_alpha(ar, pt->alpha);
+                ag = mul_alpha(ag, pt->alpha);
+                ab = mul_alpha(ab, pt->alpha);
+            }
+            if ((ar & ag & ab) == 0xFF && !pt->dither)
+                p[i] = pt->pixel;
+            else if (pt->dither && ar == ag && ag == ab)
+                p[i] = blend_pixel(p[i], pt, ar, x + i, y);
+            else
+                p[i] = blend_pixel_lcd(p[i], pt, ar, ag, ab);
+        }
+        i++;
+        j += 3;
+    }
+}
+
+// One row.  Windows that reach past either end of the mask row are
+// bounds checked; the rest are not.
+static ALWAYS_INLINE void fill_mask_lcd_row(gfx_rgb565 *p, size_t count,
+                                            int x, int y,
+                                            const gfx_alpha8 *s,
+                                            int n, int j,
+                                            const paint *pt,
+                                            variant_flags flags)
+{
+    // Pixel i's window is [j + 3i - 2, j + 3i + 4].  Pixels [0, head)
+    // and [tail, count) need checks.
+    int head = j >= 2 ? 0 : MIN((int)count, (4 - j) / 3);
+    int tail = n - 5 - j >= 0 ? (n - 5 - j) / 3 + 1 : 0;
+    tail = MAX(head, MIN((int)count, tail));
+    fill_mask_lcd_run(p, head, x, y, s, n, j, pt, flags, true);
+    fill_mask_lcd_run(p + head, tail - head, x + head, y,
+                      s, n, j + 3 * head, pt, flags, false);
+    fill_mask_lcd_run(p + tail, count - tail, x + tail, y,
+                      s, n, j + 3 * tail, pt, flags, true);
+}
+
+static ALWAYS_INLINE void fill_mask_lcd(gfx_pixtile *tile,
+                                        const gfx_mask *mask,
+                                        gfx_rgb888 color,
+                                        gfx_alpha8 alpha,
+                                        variant_flags flags)
+{
+    if ((flags & VF_BLEND) && alpha == 0)
+        return;
+    paint pt;
+    init_paint(&pt, color, alpha);
+
+    // The filter reaches one pixel past each side.
+    int x0 = MAX(mask->x - 1, tile->x);
+    int x1 = MIN(mask->x + (int)mask->w + 1, tile->x + (int)tile->w);
+    int y0 = MAX(mask->y, tile->y);
+    int y1 = MIN(mask->y + (int)mask->h, tile->y + (int)tile->h);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    int n = 3 * mask->w;
+    int j = 3 * (x0 - mask->x);
+    const gfx_alpha8 *s = mask->pixels + (y0 - mask->y) * mask->stride;
+    gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, x0, y0);
+    for (int y = y0; y < y1; y++, s += mask->stride, p += tile->stride)
+        fill_mask_lcd_row(p, x1 - x0, x0, y, s, n, j, &pt, flags);
+}
+
+void gfx_fill_mask_lcd(gfx_pixtile *tile,
+                       const gfx_mask *mask,
+                       gfx_rgb888 color)
+{
+    fill_mask_lcd(tile, mask, color, 0xFF, 0);
+}
+
+void gfx_fill_mask_blend_lcd(gfx_pixtile *tile,
+                             const gfx_mask *mask,
+                             gfx_rgb888 color,
+                             gfx_alpha8 alpha)
+{
+    fill_mask_lcd(tile, mask, color, alpha, VF_BLEND);
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Scaled Blits
+
+// One axis of a scaled blit.  Destination pixel i, counted from the
+// rectangle's edge, samples the source at (i + 1/2) * src_n / n, so
+// the source is stepped by a constant in 16.16 fixed point.  For
+// nearest sampling, that coordinate's integer part is the pixel.  For
+// bilinear, pixel centers are at halves, so half a pixel is taken
+// off and the fraction weights the two neighbors.
+typedef struct scale_axis {
+    int   d0, d1;               // clipped destination range, absolute
+    fix16 u0;                   // source coordinate at d0
+    fix16 du;                   // source step per destination pixel
+    int   zoom;                 // integer zoom, or 0
+    int   skip;                 // with zoom, pixels of d0's run before d0
+    int   last;                 // last source pixel
+} scale_axis;
+
+static bool init_scale_axis(scale_axis *a,
+                            int x, size_t n,
+                            size_t src_n,
+                            int clip0, int clip1,
+                            gfx_filter filter)
+{
+    a->d0 = MAX(x, clip0);
+    a->d1 = MIN(x + (int)n, clip1);
+    if (a->d0 >= a->d1)
+        return false;
+    // Step from the rectangle's edge, not the tile's, so every tile
+    // samples the same coordinates.
+    a->du = (((int64_t)src_n << 16) + n / 2) / n;
+    a->u0 = a->du / 2 + (a->d0 - x) * a->du;
+    if (filter == GFX_FILTER_BILINEAR)
+        a->u0 -= FIX16_HALF;
+    a->zoom = n % src_n ? 0 : n / src_n;
+    a->skip = a->zoom ? (a->d0 - x) % a->zoom : 0;
+    a->last = src_n - 1;
+    return true;
+}
+
+static ALWAYS_INLINE int clamp_sample(fix16 u, int last)
+{
+    return CLAMP(0, last, u >> 16);
+}
+
+static void blit_row_nearest(gfx_rgb565 *p,
+                             const gfx_rgb565 *s,
+                             const scale_axis *xa)
+{
+    if (xa->zoom) {
+        // Each source pixel is a run of zoom pixels.
+        int zoom = xa->zoom;
+        int x = xa->d0, i = xa->u0 >> 16;
+        int run = zoom - xa->skip;
+        for ( ; x < xa->d1; x += run, p += run, i++, run = zoom) {
+            run = MIN(run, xa->d1 - x);
+            fill_run(p, run, s[i]);
+        }
+        return;
+    }
+    fix16 u = xa->u0;
+    for (int x = xa->d0; x < xa->d1; x++, u += xa->du)
+        *p++ = s[MIN(u >> 16, xa->last)];
+}
+
+// Bilinear blits work on columns BLIT_CHUNK at a time.  Each column's
+// source pixels and weight are found once, and each source row is
+// interpolated across once, in spread form, then reused for every
+// destination row it contributes to.  A magnified row pair costs one
+// blend per pixel.
+#define BLIT_CHUNK 64
+
+typedef struct blit_columns {
+    int      n;
+    uint16_t i0[BLIT_CHUNK];    // left source pixel
+    uint16_t i1[BLIT_CHUNK];    // right source pixel
+    uint8_t  fx[BLIT_CHUNK];    // right pixel's weight, 0 .. 31
+} blit_columns;
+
+static void lerp_source_row(uint32_t *out,
+                            const gfx_rgb565 *s,
+                            const blit_columns *c)
+{
+    for (int k = 0; k < c->n; k++)
+        out[k] = lerp_spread(spread_rgb565(s[c->i0[k]]),
+                             spread_rgb565(s[c->i1[k]]),
+                             c->fx[k]);
+}
+
+static void blit_bilinear(gfx_pixtile *tile,
+                          const gfx_pixtile *src,
+                          const scale_axis *xa,
+                          const scale_axis *ya)
+{
+    gfx_pixtile *s = (gfx_pixtile *)src;
+    for (int x0 = xa->d0; x0 < xa->d1; x0 += BLIT_CHUNK) {
+        blit_columns c;
+        c.n = MIN(BLIT_CHUNK, xa->d1 - x0);
+        fix16 u = xa->u0 + (x0 - xa->d0) * xa->du;
+        for (int k = 0; k < c.n; k++, u += xa->du) {
+            c.i0[k] = clamp_sample(u, xa->last);
+            c.i1[k] = clamp_sample(u + FIX16_ONE, xa->last);
+            c.fx[k] = u < 0 ? 0 : (u >> 11 & 31);
+        }
+
+        uint32_t rows[2][BLIT_CHUNK];
+        uint32_t *h0 = rows[0], *h1 = rows[1];
+        int row0 = -1, row1 = -1;
+        gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, x0, ya->d0);
+        fix16 v = ya->u0;
+        for (int dy = ya->d0; dy < ya->d1; dy++, v += ya->du) {
+            int r0 = clamp_sample(v, ya->last);
+            int r1 = clamp_sample(v + FIX16_ONE, ya->last);
+            uint32_t fy = v < 0 ? 0 : (v >> 11 & 31);
+            if (r0 != row0 && r0 == row1) {
+                uint32_t *t = h0; h0 = h1; h1 = t;
+                row1 = row0;
+                row0 = r0;
+            }
+            if (r0 != row0) {
+                lerp_source_row(h0,
+                                gfx_pixel_address_unchecked(s, src->x,
+                                                            src->y + r0),
+                                &c);
+                row0 = r0;
+            }
+            if (r1 != row1) {
+                lerp_source_row(h1,
+                                gfx_pixel_address_unchecked(s, src->x,
+                                                            src->y + r1),
+                                &c);
+                row1 = r1;
+            }
+            for (int k = 0; k < c.n; k++)
+                p[k] = unspread(lerp_spread(h0[k], h1[k], fy));
+            p += tile->stride;
+        }
+    }
+}
+
+void gfx_blit_scaled(gfx_pixtile *tile,
+                     const gfx_pixtile *src,
+                     int x, int y,
+                     size_t w, size_t h,
+                     gfx_filter filter)
+{
+    if (!w || !h || !src->w || !src->h)
+        return;
+    if (w == src->w && h == src->h) {
+        gfx_ipoint offset = {{ .x = x - src->x, .y = y - src->y }};
+        gfx_copy_pixtile(tile, src, offset);
+        return;
+    }
+
+    scale_axis xa, ya;
+    if (!init_scale_axis(&xa, x, w, src->w,
+                         tile->x, tile->x + tile->w, filter))
+        return;
+    if (!init_scale_axis(&ya, y, h, src->h,
+                         tile->y, tile->y + tile->h, filter))
+        return;
+
+    if (filter == GFX_FILTER_BILINEAR) {
+        blit_bilinear(tile, src, &xa, &ya);
+        return;
+    }
+
+    // A source row that fills several destination rows is sampled
+    // once, then copied.
+    gfx_pixtile *s = (gfx_pixtile *)src;
+    gfx_rgb565 *p = gfx_pixel_address_unchecked(tile, xa.d0, ya.d0);
+    size_t row_bytes = (xa.d1 - xa.d0) * sizeof *p;
+    fix16 v = ya.u0;
+    int prev_row = -1;
+    for (int dy = ya.d0; dy < ya.d1; dy++, v += ya.du, p += tile->stride) {
+        int row = MIN(v >> 16, ya.last);
+        if (row == prev_row)
+            memcpy(p, p - tile->stride, row_bytes);
+        else
+            blit_row_nearest(p,
+                             gfx_pixel_address_unchecked(s, src->x,
+                                                         src->y + row),
+                             &xa);
+        prev_row = row;
     }
 }
@@ -0,0 +1,106 @@
+#include <gfx-gradient.h>
+
+#include <math.h>
+
+#include <math-util.h>
+
+// Channel i of c interpolated toward d by f.
+static unsigned lerp_channel(gfx_rgb888 c, gfx_rgb888 d, int i, float f)
+{
+    float a = c >> 8 * i & 0xFF, b = d >> 8 * i & 0xFF;
+    return a + (b - a) * f + 0.5f;
+}
+
+static gfx_rgb888 lerp_rgb888(gfx_rgb888 c, gfx_rgb888 d, float f)
+{
+    return lerp_channel(c, d, 2, f) << 16 |
+           lerp_channel(c, d, 1, f) <<  8 |
+           lerp_channel(c, d, 0, f);
+}
+
+// Stops at 0 and 1 are added, so every t in [0, 1] is between two.
+static void init_stops(gfx_gradient *g,
+                       const gfx_color_stop *stops,
+                       size_t stop_count,
+                       gfx_rgb565 *ramp)
+{
+    stop_count = MIN(stop_count, (size_t)GFX_GRADIENT_MAX_STOPS);
+    gfx_color_stop all[GFX_GRADIENT_MAX_STOPS + 2];
+    size_t n = 0;
+    gfx_rgb888 first = stop_count ? stops[0].color : 0;
+    all[n++] = (gfx_color_stop) { .offset = 0, .color = first };
+    float prev = 0;
+    for (size_t i = 0; i < stop_count; i++) {
+        prev = CLAMP(prev, 1.0f, stops[i].offset);
+        all[n++] = (gfx_color_stop) { .offset = prev, .color = stops[i].color };
+    }
+    all[n] = (gfx_color_stop) { .offset = 1, .color = all[n - 1].color };
+    n++;
+
+    g->stop_count = n;
+    for (size_t i = 0; i < n; i++) {
+        g->stop_t[i] = all[i].offset * 0xFFFF + 0.5f;
+        // Each channel exact to a 32nd of a 565 step, not rounded to
+        // 565, so dithering reproduces colors between 565 pixels.
+        gfx_rgb888 c = all[i].color;
+        g->stop_rgb[i][0] = ((c >> 16 & 0xFF) * 31 * 32 + 127) / 255;
+        g->stop_rgb[i][1] = ((c >>  8 & 0xFF) * 63 * 32 + 127) / 255;
+        g->stop_rgb[i][2] = ((c       & 0xFF) * 31 * 32 + 127) / 255;
+    }
+    for (size_t i = 0; i + 1 < n; i++) {
+        uint32_t len = g->stop_t[i + 1] - g->stop_t[i];
+        g->stop_scale[i] = len ? (256 << 16) / len : 0;
+    }
+    g->stop_scale[n - 1] = 0;
+
+    g->ramp = ramp;
+    if (!ramp)
+        return;
+    size_t k = 0;
+    for (size_t i = 0; i < GFX_GRADIENT_RAMP_SIZE; i++) {
+        float t = (i + 0.5f) / GFX_GRADIENT_RAMP_SIZE;
+        while (k + 2 < n && t >= all[k + 1].offset)
+            k++;
+        float len = all[k + 1].offset - all[k].offset;
+        float f = len > 0 ? (t - all[k].offset) / len : 1;
+        f = CLAMP(0.0f, 1.0f, f);
+        ramp[i] = gfx_rgb888_to_rgb565(lerp_rgb888(all[k].color,
+                                                   all[k + 1].color, f));
+    }
+}
+
+void gfx_init_linear_gradient(gfx_gradient *gradient,
+                              gfx_point p0, gfx_point p1,
+                              const gfx_color_stop *stops,
+                              size_t stop_count,
+                              gfx_rgb565 *ramp)
+{
+    // Keep t's step per pixel at most one.
+    float dx = p1.x - p0.x, dy = p1.y - p0.y;
+    float len2 = MAX(1.0f, dx * dx + dy * dy);
+    gradient->radial = false;
+    gradient->x0     = p0.x;
+    gradient->y0     = p0.y;
+    gradient->tx     = dx / len2;
+    gradient->ty     = dy / len2;
+    gradient->r2     = 0;
+    gradient->r2_inv = 0;
+    init_stops(gradient, stops, stop_count, ramp);
+}
+
+void gfx_init_radial_gradient(gfx_gradient *gradient,
+                              gfx_point center, float r,
+                              const gfx_color_stop *stops,
+                              size_t stop_count,
+                              gfx_rgb565 *ramp)
+{
+    r = MAX(1.0f, r);
+    gradient->radial = true;
+    gradient->x0     = center.x;
+    gradient->y0     = center.y;
+    gradient->tx     = 0;
+    gradient->ty     = 0;
+    gradient->r2     = r * r;
+    gradient->r2_inv = 1 / (r * r);
+    init_stops(gradient, stops, stop_count, ramp);
+}
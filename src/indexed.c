@@ -0,0 +1,188 @@
+#include <gfx-indexed.h>
+
+#include <string.h>
+
+#include <gfx-pixtile.h>
+#include <math-util.h>
+
+void gfx_init_indexed(gfx_indexed *frame,
+                      void *buffer,
+                      int x, int y,
+                      size_t w, size_t h,
+                      unsigned bpp,
+                      const gfx_rgb565 *palette)
+{
+    frame->pixels  = buffer;
+    frame->x       = x;
+    frame->y       = y;
+    frame->w       = w;
+    frame->h       = h;
+    frame->stride  = (w * bpp + 7) / 8;
+    frame->bpp     = bpp;
+    frame->palette = palette;
+}
+
+static inline uint8_t *row_address(const gfx_indexed *frame, int y)
+{
+    return frame->pixels + (y - frame->y) * frame->stride;
+}
+
+// Store index in columns [i0, i1) of a row, frame relative.
+static void store_run(const gfx_indexed *frame,
+                      uint8_t *row,
+                      int i0, int i1,
+                      uint8_t index)
+{
+    if (frame->bpp == 8) {
+        memset(row + i0, index, i1 - i0);
+        return;
+    }
+    index &= 0x0F;
+    if (i0 & 1) {
+        row[i0 / 2] = (row[i0 / 2] & 0xF0) | index;
+        i0++;
+    }
+    if (i1 & 1) {
+        i1--;
+        row[i1 / 2] = (row[i1 / 2] & 0x0F) | index << 4;
+    }
+    if (i0 < i1)
+        memset(row + i0 / 2, index * 0x11, (i1 - i0) / 2);
+}
+
+void gfx_fill_pixel_indexed(gfx_indexed *frame, int x, int y, uint8_t index)
+{
+    gfx_fill_span_indexed(frame, x, x + 1, y, index);
+}
+
+void gfx_fill_span_indexed(gfx_indexed *frame,
+                           int x0, int x1, int y,
+                           uint8_t index)
+{
+    if (y < frame->y || y >= frame->y + (int)frame->h)
+        return;
+    x0 = MAX(x0, frame->x);
+    x1 = MIN(x1, frame->x + (int)frame->w);
+    if (x0 >= x1)
+        return;
+    store_run(frame, row_address(frame, y),
+              x0 - frame->x, x1 - frame->x, index);
+}
+
+void gfx_fill_rect_indexed(gfx_indexed *frame,
+                           int x, int y,
+                           size_t w, size_t h,
+                           uint8_t index)
+{
+    int x0 = MAX(x, frame->x);
+    int x1 = MIN(x + (int)w, frame->x + (int)frame->w);
+    int y0 = MAX(y, frame->y);
+    int y1 = MIN(y + (int)h, frame->y + (int)frame->h);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+    uint8_t *row = row_address(frame, y0);
+    for (int j = y0; j < y1; j++, row += frame->stride)
+        store_run(frame, row, x0 - frame->x, x1 - frame->x, index);
+}
+
+void gfx_fill_mask_indexed(gfx_indexed *frame,
+                           const gfx_mask *mask,
+                           uint8_t index)
+{
+    int x0 = MAX(mask->x, frame->x);
+    int x1 = MIN(mask->x + (int)mask->w, frame->x + (int)frame->w);
+    int y0 = MAX(mask->y, frame->y);
+    int y1 = MIN(mask->y + (int)mask->h, frame->y + (int)frame->h);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+    const gfx_alpha8 *m = mask->pixels
+                          + (y0 - mask->y) * mask->stride + (x0 - mask->x);
+    uint8_t *row = row_address(frame, y0);
+    int i0 = x0 - frame->x;
+    for (int j = y0; j < y1; j++, m += mask->stride, row += frame->stride) {
+
+        // Store runs of covered pixels.
+        int i = 0, n = x1 - x0;
+        while (i < n) {
+            while (i < n && m[i] < 0x80)
+                i++;
+            int start = i;
+            while (i < n && m[i] >= 0x80)
+                i++;
+            if (start < i)
+                store_run(frame, row, i0 + start, i0 + i, index);
+        }
+    }
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Expansion
+
+// Pixel pairs are stored little endian, as the MCU is.
+static void expand_row_8(gfx_rgb565 *d,
+                         const uint8_t *s,
+                         size_t n,
+                         const gfx_rgb565 *palette)
+{
+    // Four pixels per load, two per store.
+    for ( ; n >= 4; n -= 4, s += 4, d += 4) {
+        uint32_t q;
+        memcpy(&q, s, sizeof q);
+        uint32_t lo = palette[q       & 0xFF]
+                      | (uint32_t)palette[q >>  8 & 0xFF] << 16;
+        uint32_t hi = palette[q >> 16 & 0xFF]
+                      | (uint32_t)palette[q >> 24       ] << 16;
+        memcpy(d,     &lo, sizeof lo);
+        memcpy(d + 2, &hi, sizeof hi);
+    }
+    for ( ; n; --n)
+        *d++ = palette[*s++];
+}
+
+// pairs[b] is the two pixels of byte b, left one first in memory.
+static void expand_row_4(gfx_rgb565 *d,
+                         const uint8_t *s,
+                         int i0, size_t n,
+                         const gfx_rgb565 *palette,
+                         const uint32_t *pairs)
+{
+    s += i0 / 2;
+    if (i0 & 1 && n) {
+        *d++ = palette[*s++ & 0x0F];
+        n--;
+    }
+    for ( ; n >= 2; n -= 2, d += 2)
+        memcpy(d, &pairs[*s++], sizeof *pairs);
+    if (n)
+        *d = palette[*s >> 4];
+}
+
+void gfx_expand_indexed(gfx_pixtile *tile, const gfx_indexed *frame)
+{
+    int x0 = MAX(tile->x, frame->x);
+    int x1 = MIN(tile->x + (int)tile->w, frame->x + (int)frame->w);
+    int y0 = MAX(tile->y, frame->y);
+    int y1 = MIN(tile->y + (int)tile->h, frame->y + (int)frame->h);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+    size_t n = x1 - x0;
+    int i0 = x0 - frame->x;
+    const uint8_t *s = row_address(frame, y0);
+    gfx_rgb565 *d = gfx_pixel_address_unchecked(tile, x0, y0);
+    const gfx_rgb565 *palette = frame->palette;
+
+    if (frame->bpp == 8) {
+        for (int y = y0; y < y1; y++, s += frame->stride, d += tile->stride)
+            expand_row_8(d, s + i0, n, palette);
+        return;
+    }
+
+    // Expanding the palette to every pair of pixels takes 256 lookups,
+    // then each byte of the frame is one.
+    uint32_t pairs[256];
+    for (size_t b = 0; b < 256; b++) {
+        pairs[b] = palette[b >> 4] | (uint32_t)palette[b & 0x0F] << 16;
+    }
+    for (int y = y0; y < y1; y++, s += frame->stride, d += tile->stride)
+        expand_row_4(d, s, i0, n, palette, pairs);
+}
@@ -12,9 +12,12 @@
 #include <libopencm3/stm32/timer.h>
 
 // Current Library headers
+#include <gfx-indexed.h>
 #include <gfx-pixtile.h>
+#include <gfx-region.h>
 #include <gpio.h>
 #include <intr.h>
+#include <math-util.h>
 #include <systick.h>
 
 
@@ -27,7 +30,13 @@
 // --  Pixtile  -  --  --  --  --  --  --  --  --  --  --  --  --  --  -
 
 #define PIXTILE_COUNT          2
-#define PIXTILE_MAX_SIZE_BYTES (RAM_SIZE / PIXTILE_COUNT)
+#define PIXTILE_MAX_SIZE_BYTES LCD_MAX_TILE_BYTES
+
+// The indexed frame, if any, follows the pixtile buffers.
+#define FRAME_BASE (RAM_BASE + PIXTILE_COUNT * PIXTILE_MAX_SIZE_BYTES)
+
+_Static_assert(LCD_FRAME_BYTES <= RAM_SIZE - PIXTILE_COUNT * LCD_WIDTH * 2,
+               "LCD_FRAME_BYTES leaves no room for the pixtiles");
 
 typedef enum pixtile_state {
     TS_CLEARED,
@@ -245,7 +254,7 @@ static void start_clear_dma(const pixtile_impl *impl)
     uintptr_t base = (uintptr_t)impl->buffer;
     size_t size = LCD_MAX_TILE_BYTES;
     assert(RAM_BASE <= base);
-    assert(base + size <= RAM_BASE + RAM_SIZE);
+    assert(base + size <= FRAME_BASE);
     assert(size >= 16);
     assert(!(size & 0xF));      // multiple of 16 bytes
 
@@ -578,8 +587,9 @@ static void init_pixtiles(void)
 
 // --  Facade API  --  --  --  --  --  --  --  --  --  --  --  --  --  -
 
-void lcd_init(void)
+void lcd_init_frame(size_t frame_bytes)
 {
+    assert(frame_bytes == LCD_FRAME_BYTES);
     init_video_dma();
     init_clear_dma();
     init_pixtiles();
@@ -587,6 +597,7 @@ void lcd_init(void)
 
 gfx_pixtile *lcd_alloc_pixtile(int x, int y, size_t w, size_t h)
 {
+    assert(!(w * h % LCD_TILE_ALIGN));
     pixtile_impl *impl = NULL;
     while (!impl) {
         for (size_t i = 0; i < PIXTILE_COUNT && !impl; i++) {
@@ -646,4 +657,71 @@ gfx_rgb565 lcd_bg_color(void)
     return bg_color;
 }
 
+void *lcd_frame_buffer(void)
+{
+    return LCD_FRAME_BYTES ? (void *)FRAME_BASE : NULL;
+}
+
+void lcd_send_indexed(const gfx_indexed *frame)
+{
+    // Tiles of a multiple of LCD_TILE_ALIGN rows are aligned whatever
+    // the width, and leave an aligned last tile.
+    size_t rows = LCD_MAX_TILE_PIXELS / frame->w / LCD_TILE_ALIGN
+                  * LCD_TILE_ALIGN;
+    assert(rows);
+    assert(!(frame->w * frame->h % LCD_TILE_ALIGN));
+    for (size_t y = 0; y < frame->h; y += rows) {
+        size_t h = MIN(rows, frame->h - y);
+        gfx_pixtile *tile =
+            lcd_alloc_pixtile(frame->x, frame->y + y, frame->w, h);
+        gfx_expand_indexed(tile, frame);
+        lcd_send_pixtile(tile);
+    }
+}
+
+_Static_assert(LCD_WIDTH % LCD_TILE_ALIGN == 0,
+               "screen rows must be whole DMA bursts");
+
+// Widen each rect to whole columns of LCD_TILE_ALIGN pixels, so every
+// tile is too.  Adding them to a fresh region keeps them disjoint,
+// and the pieces and boxes it makes of aligned rects are aligned.
+static void align_damage(gfx_region *damage)
+{
+    gfx_region aligned;
+    gfx_region_clear(&aligned);
+    for (size_t i = 0; i < damage->count; i++) {
+        gfx_irect r = damage->rects[i];
+        r.x0 = r.x0 / LCD_TILE_ALIGN * LCD_TILE_ALIGN;
+        r.x1 = (r.x1 + LCD_TILE_ALIGN - 1) / LCD_TILE_ALIGN * LCD_TILE_ALIGN;
+        gfx_region_add_rect(&aligned, r);
+    }
+    *damage = aligned;
+}
+
+void lcd_send_damage(gfx_region *damage,
+                     lcd_draw_func *draw,
+                     void *closure)
+{
+    static gfx_rgb565 sent_bg_color = 0x0000;
+    const int band_rows = LCD_MAX_TILE_ROWS;
+    const gfx_irect screen = { 0, 0, LCD_WIDTH, LCD_HEIGHT };
+    if (bg_color != sent_bg_color) {
+        sent_bg_color = bg_color;
+        gfx_region_add_rect(damage, screen);
+    }
+    gfx_region_clip(damage, screen);
+    align_damage(damage);
+    for (size_t i = 0; i < damage->count; i++) {
+        const gfx_irect *r = &damage->rects[i];
+        for (int y = r->y0, y1; y < r->y1; y = y1) {
+            y1 = MIN(r->y1, (y / band_rows + 1) * band_rows);
+            gfx_pixtile *tile =
+                lcd_alloc_pixtile(r->x0, y, r->x1 - r->x0, y1 - y);
+            (*draw)(tile, closure);
+            lcd_send_pixtile(tile);
+        }
+    }
+    gfx_region_clear(damage);
+}
+
 // --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
@@ -0,0 +1,403 @@
+#include <gfx-path.h>
+
+#include <math.h>
+
+#include <gfx.h>
+#include <gfx-pixtile.h>
+#include <gfx-polygon.h>
+#include <math-util.h>
+
+// No curve is split into more lines than this.
+#define MAX_CURVE_STEPS 128
+
+static const uint8_t op_point_counts[] = {
+    [GFX_PATH_MOVE]  = 1,
+    [GFX_PATH_LINE]  = 1,
+    [GFX_PATH_QUAD]  = 2,
+    [GFX_PATH_CUBIC] = 3,
+    [GFX_PATH_CLOSE] = 0,
+};
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Building
+
+void gfx_init_path(gfx_path *path,
+                   uint8_t *ops, size_t op_max,
+                   gfx_point *points, size_t point_max)
+{
+    path->ops         = ops;
+    path->points      = points;
+    path->op_max      = op_max;
+    path->point_max   = point_max;
+    gfx_path_clear(path);
+}
+
+void gfx_path_clear(gfx_path *path)
+{
+    path->op_count    = 0;
+    path->point_count = 0;
+}
+
+static bool append(gfx_path *path, gfx_path_op op,
+                   const gfx_point *points, size_t n)
+{
+    if (path->op_count >= path->op_max ||
+        path->point_count + n > path->point_max)
+        return false;
+    path->ops[path->op_count++] = op;
+    for (size_t i = 0; i < n; i++)
+        path->points[path->point_count++] = points[i];
+    return true;
+}
+
+bool gfx_path_move_to(gfx_path *path, float x, float y)
+{
+    gfx_point p[1] = { {{ x, y }} };
+    return append(path, GFX_PATH_MOVE, p, 1);
+}
+
+bool gfx_path_line_to(gfx_path *path, float x, float y)
+{
+    gfx_point p[1] = { {{ x, y }} };
+    return append(path, GFX_PATH_LINE, p, 1);
+}
+
+bool gfx_path_quad_to(gfx_path *path,
+                      float cx, float cy,
+                      float x, float y)
+{
+    gfx_point p[2] = { {{ cx, cy }}, {{ x, y }} };
+    return append(path, GFX_PATH_QUAD, p, 2);
+}
+
+bool gfx_path_cubic_to(gfx_path *path,
+                       float c1x, float c1y,
+                       float c2x, float c2y,
+                       float x, float y)
+{
+    gfx_point p[3] = { {{ c1x, c1y }}, {{ c2x, c2y }}, {{ x, y }} };
+    return append(path, GFX_PATH_CUBIC, p, 3);
+}
+
+bool gfx_path_close(gfx_path *path)
+{
+    return append(path, GFX_PATH_CLOSE, NULL, 0);
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Flattening
+
+typedef struct cull_box {
+    float min_x, min_y;
+    float max_x, max_y;
+} cull_box;
+
+// Does the bounding box of n points miss the box?
+static bool points_miss_box(const cull_box *box,
+                            const gfx_point *p, size_t n)
+{
+    float min_x = p[0].x, max_x = p[0].x;
+    float min_y = p[0].y, max_y = p[0].y;
+    for (size_t i = 1; i < n; i++) {
+        min_x = MIN(min_x, p[i].x);
+        max_x = MAX(max_x, p[i].x);
+        min_y = MIN(min_y, p[i].y);
+        max_y = MAX(max_y, p[i].y);
+    }
+    return max_x < box->min_x || min_x > box->max_x ||
+           max_y < box->min_y || min_y > box->max_y;
+}
+
+// Lines needed so that uniform steps in t stay within tolerance.
+// dd is the largest second difference of the control points, and
+// scale relates it to the curve's second derivative.  (Wang's
+// formula.)
+static int curve_steps(float dd, float scale, float tolerance)
+{
+    float n = sqrtf(dd * scale / tolerance);
+    if (!(n < MAX_CURVE_STEPS))
+        return MAX_CURVE_STEPS;
+    return MAX(1, CEIL(n));
+}
+
+static float second_difference(gfx_point a, gfx_point b, gfx_point c)
+{
+    float dx = a.x - 2 * b.x + c.x;
+    float dy = a.y - 2 * b.y + c.y;
+    return sqrtf(dx * dx + dy * dy);
+}
+
+// Step along the curve by forward differencing: each point costs
+// only additions.
+void gfx_flatten_quad(const gfx_point p[3],
+                      float tolerance,
+                      gfx_path_emit_func *emit,
+                      void *closure)
+{
+    // |B''| = 2 |p0 - 2 p1 + p2|, and a chord's error is |B''| / 8n^2.
+    int n = curve_steps(second_difference(p[0], p[1], p[2]), 0.25f,
+                        tolerance);
+    float h = 1.0f / n;
+    float ax = p[0].x - 2 * p[1].x + p[2].x;
+    float ay = p[0].y - 2 * p[1].y + p[2].y;
+    float bx = 2 * (p[1].x - p[0].x);
+    float by = 2 * (p[1].y - p[0].y);
+    float x = p[0].x, y = p[0].y;
+    float dx = ax * h * h + bx * h, dy = ay * h * h + by * h;
+    float ddx = 2 * ax * h * h, ddy = 2 * ay * h * h;
+    for (int i = 1; i < n; i++) {
+        x += dx;
+        y += dy;
+        dx += ddx;
+        dy += ddy;
+        emit(closure, GFX_PATH_LINE, (gfx_point) {{ x, y }});
+    }
+    emit(closure, GFX_PATH_LINE, p[2]);
+}
+
+static void flatten_cubic(const gfx_point p[4],
+                          float tolerance,
+                          gfx_path_emit_func *emit,
+                          void *closure)
+{
+    // |B''| <= 6 max |p[i] - 2 p[i+1] + p[i+2]|.
+    float dd = MAX(second_difference(p[0], p[1], p[2]),
+                   second_difference(p[1], p[2], p[3]));
+    int n = curve_steps(dd, 0.75f, tolerance);
+    float h = 1.0f / n, h2 = h * h, h3 = h2 * h;
+    float ax = -p[0].x + 3 * (p[1].x - p[2].x) + p[3].x;
+    float ay = -p[0].y + 3 * (p[1].y - p[2].y) + p[3].y;
+    float bx = 3 * (p[0].x - 2 * p[1].x + p[2].x);
+    float by = 3 * (p[0].y - 2 * p[1].y + p[2].y);
+    float cx = 3 * (p[1].x - p[0].x);
+    float cy = 3 * (p[1].y - p[0].y);
+    float x = p[0].x, y = p[0].y;
+    float dx = ax * h3 + bx * h2 + cx * h;
+    float dy = ay * h3 + by * h2 + cy * h;
+    float ddx = 6 * ax * h3 + 2 * bx * h2;
+    float ddy = 6 * ay * h3 + 2 * by * h2;
+    float dddx = 6 * ax * h3, dddy = 6 * ay * h3;
+    for (int i = 1; i < n; i++) {
+        x += dx;
+        y += dy;
+        dx += ddx;
+        dy += ddy;
+        ddx += dddx;
+        ddy += dddy;
+        emit(closure, GFX_PATH_LINE, (gfx_point) {{ x, y }});
+    }
+    emit(closure, GFX_PATH_LINE, p[3]);
+}
+
+void gfx_flatten_path(const gfx_path *path,
+                      const gfx_pixtile *tile,
+                      float margin,
+                      float tolerance,
+                      gfx_path_emit_func *emit,
+                      void *closure)
+{
+    cull_box box = { 0, 0, 0, 0 };
+    if (tile) {
+        box = (cull_box) {
+            .min_x = tile->x - margin,
+            .min_y = tile->y - margin,
+            .max_x = tile->x + tile->w + margin,
+            .max_y = tile->y + tile->h + margin,
+        };
+    }
+
+    // seg[0] is the current point; seg[1 ...] are the op's points.
+    gfx_point seg[4] = { {{ 0, 0 }} };
+    gfx_point start = seg[0];
+    const gfx_point *pts = path->points;
+    for (size_t i = 0; i < path->op_count; i++) {
+        gfx_path_op op = path->ops[i];
+        size_t n = op_point_counts[op];
+        for (size_t j = 0; j < n; j++)
+            seg[j + 1] = *pts++;
+
+        switch (op) {
+
+            case GFX_PATH_MOVE:
+                start = seg[1];
+                emit(closure, op, seg[1]);
+                break;
+
+            case GFX_PATH_LINE:
+                emit(closure, op, seg[1]);
+                break;
+
+            case GFX_PATH_QUAD:
+            case GFX_PATH_CUBIC:
+                if (tile && points_miss_box(&box, seg, n + 1))
+                    emit(closure, GFX_PATH_LINE, seg[n]);
+                else if (op == GFX_PATH_QUAD)
+                    gfx_flatten_quad(seg, tolerance, emit, closure);
+                else
+                    flatten_cubic(seg, tolerance, emit, closure);
+                break;
+
+            case GFX_PATH_CLOSE:
+                seg[0] = start;
+                emit(closure, op, start);
+                break;
+        }
+        if (n)
+            seg[0] = seg[n];
+    }
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Drawing
+
+typedef void draw_line_fn(gfx_pixtile *tile,
+                          float x0, float y0,
+                          float x1, float y1,
+                          gfx_rgb888 color,
+                          gfx_alpha8 alpha);
+
+typedef struct path_drawer {
+    gfx_pixtile  *tile;
+    gfx_rgb888    color;
+    gfx_alpha8    alpha;
+    draw_line_fn *draw_line;
+    gfx_point     start;        // of the current subpath
+    gfx_point     current;
+} path_drawer;
+
+static void draw_opaque_line(gfx_pixtile *tile,
+                             float x0, float y0,
+                             float x1, float y1,
+                             gfx_rgb888 color,
+                             gfx_alpha8 alpha)
+{
+    (void)alpha;
+    gfx_draw_line(tile, x0, y0, x1, y1, color);
+}
+
+static void draw_opaque_line_aa(gfx_pixtile *tile,
+                                float x0, float y0,
+                                float x1, float y1,
+                                gfx_rgb888 color,
+                                gfx_alpha8 alpha)
+{
+    (void)alpha;
+    gfx_draw_line_aa(tile, x0, y0, x1, y1, color);
+}
+
+static void draw_path_step(void *closure, gfx_path_op op, gfx_point p)
+{
+    path_drawer *d = closure;
+    if (op == GFX_PATH_MOVE) {
+        d->start = d->current = p;
+        return;
+    }
+    d->draw_line(d->tile,
+                 d->current.x, d->current.y, p.x, p.y,
+                 d->color, d->alpha);
+    d->current = p;
+}
+
+static void draw_path(gfx_pixtile *tile,
+                      const gfx_path *path,
+                      gfx_rgb888 color,
+                      gfx_alpha8 alpha,
+                      draw_line_fn *draw_line)
+{
+    path_drawer d = {
+        .tile      = tile,
+        .color     = color,
+        .alpha     = alpha,
+        .draw_line = draw_line,
+    };
+    // Lines are at most a pixel wide, so a pixel of margin is enough.
+    gfx_flatten_path(path, tile, 1, GFX_PATH_TOLERANCE, draw_path_step, &d);
+}
+
+void gfx_draw_path(gfx_pixtile *tile,
+                   const gfx_path *path,
+                   gfx_rgb888 color)
+{
+    draw_path(tile, path, color, 0xFF, draw_opaque_line);
+}
+
+void gfx_draw_path_aa(gfx_pixtile *tile,
+                      const gfx_path *path,
+                      gfx_rgb888 color)
+{
+    draw_path(tile, path, color, 0xFF, draw_opaque_line_aa);
+}
+
+void gfx_draw_path_blend(gfx_pixtile *tile,
+                         const gfx_path *path,
+                         gfx_rgb888 color,
+                         gfx_alpha8 alpha)
+{
+    draw_path(tile, path, color, alpha, gfx_draw_line_blend);
+}
+
+void gfx_draw_path_aa_blend(gfx_pixtile *tile,
+                            const gfx_path *path,
+                            gfx_rgb888 color,
+                            gfx_alpha8 alpha)
+{
+    draw_path(tile, path, color, alpha, gfx_draw_line_aa_blend);
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Filling
+
+// Each band of the fill flattens the path again, culled to the band.
+static void path_outline(void *closure,
+                         const gfx_pixtile *band,
+                         gfx_path_emit_func *emit,
+                         void *emit_closure)
+{
+    gfx_flatten_path(closure, band, 0, GFX_PATH_TOLERANCE,
+                     emit, emit_closure);
+}
+
+static void fill_path(gfx_pixtile *tile,
+                      const gfx_path *path,
+                      gfx_fill_rule rule,
+                      bool aa,
+                      gfx_rgb888 color,
+                      gfx_alpha8 alpha)
+{
+    gfx_fill_outline(tile, path_outline, (void *)path,
+                     rule, aa, color, alpha);
+}
+
+void gfx_fill_path(gfx_pixtile *tile,
+                   const gfx_path *path,
+                   gfx_fill_rule rule,
+                   gfx_rgb888 color)
+{
+    fill_path(tile, path, rule, false, color, 0xFF);
+}
+
+void gfx_fill_path_aa(gfx_pixtile *tile,
+                      const gfx_path *path,
+                      gfx_fill_rule rule,
+                      gfx_rgb888 color)
+{
+    fill_path(tile, path, rule, true, color, 0xFF);
+}
+
+void gfx_fill_path_blend(gfx_pixtile *tile,
+                         const gfx_path *path,
+                         gfx_fill_rule rule,
+                         gfx_rgb888 color,
+                         gfx_alpha8 alpha)
+{
+    fill_path(tile, path, rule, false, color, alpha);
+}
+
+void gfx_fill_path_aa_blend(gfx_pixtile *tile,
+                            const gfx_path *path,
+                            gfx_fill_rule rule,
+                            gfx_rgb888 color,
+                            gfx_alpha8 alpha)
+{
+    fill_path(tile, path, rule, true, color, alpha);
+}
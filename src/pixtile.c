@@ -1,5 +1,6 @@
 #include <gfx-pixtile.h>
 
+#include <stdbool.h>
 #include <string.h>
 
 #include <math-util.h>
@@ -27,25 +28,66 @@ extern gfx_rgb565 *gfx_pixel_address(gfx_pixtile *tile, int x, int y)
     return gfx_pixel_address_unchecked(tile, x, y);
 }
 
-void gfx_copy_pixtile(gfx_pixtile       *dest,
+// The part of src, translated by offset, that lands in dest:
+// nx x ny pixels from (*xs, *ys) in src go to (*xd, *yd) in dest.
+static bool clip_copy(gfx_pixtile       *dest,
                       gfx_pixtile const *src,
-                      gfx_ipoint         offset)
+                      gfx_ipoint         offset,
+                      int *xs, int *ys,
+                      int *xd, int *yd,
+                      int *nx, int *ny)
 {
     int x0s = MAX(src->x, dest->x - offset.x);
     int x1s = MIN(src->x + (int)src->w, dest->x + (int)dest->w - offset.x);
     if (x0s >= x1s)
-        return;
-    int x0d = x0s + offset.x;
-    int nx = x1s - x0s;
+        return false;
     int y0s = MAX(src->y, dest->y - offset.y);
     int y1s = MIN(src->y + (int)src->h, dest->y + (int)dest->h - offset.y);
     if (y0s >= y1s)
+        return false;
+    *xs = x0s;
+    *ys = y0s;
+    *xd = x0s + offset.x;
+    *yd = y0s + offset.y;
+    *nx = x1s - x0s;
+    *ny = y1s - y0s;
+    return true;
+}
+
+void gfx_copy_pixtile(gfx_pixtile       *dest,
+                      gfx_pixtile const *src,
+                      gfx_ipoint         offset)
+{
+    int xs, ys, xd, yd, nx, ny;
+    if (!clip_copy(dest, src, offset, &xs, &ys, &xd, &yd, &nx, &ny))
         return;
-    int y0d = y0s + offset.y;
-    for (int ys = y0s, yd = y0d; ys < y1s; ys++, yd++) {
-        const gfx_rgb565 *ps =
-            gfx_pixel_address_unchecked((gfx_pixtile *)src, x0s, ys);
-        gfx_rgb565 *pd = gfx_pixel_address_unchecked(dest, x0d, yd);
+    const gfx_rgb565 *ps =
+        gfx_pixel_address_unchecked((gfx_pixtile *)src, xs, ys);
+    gfx_rgb565 *pd = gfx_pixel_address_unchecked(dest, xd, yd);
+    for ( ; ny; --ny, ps += src->stride, pd += dest->stride)
         memcpy(pd, ps, nx * sizeof *pd);
+}
+
+void gfx_copy_pixtile_keyed(gfx_pixtile       *dest,
+                            gfx_pixtile const *src,
+                            gfx_ipoint         offset,
+                            gfx_rgb565         key)
+{
+    int xs, ys, xd, yd, nx, ny;
+    if (!clip_copy(dest, src, offset, &xs, &ys, &xd, &yd, &nx, &ny))
+        return;
+    const gfx_rgb565 *ps =
+        gfx_pixel_address_unchecked((gfx_pixtile *)src, xs, ys);
+    gfx_rgb565 *pd = gfx_pixel_address_unchecked(dest, xd, yd);
+    for ( ; ny; --ny, ps += src->stride, pd += dest->stride) {
+        int i = 0;
+        while (i < nx) {
+            while (i < nx && ps[i] == key)
+                i++;
+            int i0 = i;
+            while (i < nx && ps[i] != key)
+                i++;
+            memcpy(pd + i0, ps + i0, (i - i0) * sizeof *pd);
+        }
     }
 }
@@ -0,0 +1,670 @@
+#include <gfx-polygon.h>
+
+#include <string.h>
+
+#include <gfx.h>
+#include <gfx-paint.h>
+#include <gfx-pixtile.h>
+#include <lcd.h>
+#include <math-util.h>
+
+// Edges are accumulated in fixed point with 8 fraction bits.
+#define SUBPIXEL_SHIFT 8
+#define SUBPIXEL_ONE   (1 << SUBPIXEL_SHIFT)
+#define SUBPIXEL_MASK  (SUBPIXEL_ONE - 1)
+
+// The cell pool is static, so on the device it lives in CCM with the
+// rest of the data.  By default it holds eight cells a row for the
+// tallest pixtile, 14 KB, or 6 KB with a full 8 bit indexed frame set
+// aside.  Each cell costs 13 bytes.  Outlines that need more are
+// filled in bands, down to single pixels.
+#ifndef GFX_POLYGON_CELLS
+#define GFX_POLYGON_CELLS (8 * LCD_MAX_TILE_ROWS)
+#endif
+
+#define MAX_ROWS       LCD_MAX_TILE_ROWS
+#define MAX_CELLS      GFX_POLYGON_CELLS
+
+_Static_assert(MAX_ROWS <= 256, "cell rows must fit in a byte");
+_Static_assert(MAX_CELLS <= 0xFFFF, "cell indices must fit in 16 bits");
+_Static_assert(MAX_CELLS >= 3, "a one pixel band needs three cells");
+
+// A cell is one pixel that an edge crosses.  cover is the signed
+// height of the edge within the pixel, and area is twice the signed
+// area between the edge and the pixel's left side, both in subpixels.
+// Every pixel to the right of the cell is covered by cover.
+typedef struct cell {
+    int32_t area;
+    int16_t cover;
+    int16_t x;
+} cell;
+
+static cell     cells[MAX_CELLS];
+static uint8_t  cell_rows[MAX_CELLS];
+
+// Cells sorted by row, then x.  Each is x << 16 | index.
+static uint32_t sorted_cells[MAX_CELLS];
+static uint16_t row_ends[MAX_ROWS];
+
+typedef struct rasterizer {
+    gfx_pixtile   band;         // the tile's rows being filled
+    gfx_fill_rule rule;
+    bool          aa;
+    gfx_paint     paint;        // the color, converted once
+    gfx_alpha8    alpha;
+    gfx_alpha8   *mask;         // coverage goes here instead, if not NULL
+    int           mask_x;       // screen position of mask's first pixel
+    int           mask_y;
+    size_t        mask_stride;
+    size_t        cell_count;
+    bool          overflow;     // cells were dropped
+    int           cx, cy;       // current cell, band relative
+    int           cover, area;
+    gfx_point     start;        // of the current subpath
+    gfx_point     current;
+} rasterizer;
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Cells
+
+// A one pixel band's cells are all in its pixel or on its right side,
+// so a full pool is summed into one cell for each.
+static void merge_cells(rasterizer *r)
+{
+    int area[2] = { 0, 0 }, cover[2] = { 0, 0 };
+    for (size_t i = 0; i < r->cell_count; i++) {
+        int k = cells[i].x > 0;
+        area[k] += cells[i].area;
+        cover[k] += cells[i].cover;
+    }
+    for (int k = 0; k < 2; k++) {
+        cells[k] = (cell) { .area = area[k], .cover = cover[k], .x = k };
+        cell_rows[k] = 0;
+    }
+    r->cell_count = 2;
+}
+
+// Store the current cell if the edges crossed it.  Cells are stored in
+// the order edges reach them; several edges may store the same pixel.
+static void flush_cell(rasterizer *r)
+{
+    if (!(r->cover | r->area))
+        return;
+    if (r->cy < 0 || r->cy >= (ssize_t)r->band.h)
+        return;
+    if (r->cell_count == MAX_CELLS) {
+        if (r->band.w > 1 || r->band.h > 1) {
+            r->overflow = true;
+            return;
+        }
+        merge_cells(r);
+    }
+    size_t i = r->cell_count++;
+    cells[i] = (cell) {
+        .area  = r->area,
+        .cover = r->cover,
+        .x     = r->cx,
+    };
+    cell_rows[i] = r->cy;
+}
+
+static void set_cell(rasterizer *r, int x, int y)
+{
+    if (x != r->cx || y != r->cy) {
+        flush_cell(r);
+        r->cx = x;
+        r->cy = y;
+        r->cover = 0;
+        r->area = 0;
+    }
+}
+
+// Accumulate the part of an edge within row ey.  x1 and x2 are band
+// relative subpixels; y1 and y2 are subpixels within the row.
+static void render_hline(rasterizer *r,
+                         int ey,
+                         int x1, int y1,
+                         int x2, int y2)
+{
+    int ex1 = x1 >> SUBPIXEL_SHIFT;
+    int ex2 = x2 >> SUBPIXEL_SHIFT;
+    int fx1 = x1 & SUBPIXEL_MASK;
+    int fx2 = x2 & SUBPIXEL_MASK;
+
+    if (y1 == y2) {
+        set_cell(r, ex2, ey);
+        return;
+    }
+
+    // Within one cell.
+    if (ex1 == ex2) {
+        int delta = y2 - y1;
+        r->cover += delta;
+        r->area += (fx1 + fx2) * delta;
+        return;
+    }
+
+    // Across several cells: the first and last are partial, and the
+    // rows between divide the height evenly, with the remainder
+    // carried Bresenham style.
+    int p = (SUBPIXEL_ONE - fx1) * (y2 - y1);
+    int first = SUBPIXEL_ONE;
+    int incr = 1;
+    int dx = x2 - x1;
+    if (dx < 0) {
+        p = fx1 * (y2 - y1);
+        first = 0;
+        incr = -1;
+        dx = -dx;
+    }
+    int delta = p / dx;
+    int mod = p % dx;
+    if (mod < 0) {
+        delta--;
+        mod += dx;
+    }
+    r->cover += delta;
+    r->area += (fx1 + first) * delta;
+    ex1 += incr;
+    set_cell(r, ex1, ey);
+    y1 += delta;
+
+    if (ex1 != ex2) {
+        p = SUBPIXEL_ONE * (y2 - y1 + delta);
+        int lift = p / dx;
+        int rem = p % dx;
+        if (rem < 0) {
+            lift--;
+            rem += dx;
+        }
+        mod -= dx;
+        while (ex1 != ex2) {
+            delta = lift;
+            mod += rem;
+            if (mod >= 0) {
+                mod -= dx;
+                delta++;
+            }
+            r->cover += delta;
+            r->area += SUBPIXEL_ONE * delta;
+            y1 += delta;
+            ex1 += incr;
+            set_cell(r, ex1, ey);
+        }
+    }
+    delta = y2 - y1;
+    r->cover += delta;
+    r->area += (fx2 + SUBPIXEL_ONE - first) * delta;
+}
+
+// Accumulate an edge between band relative subpixel points.  The
+// edge must lie within the band.
+static void render_line(rasterizer *r, int x1, int y1, int x2, int y2)
+{
+    int ey1 = y1 >> SUBPIXEL_SHIFT;
+    int ey2 = y2 >> SUBPIXEL_SHIFT;
+    int fy1 = y1 & SUBPIXEL_MASK;
+    int fy2 = y2 & SUBPIXEL_MASK;
+    int dx = x2 - x1;
+    int dy = y2 - y1;
+
+    set_cell(r, x1 >> SUBPIXEL_SHIFT, ey1);
+
+    // Within one row.
+    if (ey1 == ey2) {
+        render_hline(r, ey1, x1, fy1, x2, fy2);
+        return;
+    }
+
+    int first = SUBPIXEL_ONE;
+    int incr = 1;
+
+    // Vertical: one cell per row, all alike but the ends.
+    if (dx == 0) {
+        int ex = x1 >> SUBPIXEL_SHIFT;
+        int two_fx = (x1 & SUBPIXEL_MASK) << 1;
+        if (dy < 0) {
+            first = 0;
+            incr = -1;
+        }
+        int delta = first - fy1;
+        r->cover += delta;
+        r->area += two_fx * delta;
+        ey1 += incr;
+        set_cell(r, ex, ey1);
+        delta = first + first - SUBPIXEL_ONE;
+        int area = two_fx * delta;
+        while (ey1 != ey2) {
+            r->cover = delta;
+            r->area = area;
+            ey1 += incr;
+            set_cell(r, ex, ey1);
+        }
+        delta = fy2 - SUBPIXEL_ONE + first;
+        r->cover += delta;
+        r->area += two_fx * delta;
+        return;
+    }
+
+    // Several rows: step x from row to row, Bresenham style.
+    int p = (SUBPIXEL_ONE - fy1) * dx;
+    if (dy < 0) {
+        p = fy1 * dx;
+        first = 0;
+        incr = -1;
+        dy = -dy;
+    }
+    int delta = p / dy;
+    int mod = p % dy;
+    if (mod < 0) {
+        delta--;
+        mod += dy;
+    }
+    int x_from = x1 + delta;
+    render_hline(r, ey1, x1, fy1, x_from, first);
+    ey1 += incr;
+    set_cell(r, x_from >> SUBPIXEL_SHIFT, ey1);
+
+    if (ey1 != ey2) {
+        p = SUBPIXEL_ONE * dx;
+        int lift = p / dy;
+        int rem = p % dy;
+        if (rem < 0) {
+            lift--;
+            rem += dy;
+        }
+        mod -= dy;
+        while (ey1 != ey2) {
+            delta = lift;
+            mod += rem;
+            if (mod >= 0) {
+                mod -= dy;
+                delta++;
+            }
+            int x_to = x_from + delta;
+            render_hline(r, ey1, x_from, SUBPIXEL_ONE - first, x_to, first);
+            x_from = x_to;
+            ey1 += incr;
+            set_cell(r, x_from >> SUBPIXEL_SHIFT, ey1);
+        }
+    }
+    render_hline(r, ey1, x_from, SUBPIXEL_ONE - first, x2, fy2);
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Edges
+
+static int to_subpixel(float v)
+{
+    return (int)(v * SUBPIXEL_ONE + 0.5f);
+}
+
+// Clip a line that lies within the band's rows to its columns.  Parts
+// left of the band move onto its left side, where they still cover
+// the pixels to their right.  Parts right of the band move onto its
+// right side, where their cells end the spans.
+static void add_clipped_line(rasterizer *r,
+                             float x0, float y0,
+                             float x1, float y1)
+{
+    float w = r->band.w;
+    if ((x0 < 0 && x1 > 0) || (x0 > 0 && x1 < 0)) {
+        float y = y0 + (y1 - y0) * -x0 / (x1 - x0);
+        add_clipped_line(r, x0, y0, 0, y);
+        add_clipped_line(r, 0, y, x1, y1);
+        return;
+    }
+    if ((x0 < w && x1 > w) || (x0 > w && x1 < w)) {
+        float y = y0 + (y1 - y0) * (w - x0) / (x1 - x0);
+        add_clipped_line(r, x0, y0, w, y);
+        add_clipped_line(r, w, y, x1, y1);
+        return;
+    }
+    if (x0 > w || x1 > w)
+        x0 = x1 = w;
+    else if (x0 < 0 || x1 < 0)
+        x0 = x1 = 0;
+    render_line(r,
+                to_subpixel(x0), to_subpixel(y0),
+                to_subpixel(x1), to_subpixel(y1));
+}
+
+// Add an edge in screen coordinates.  Only the part within the band's
+// rows is accumulated; horizontal edges cover nothing.
+static void add_line(rasterizer *r, gfx_point p0, gfx_point p1)
+{
+    float h = r->band.h;
+    float x0 = p0.x - r->band.x, y0 = p0.y - r->band.y;
+    float x1 = p1.x - r->band.x, y1 = p1.y - r->band.y;
+    if (y0 == y1)
+        return;
+    if ((y0 <= 0 && y1 <= 0) || (y0 >= h && y1 >= h))
+        return;
+    float dxdy = (x1 - x0) / (y1 - y0);
+    if (y0 < 0) {
+        x0 -= y0 * dxdy;
+        y0 = 0;
+    } else if (y0 > h) {
+        x0 += (h - y0) * dxdy;
+        y0 = h;
+    }
+    if (y1 < 0) {
+        x1 -= y1 * dxdy;
+        y1 = 0;
+    } else if (y1 > h) {
+        x1 += (h - y1) * dxdy;
+        y1 = h;
+    }
+    add_clipped_line(r, x0, y0, x1, y1);
+}
+
+static void close_subpath(rasterizer *r)
+{
+    if (r->current.x != r->start.x || r->current.y != r->start.y)
+        add_line(r, r->current, r->start);
+}
+
+static void outline_step(void *closure, gfx_path_op op, gfx_point p)
+{
+    rasterizer *r = closure;
+    if (op == GFX_PATH_MOVE) {
+        close_subpath(r);
+        r->start = p;
+    } else {
+        add_line(r, r->current, p);
+    }
+    r->current = p;
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Sweeping
+
+// Convert twice the covered area, in subpixels, to alpha.
+static gfx_alpha8 coverage_alpha(const rasterizer *r, int area)
+{
+    int coverage = ABS(area >> (2 * SUBPIXEL_SHIFT + 1 - 8));
+    if (r->rule == GFX_FILL_EVEN_ODD) {
+        coverage &= 0x1FF;
+        if (coverage > 0x100)
+            coverage = 0x200 - coverage;
+    }
+    if (coverage > 0xFF)
+        coverage = 0xFF;
+    if (!r->aa)
+        return coverage >= 0x80 ? r->alpha : 0;
+    return coverage * r->alpha * 0x8081 >> 23;
+}
+
+static void paint_pixel(rasterizer *r, int x, int y, gfx_alpha8 alpha)
+{
+    if (r->mask)
+        r->mask[(y - r->mask_y) * r->mask_stride +
+                r->band.x + x - r->mask_x] = alpha;
+    else
+        gfx_paint_pixel(gfx_pixel_address_unchecked(&r->band,
+                                                    r->band.x + x, y),
+                        r->band.x + x, y, &r->paint, alpha);
+}
+
+static void paint_span(rasterizer *r, int x0, int x1, int y,
+                       gfx_alpha8 alpha)
+{
+    if (r->mask)
+        memset(r->mask + (y - r->mask_y) * r->mask_stride +
+                   r->band.x + x0 - r->mask_x,
+               alpha, x1 - x0);
+    else if (alpha)
+        gfx_paint_run(gfx_pixel_address_unchecked(&r->band,
+                                                  r->band.x + x0, y),
+                      x1 - x0, r->band.x + x0, y, &r->paint, alpha);
+}
+
+// Shell sort one row's keys.  Rows are short and arrive nearly in
+// order, so this is mostly an insertion sort.
+static void sort_row(uint32_t *keys, size_t n)
+{
+    static const uint16_t gaps[] = { 1, 4, 10, 23, 57, 132, 301, 701 };
+    const int gap_count = sizeof gaps / sizeof gaps[0];
+
+    int g = 0;
+    while (g + 1 < gap_count && gaps[g + 1] < n)
+        g++;
+    for ( ; g >= 0; g--) {
+        size_t gap = gaps[g];
+        for (size_t i = gap; i < n; i++) {
+            uint32_t key = keys[i];
+            size_t j = i;
+            for ( ; j >= gap && keys[j - gap] > key; j -= gap)
+                keys[j] = keys[j - gap];
+            keys[j] = key;
+        }
+    }
+}
+
+// Bucket the cells by row, counting, then sort each row by x.
+static void sort_cells(rasterizer *r)
+{
+    size_t rows = r->band.h;
+    for (size_t row = 0; row < rows; row++)
+        row_ends[row] = 0;
+    for (size_t i = 0; i < r->cell_count; i++)
+        row_ends[cell_rows[i]]++;
+    uint16_t start = 0;
+    for (size_t row = 0; row < rows; row++) {
+        uint16_t n = row_ends[row];
+        row_ends[row] = start;
+        start += n;
+    }
+    for (size_t i = 0; i < r->cell_count; i++)
+        sorted_cells[row_ends[cell_rows[i]]++] = cells[i].x << 16 | i;
+
+    start = 0;
+    for (size_t row = 0; row < rows; row++) {
+        sort_row(sorted_cells + start, row_ends[row] - start);
+        start = row_ends[row];
+    }
+}
+
+// Walk a row's cells left to right.  A pixel with area is partly
+// covered; the pixels between cells are covered by the running sum
+// of cover, so they are painted as one span.
+static void sweep_row(rasterizer *r, int row, const uint32_t *keys, size_t n)
+{
+    int y = r->band.y + row;
+    int w = r->band.w;
+    int cover = 0;
+    for (size_t k = 0; k < n; ) {
+        int x = keys[k] >> 16;
+        int area = 0;
+        do {
+            const cell *c = &cells[keys[k] & 0xFFFF];
+            cover += c->cover;
+            area += c->area;
+            k++;
+        } while (k < n && (int)(keys[k] >> 16) == x);
+        if (x >= w)
+            break;
+        int full_area = cover * 2 * SUBPIXEL_ONE;
+        if (area) {
+            paint_pixel(r, x, y, coverage_alpha(r, full_area - area));
+            x++;
+        }
+        if (k < n) {
+            int next = MIN((int)(keys[k] >> 16), w);
+            if (next > x)
+                paint_span(r, x, next, y, coverage_alpha(r, full_area));
+        }
+    }
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Filling
+
+// Accumulate the outline's cells for the band, then sweep them.  If
+// the pool overflows, fill each half of the band separately: the top
+// and bottom rows, or, for one row, the left and right columns.
+static void fill_band(rasterizer *r, gfx_outline_func *outline, void *closure)
+{
+    r->cell_count = 0;
+    r->overflow = false;
+    r->cx = r->cy = -1;
+    r->cover = r->area = 0;
+    r->start = r->current = (gfx_point) {{ 0, 0 }};
+
+    outline(closure, &r->band, outline_step, r);
+    close_subpath(r);
+    flush_cell(r);
+
+    if (r->overflow) {
+        gfx_pixtile band = r->band;
+        if (band.h > 1) {
+            size_t top = band.h / 2;
+            r->band.h = top;
+            fill_band(r, outline, closure);
+            r->band.y = band.y + top;
+            r->band.h = band.h - top;
+        } else {
+            size_t left = band.w / 2;
+            r->band.w = left;
+            fill_band(r, outline, closure);
+            r->band.x = band.x + left;
+            r->band.w = band.w - left;
+        }
+        fill_band(r, outline, closure);
+        r->band = band;
+        return;
+    }
+    sort_cells(r);
+    size_t start = 0;
+    for (size_t row = 0; row < r->band.h; row++) {
+        sweep_row(r, row, sorted_cells + start, row_ends[row] - start);
+        start = row_ends[row];
+    }
+}
+
+void gfx_fill_outline(gfx_pixtile *tile,
+                      gfx_outline_func *outline,
+                      void *closure,
+                      gfx_fill_rule rule,
+                      bool aa,
+                      gfx_rgb888 color,
+                      gfx_alpha8 alpha)
+{
+    if (!alpha)
+        return;
+    rasterizer r = {
+        .band  = *tile,
+        .rule  = rule,
+        .aa    = aa,
+        .alpha = alpha,
+    };
+    gfx_init_paint(&r.paint, color, alpha);
+    for (size_t y = 0; y < tile->h; y += MAX_ROWS) {
+        r.band.y = tile->y + y;
+        r.band.h = MIN(tile->h - y, MAX_ROWS);
+        fill_band(&r, outline, closure);
+    }
+}
+
+void gfx_rasterize_outline(gfx_alpha8 *pixels,
+                           int x, int y,
+                           size_t w, size_t h,
+                           size_t stride,
+                           gfx_outline_func *outline,
+                           void *closure,
+                           gfx_fill_rule rule,
+                           bool aa)
+{
+    for (size_t row = 0; row < h; row++)
+        memset(pixels + row * stride, 0, w);
+    rasterizer r = {
+        .band        = {
+            .pixels  = NULL,
+            .x       = x,
+            .w       = w,
+            .stride  = stride,
+        },
+        .rule        = rule,
+        .aa          = aa,
+        .alpha       = 0xFF,
+        .mask        = pixels,
+        .mask_x      = x,
+        .mask_y      = y,
+        .mask_stride = stride,
+    };
+    for (size_t row = 0; row < h; row += MAX_ROWS) {
+        r.band.y = y + row;
+        r.band.h = MIN(h - row, MAX_ROWS);
+        fill_band(&r, outline, closure);
+    }
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Polygons
+
+typedef struct polygon {
+    const gfx_point *points;
+    size_t           count;
+} polygon;
+
+static void polygon_outline(void *closure,
+                            const gfx_pixtile *band,
+                            gfx_path_emit_func *emit,
+                            void *emit_closure)
+{
+    const polygon *poly = closure;
+    (void)band;
+    for (size_t i = 0; i < poly->count; i++)
+        emit(emit_closure, i ? GFX_PATH_LINE : GFX_PATH_MOVE,
+             poly->points[i]);
+}
+
+static void fill_polygon(gfx_pixtile *tile,
+                         const gfx_point *points,
+                         size_t count,
+                         gfx_fill_rule rule,
+                         bool aa,
+                         gfx_rgb888 color,
+                         gfx_alpha8 alpha)
+{
+    polygon poly = { points, count };
+    gfx_fill_outline(tile, polygon_outline, &poly, rule, aa, color, alpha);
+}
+
+void gfx_fill_polygon(gfx_pixtile *tile,
+                      const gfx_point *points,
+                      size_t count,
+                      gfx_fill_rule rule,
+                      gfx_rgb888 color)
+{
+    fill_polygon(tile, points, count, rule, false, color, 0xFF);
+}
+
+void gfx_fill_polygon_aa(gfx_pixtile *tile,
+                         const gfx_point *points,
+                         size_t count,
+                         gfx_fill_rule rule,
+                         gfx_rgb888 color)
+{
+    fill_polygon(tile, points, count, rule, true, color, 0xFF);
+}
+
+void gfx_fill_polygon_blend(gfx_pixtile *tile,
+                            const gfx_point *points,
+                            size_t count,
+                            gfx_fill_rule rule,
+                            gfx_rgb888 color,
+                            gfx_alpha8 alpha)
+{
+    fill_polygon(tile, points, count, rule, false, color, alpha);
+}
+
+void gfx_fill_polygon_aa_blend(gfx_pixtile *tile,
+                               const gfx_point *points,
+                               size_t count,
+                               gfx_fill_rule rule,
+                               gfx_rgb888 color,
+                               gfx_alpha8 alpha)
+{
+    fill_polygon(tile, points, count, rule, true, color, alpha);
+}
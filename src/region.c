@@ -0,0 +1,174 @@
+#include <gfx-region.h>
+
+#include <stdint.h>
+
+#include <math-util.h>
+
+static inline bool rect_is_empty(const gfx_irect *r)
+{
+    return r->x0 >= r->x1 || r->y0 >= r->y1;
+}
+
+static inline size_t rect_area(const gfx_irect *r)
+{
+    return (size_t)(r->x1 - r->x0) * (size_t)(r->y1 - r->y0);
+}
+
+static inline bool rects_overlap(const gfx_irect *a, const gfx_irect *b)
+{
+    return a->x0 < b->x1 && b->x0 < a->x1 &&
+           a->y0 < b->y1 && b->y0 < a->y1;
+}
+
+static inline bool rect_contains(const gfx_irect *outer,
+                                 const gfx_irect *inner)
+{
+    return outer->x0 <= inner->x0 && inner->x1 <= outer->x1 &&
+           outer->y0 <= inner->y0 && inner->y1 <= outer->y1;
+}
+
+static inline gfx_irect rect_union(const gfx_irect *a, const gfx_irect *b)
+{
+    return (gfx_irect) {
+        MIN(a->x0, b->x0), MIN(a->y0, b->y0),
+        MAX(a->x1, b->x1), MAX(a->y1, b->y1),
+    };
+}
+
+// True if disjoint a and b side by side make a rect.
+static inline bool rects_join(const gfx_irect *a, const gfx_irect *b)
+{
+    if (a->x0 == b->x0 && a->x1 == b->x1)
+        return a->y1 == b->y0 || b->y1 == a->y0;
+    if (a->y0 == b->y0 && a->y1 == b->y1)
+        return a->x1 == b->x0 || b->x1 == a->x0;
+    return false;
+}
+
+static inline void remove_rect(gfx_region *region, size_t i)
+{
+    region->rects[i] = region->rects[--region->count];
+}
+
+void gfx_region_clear(gfx_region *region)
+{
+    region->count = 0;
+}
+
+// r is disjoint from the region.  Replace the rect whose bounding box
+// with r adds the fewest pixels by that box, and take in the rects it
+// then overlaps, until it overlaps none.
+static void merge_rect(gfx_region *region, gfx_irect r)
+{
+    size_t best = 0, best_waste = SIZE_MAX;
+    for (size_t i = 0; i < region->count; i++) {
+        gfx_irect u = rect_union(&region->rects[i], &r);
+        size_t waste = rect_area(&u) - rect_area(&region->rects[i]);
+        if (waste < best_waste) {
+            best = i;
+            best_waste = waste;
+        }
+    }
+    r = rect_union(&region->rects[best], &r);
+    remove_rect(region, best);
+    for (size_t i = 0; i < region->count; ) {
+        if (rects_overlap(&region->rects[i], &r)) {
+            r = rect_union(&region->rects[i], &r);
+            remove_rect(region, i);
+            i = 0;
+        } else
+            i++;
+    }
+    region->rects[region->count++] = r;
+}
+
+void gfx_region_add_rect(gfx_region *region, gfx_irect r)
+{
+    if (rect_is_empty(&r))
+        return;
+
+    for (size_t i = 0; i < region->count; i++) {
+        gfx_irect s = region->rects[i];
+        if (!rects_overlap(&s, &r))
+            continue;
+        if (rect_contains(&s, &r))
+            return;
+        if (rect_contains(&r, &s)) {
+            remove_rect(region, i--);
+            continue;
+        }
+
+        // Add the parts of r above, below, left, and right of s.
+        int y0 = MAX(r.y0, s.y0), y1 = MIN(r.y1, s.y1);
+        gfx_irect parts[4] = {
+            { r.x0, r.y0, r.x1, s.y0 },
+            { r.x0, s.y1, r.x1, r.y1 },
+            { r.x0, y0,   s.x0, y1   },
+            { s.x1, y0,   r.x1, y1   },
+        };
+        for (size_t j = 0; j < 4; j++)
+            gfx_region_add_rect(region, parts[j]);
+        return;
+    }
+
+    // r is disjoint from the region now.
+    for (size_t i = 0; i < region->count; i++) {
+        if (rects_join(&region->rects[i], &r)) {
+            gfx_irect u = rect_union(&region->rects[i], &r);
+            remove_rect(region, i);
+            gfx_region_add_rect(region, u);
+            return;
+        }
+    }
+    if (region->count == GFX_REGION_MAX_RECTS)
+        merge_rect(region, r);
+    else
+        region->rects[region->count++] = r;
+}
+
+void gfx_region_add_region(gfx_region *region, const gfx_region *other)
+{
+    for (size_t i = 0; i < other->count; i++)
+        gfx_region_add_rect(region, other->rects[i]);
+}
+
+void gfx_region_clip(gfx_region *region, gfx_irect rect)
+{
+    for (size_t i = 0; i < region->count; ) {
+        gfx_irect *r = &region->rects[i];
+        r->x0 = MAX(r->x0, rect.x0);
+        r->y0 = MAX(r->y0, rect.y0);
+        r->x1 = MIN(r->x1, rect.x1);
+        r->y1 = MIN(r->y1, rect.y1);
+        if (rect_is_empty(r))
+            remove_rect(region, i);
+        else
+            i++;
+    }
+}
+
+bool gfx_region_intersects_rect(const gfx_region *region, gfx_irect rect)
+{
+    for (size_t i = 0; i < region->count; i++)
+        if (rects_overlap(&region->rects[i], &rect))
+            return true;
+    return false;
+}
+
+gfx_irect gfx_region_bounds(const gfx_region *region)
+{
+    if (!region->count)
+        return (gfx_irect) { 0, 0, 0, 0 };
+    gfx_irect b = region->rects[0];
+    for (size_t i = 1; i < region->count; i++)
+        b = rect_union(&b, &region->rects[i]);
+    return b;
+}
+
+size_t gfx_region_area(const gfx_region *region)
+{
+    size_t area = 0;
+    for (size_t i = 0; i < region->count; i++)
+        area += rect_area(&region->rects[i]);
+    return area;
+}
@@ -0,0 +1,50 @@
+#include <gfx-rle.h>
+
+#include <string.h>
+
+#include <gfx.h>
+#include <gfx-paint.h>
+#include <gfx-pixtile.h>
+#include <math-util.h>
+
+void gfx_draw_rle_image(gfx_pixtile         *tile,
+                        const gfx_rle_image *image,
+                        gfx_ipoint           position)
+{
+    int x0 = MAX(position.x, tile->x);
+    int x1 = MIN(position.x + (int)image->w, tile->x + (int)tile->w);
+    int y0 = MAX(position.y, tile->y);
+    int y1 = MIN(position.y + (int)image->h, tile->y + (int)tile->h);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+
+    for (int y = y0; y < y1; y++) {
+        const uint16_t *d = image->data + image->rows[y - position.y];
+
+        // Runs left of the pixtile are stepped over, and the row ends
+        // at the first run past it.
+        for (int x = position.x; x < x1; ) {
+            uint16_t head = *d++;
+            int n = head & GFX_RLE_MAX_RUN;
+            int rx0 = MAX(x, x0), rx1 = MIN(x + n, x1);
+            switch (head & GFX_RLE_KIND_MASK) {
+
+            case GFX_RLE_FILL:
+                if (rx0 < rx1)
+                    gfx_store_run(gfx_pixel_address_unchecked(tile, rx0, y),
+                                  rx1 - rx0, *d);
+                d++;
+                break;
+
+            case GFX_RLE_COPY:
+                if (rx0 < rx1)
+                    memcpy(gfx_pixel_address_unchecked(tile, rx0, y),
+                           d + (rx0 - x),
+                           (rx1 - rx0) * sizeof *d);
+                d += n;
+                break;
+            }
+            x += n;
+        }
+    }
+}
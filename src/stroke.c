@@ -0,0 +1,397 @@
+#include <gfx-stroke.h>
+
+#include <math.h>
+
+#include <gfx-pixtile.h>
+#include <gfx-polygon.h>
+#include <math-util.h>
+
+// Round joins and caps are discs with at most this many sides.
+#define MAX_ROUND_STEPS 64
+
+typedef struct stroke_box {
+    float min_x, min_y;
+    float max_x, max_y;
+} stroke_box;
+
+typedef struct stroker {
+    gfx_path_emit_func *emit;
+    void               *emit_closure;
+    stroke_box          box;          // the band
+    float               hw;           // half width
+    gfx_stroke_join     join;
+    gfx_stroke_cap      cap;
+    int                 round_steps;
+    float               round_cos, round_sin;
+    bool                started;      // the subpath has a segment
+    gfx_point           start, start_dir;
+    gfx_point           current, dir;
+} stroker;
+
+static inline gfx_point add(gfx_point a, gfx_point b)
+{
+    return (gfx_point) {{ a.x + b.x, a.y + b.y }};
+}
+
+static inline gfx_point sub(gfx_point a, gfx_point b)
+{
+    return (gfx_point) {{ a.x - b.x, a.y - b.y }};
+}
+
+static inline gfx_point scale(gfx_point a, float s)
+{
+    return (gfx_point) {{ a.x * s, a.y * s }};
+}
+
+// a rotated a quarter turn, from +x toward +y.
+static inline gfx_point perp(gfx_point a)
+{
+    return (gfx_point) {{ -a.y, a.x }};
+}
+
+static inline float dot(gfx_point a, gfx_point b)
+{
+    return a.x * b.x + a.y * b.y;
+}
+
+static inline float cross(gfx_point a, gfx_point b)
+{
+    return a.x * b.y - a.y * b.x;
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Pieces
+
+// Emit a convex piece of the outline unless it misses the band.  Every
+// piece winds the same way, so where pieces overlap the winding number
+// only grows, and the nonzero rule paints those pixels once.
+static void emit_piece(stroker *s, const gfx_point *v, size_t n)
+{
+    float min_x = v[0].x, max_x = v[0].x;
+    float min_y = v[0].y, max_y = v[0].y;
+    float area = 0;
+    for (size_t i = 0; i < n; i++) {
+        min_x = MIN(min_x, v[i].x);
+        max_x = MAX(max_x, v[i].x);
+        min_y = MIN(min_y, v[i].y);
+        max_y = MAX(max_y, v[i].y);
+        area += cross(v[i], v[(i + 1) % n]);
+    }
+    if (max_x <= s->box.min_x || min_x >= s->box.max_x ||
+        max_y <= s->box.min_y || min_y >= s->box.max_y)
+        return;
+    if (area == 0)
+        return;
+    s->emit(s->emit_closure, GFX_PATH_MOVE, v[0]);
+    for (size_t i = 1; i < n; i++)
+        s->emit(s->emit_closure, GFX_PATH_LINE, v[area > 0 ? i : n - i]);
+}
+
+static void emit_disc(stroker *s, gfx_point c)
+{
+    float hw = s->hw;
+    if (c.x + hw <= s->box.min_x || c.x - hw >= s->box.max_x ||
+        c.y + hw <= s->box.min_y || c.y - hw >= s->box.max_y)
+        return;
+    gfx_point v[MAX_ROUND_STEPS];
+    gfx_point r = {{ hw, 0 }};
+    v[0] = add(c, r);
+    for (int i = 1; i < s->round_steps; i++) {
+        r = (gfx_point) {{ r.x * s->round_cos - r.y * s->round_sin,
+                           r.x * s->round_sin + r.y * s->round_cos }};
+        v[i] = add(c, r);
+    }
+    emit_piece(s, v, s->round_steps);
+}
+
+// Fill the wedge outside the corner where segments with directions
+// d0 and d1 meet at p.  Inside the corner the segments overlap.
+static void emit_join(stroker *s, gfx_point p, gfx_point d0, gfx_point d1)
+{
+    float turn = cross(d0, d1);
+    if (turn == 0 && dot(d0, d1) > 0)
+        return;
+    if (s->join == GFX_JOIN_ROUND) {
+        emit_disc(s, p);
+        return;
+    }
+
+    // o0 and o1 are the offsets to the outside of the corner.
+    gfx_point o0 = scale(perp(d0), s->hw);
+    gfx_point o1 = scale(perp(d1), s->hw);
+    if (turn > 0) {
+        o0 = scale(o0, -1);
+        o1 = scale(o1, -1);
+    }
+    if (s->join == GFX_JOIN_MITER) {
+        // The miter tip is along o0 + o1, half a width from both edges.
+        gfx_point b = add(o0, o1);
+        float b_o0 = dot(b, o0);
+        if (b_o0 > 0) {
+            gfx_point m = scale(b, s->hw * s->hw / b_o0);
+            float limit = GFX_STROKE_MITER_LIMIT * s->hw;
+            if (dot(m, m) <= limit * limit) {
+                gfx_point v[4] = { p, add(p, o0), add(p, m), add(p, o1) };
+                emit_piece(s, v, 4);
+                return;
+            }
+        }
+    }
+    gfx_point v[3] = { p, add(p, o0), add(p, o1) };
+    emit_piece(s, v, 3);
+}
+
+// Cap the end point p of a segment heading in direction d.
+static void emit_cap(stroker *s, gfx_point p, gfx_point d)
+{
+    if (s->cap == GFX_CAP_ROUND) {
+        emit_disc(s, p);
+    } else if (s->cap == GFX_CAP_SQUARE) {
+        gfx_point n = scale(perp(d), s->hw);
+        gfx_point e = add(p, scale(d, s->hw));
+        gfx_point v[4] = { add(p, n), add(e, n), sub(e, n), sub(p, n) };
+        emit_piece(s, v, 4);
+    }
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Stroking
+
+static void init_stroker(stroker *s,
+                         const gfx_stroke *stroke,
+                         const gfx_pixtile *band,
+                         gfx_path_emit_func *emit,
+                         void *emit_closure)
+{
+    float hw = stroke->width / 2;
+    // Sides of a disc stray hw (1 - cos(pi / n)) from the circle.
+    int n = 8;
+    if (hw > GFX_PATH_TOLERANCE) {
+        float half_angle = acosf(1 - GFX_PATH_TOLERANCE / hw);
+        n = CLAMP(8, MAX_ROUND_STEPS, CEIL((float)M_PI / half_angle));
+    }
+    *s = (stroker) {
+        .emit         = emit,
+        .emit_closure = emit_closure,
+        .box          = {
+            .min_x    = band->x,
+            .min_y    = band->y,
+            .max_x    = band->x + band->w,
+            .max_y    = band->y + band->h,
+        },
+        .hw           = hw,
+        .join         = stroke->join,
+        .cap          = stroke->cap,
+        .round_steps  = n,
+        .round_cos    = cosf(2 * (float)M_PI / n),
+        .round_sin    = sinf(2 * (float)M_PI / n),
+    };
+}
+
+static void stroke_segment(stroker *s, gfx_point p)
+{
+    gfx_point v = sub(p, s->current);
+    float len = sqrtf(dot(v, v));
+    if (len == 0)
+        return;
+    gfx_point d = scale(v, 1 / len);
+    if (s->started) {
+        emit_join(s, s->current, s->dir, d);
+    } else {
+        s->start_dir = d;
+        s->started = true;
+    }
+    gfx_point n = scale(perp(d), s->hw);
+    gfx_point q[4] = {
+        add(s->current, n), add(p, n), sub(p, n), sub(s->current, n),
+    };
+    emit_piece(s, q, 4);
+    s->current = p;
+    s->dir = d;
+}
+
+static void finish_subpath(stroker *s)
+{
+    if (s->started) {
+        emit_cap(s, s->start, scale(s->start_dir, -1));
+        emit_cap(s, s->current, s->dir);
+        s->started = false;
+    }
+}
+
+static void stroke_step(void *closure, gfx_path_op op, gfx_point p)
+{
+    stroker *s = closure;
+    switch (op) {
+
+        case GFX_PATH_MOVE:
+            finish_subpath(s);
+            s->start = s->current = p;
+            break;
+
+        case GFX_PATH_LINE:
+            stroke_segment(s, p);
+            break;
+
+        case GFX_PATH_CLOSE:
+            stroke_segment(s, p);
+            if (s->started)
+                emit_join(s, s->start, s->dir, s->start_dir);
+            s->started = false;
+            break;
+
+        default:
+            break;
+    }
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Polylines
+
+typedef struct polyline {
+    const gfx_point  *points;
+    size_t            count;
+    const gfx_stroke *stroke;
+} polyline;
+
+static void polyline_outline(void *closure,
+                             const gfx_pixtile *band,
+                             gfx_path_emit_func *emit,
+                             void *emit_closure)
+{
+    const polyline *pl = closure;
+    stroker s;
+    init_stroker(&s, pl->stroke, band, emit, emit_closure);
+    for (size_t i = 0; i < pl->count; i++)
+        stroke_step(&s, i ? GFX_PATH_LINE : GFX_PATH_MOVE, pl->points[i]);
+    finish_subpath(&s);
+}
+
+static void stroke_polyline(gfx_pixtile *tile,
+                            const gfx_point *points,
+                            size_t count,
+                            const gfx_stroke *stroke,
+                            bool aa,
+                            gfx_rgb888 color,
+                            gfx_alpha8 alpha)
+{
+    if (!(stroke->width > 0))
+        return;
+    polyline pl = { points, count, stroke };
+    gfx_fill_outline(tile, polyline_outline, &pl,
+                     GFX_FILL_NONZERO, aa, color, alpha);
+}
+
+void gfx_stroke_polyline(gfx_pixtile *tile,
+                         const gfx_point *points,
+                         size_t count,
+                         const gfx_stroke *stroke,
+                         gfx_rgb888 color)
+{
+    stroke_polyline(tile, points, count, stroke, false, color, 0xFF);
+}
+
+void gfx_stroke_polyline_aa(gfx_pixtile *tile,
+                            const gfx_point *points,
+                            size_t count,
+                            const gfx_stroke *stroke,
+                            gfx_rgb888 color)
+{
+    stroke_polyline(tile, points, count, stroke, true, color, 0xFF);
+}
+
+void gfx_stroke_polyline_blend(gfx_pixtile *tile,
+                               const gfx_point *points,
+                               size_t count,
+                               const gfx_stroke *stroke,
+                               gfx_rgb888 color,
+                               gfx_alpha8 alpha)
+{
+    stroke_polyline(tile, points, count, stroke, false, color, alpha);
+}
+
+void gfx_stroke_polyline_aa_blend(gfx_pixtile *tile,
+                                  const gfx_point *points,
+                                  size_t count,
+                                  const gfx_stroke *stroke,
+                                  gfx_rgb888 color,
+                                  gfx_alpha8 alpha)
+{
+    stroke_polyline(tile, points, count, stroke, true, color, alpha);
+}
+
+// --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  --  -
+// Paths
+
+typedef struct path_stroke {
+    const gfx_path   *path;
+    const gfx_stroke *stroke;
+} path_stroke;
+
+static void path_outline(void *closure,
+                         const gfx_pixtile *band,
+                         gfx_path_emit_func *emit,
+                         void *emit_closure)
+{
+    const path_stroke *ps = closure;
+    stroker s;
+    init_stroker(&s, ps->stroke, band, emit, emit_closure);
+
+    // A curve that is not flattened becomes its chord, whose pieces
+    // must still miss the band: miters reach farthest, and square
+    // caps reach half a width times sqrt 2.
+    float margin = s.hw * (s.join == GFX_JOIN_MITER
+                           ? GFX_STROKE_MITER_LIMIT
+                           : 1.5f);
+    gfx_flatten_path(ps->path, band, margin, GFX_PATH_TOLERANCE,
+                     stroke_step, &s);
+    finish_subpath(&s);
+}
+
+static void stroke_path(gfx_pixtile *tile,
+                        const gfx_path *path,
+                        const gfx_stroke *stroke,
+                        bool aa,
+                        gfx_rgb888 color,
+                        gfx_alpha8 alpha)
+{
+    if (!(stroke->width > 0))
+        return;
+    path_stroke ps = { path, stroke };
+    gfx_fill_outline(tile, path_outline, &ps,
+                     GFX_FILL_NONZERO, aa, color, alpha);
+}
+
+void gfx_stroke_path(gfx_pixtile *tile,
+                     const gfx_path *path,
+                     const gfx_stroke *stroke,
+                     gfx_rgb888 color)
+{
+    stroke_path(tile, path, stroke, false, color, 0xFF);
+}
+
+void gfx_stroke_path_aa(gfx_pixtile *tile,
+                        const gfx_path *path,
+                        const gfx_stroke *stroke,
+                        gfx_rgb888 color)
+{
+    stroke_path(tile, path, stroke, true, color, 0xFF);
+}
+
+void gfx_stroke_path_blend(gfx_pixtile *tile,
+                           const gfx_path *path,
+                           const gfx_stroke *stroke,
+                           gfx_rgb888 color,
+                           gfx_alpha8 alpha)
+{
+    stroke_path(tile, path, stroke, false, color, alpha);
+}
+
+void gfx_stroke_path_aa_blend(gfx_pixtile *tile,
+                              const gfx_path *path,
+                              const gfx_stroke *stroke,
+                              gfx_rgb888 color,
+                              gfx_alpha8 alpha)
+{
+    stroke_path(tile, path, stroke, true, color, alpha);
+}
@@ -0,0 +1,209 @@
+#include <gfx-text.h>
+
+#include <limits.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <gfx.h>
+#include <gfx-pixtile.h>
+#include <math-util.h>
+
+static inline const gfx_glyph *find_glyph(const gfx_font *font,
+                                          unsigned char c)
+{
+    unsigned i = c - font->first;
+    return i < font->count ? &font->glyphs[i] : NULL;
+}
+
+static int kerning(const gfx_font *font,
+                   const gfx_glyph *left,
+                   unsigned char right)
+{
+    const gfx_kern_pair *k = font->kerning + left->kern_first;
+    for (size_t i = 0; i < left->kern_count && k[i].right <= right; i++)
+        if (k[i].right == right)
+            return k[i].adjust;
+    return 0;
+}
+
+// Lay out one line, starting at *text, and return its width.
+// Leave *text at the line's end.
+static int line_width(const gfx_font *font, const char **text)
+{
+    const char *p = *text;
+    const gfx_glyph *prev = NULL;
+    int x = 0;
+    for ( ; *p && *p != '\n'; p++) {
+        unsigned char c = *p;
+        const gfx_glyph *g = find_glyph(font, c);
+        if (!g)
+            continue;
+        if (prev)
+            x += kerning(font, prev, c);
+        x += g->advance;
+        prev = g;
+    }
+    *text = p;
+    return x;
+}
+
+int gfx_text_width(const gfx_font *font, const char *text)
+{
+    int w = 0;
+    while (true) {
+        w = MAX(w, line_width(font, &text));
+        if (!*text++)
+            return w;
+    }
+}
+
+gfx_irect gfx_text_bounds(const gfx_font *font,
+                          gfx_ipoint origin,
+                          const char *text)
+{
+    // The LCD filter reaches a pixel past the glyph on each side.
+    int pad = font->lcd ? 1 : 0;
+    gfx_irect box = { INT_MAX, INT_MAX, INT_MIN, INT_MIN };
+    for (int y = origin.y; ; y += font->line_height) {
+        const gfx_glyph *prev = NULL;
+        int x = origin.x;
+        for ( ; *text && *text != '\n'; text++) {
+            unsigned char c = *text;
+            const gfx_glyph *g = find_glyph(font, c);
+            if (!g)
+                continue;
+            if (prev)
+                x += kerning(font, prev, c);
+            int gx0 = x + g->left, gy0 = y - g->top;
+            box.x0 = MIN(box.x0, gx0 - pad);
+            box.x1 = MAX(box.x1, gx0 + g->w + pad);
+            box.y0 = MIN(box.y0, gy0);
+            box.y1 = MAX(box.y1, gy0 + g->h);
+            x += g->advance;
+            prev = g;
+        }
+        if (!*text++)
+            return box;
+    }
+}
+
+// Fill the part of the glyph with its pen at (x, y) that lands in
+// the clip box.
+static void draw_glyph(gfx_pixtile *tile,
+                       const gfx_font *font,
+                       const gfx_glyph *g,
+                       int x, int y,
+                       int clip_x0, int clip_y0,
+                       int clip_x1, int clip_y1,
+                       gfx_rgb888 color,
+                       gfx_alpha8 alpha,
+                       bool blend)
+{
+    int gx0 = x + g->left, gx1 = gx0 + g->w;
+    int gy0 = y - g->top,  gy1 = gy0 + g->h;
+    int x0 = MAX(gx0, clip_x0), x1 = MIN(gx1, clip_x1);
+    int y0 = MAX(gy0, clip_y0), y1 = MIN(gy1, clip_y1);
+
+    // The LCD filter reaches a pixel past the glyph on each side, and
+    // needs all of a row's samples, so only rows are clipped here.
+    if (font->lcd) {
+        if (MAX(gx0 - 1, clip_x0) >= MIN(gx1 + 1, clip_x1) || y0 >= y1)
+            return;
+        gfx_mask mask = {
+            .pixels = font->atlas + g->offset + (y0 - gy0) * 3 * g->w,
+            .x      = gx0,
+            .y      = y0,
+            .w      = g->w,
+            .h      = y1 - y0,
+            .stride = 3 * g->w,
+        };
+        if (blend)
+            gfx_fill_mask_blend_lcd(tile, &mask, color, alpha);
+        else
+            gfx_fill_mask_lcd(tile, &mask, color);
+        return;
+    }
+
+    if (x0 >= x1 || y0 >= y1)
+        return;
+    gfx_mask mask = {
+        .pixels = font->atlas + g->offset
+                  + (y0 - gy0) * g->w + (x0 - gx0),
+        .x      = x0,
+        .y      = y0,
+        .w      = x1 - x0,
+        .h      = y1 - y0,
+        .stride = g->w,
+    };
+    if (blend)
+        gfx_fill_mask_blend_unclipped(tile, &mask, color, alpha);
+    else
+        gfx_fill_mask_unclipped(tile, &mask, color);
+}
+
+static void draw_text(gfx_pixtile *tile,
+                      const gfx_font *font,
+                      gfx_ipoint origin,
+                      const char *text,
+                      gfx_rgb888 color,
+                      gfx_alpha8 alpha,
+                      bool blend)
+{
+    if (blend && alpha == 0)
+        return;
+
+    int clip_x0 = tile->x, clip_x1 = tile->x + (int)tile->w;
+    int clip_y0 = tile->y, clip_y1 = tile->y + (int)tile->h;
+
+    for (int y = origin.y; ; y += font->line_height) {
+
+        // Lines are drawn top to bottom, so once one is below the
+        // tile, the rest are too.
+        if (y - font->ascent >= clip_y1)
+            return;
+
+        if (y + font->descent <= clip_y0) {
+            text = strchr(text, '\n');
+            if (!text++)
+                return;
+            continue;           // -> next line
+        }
+
+        const gfx_glyph *prev = NULL;
+        int x = origin.x;
+        for ( ; *text && *text != '\n'; text++) {
+            unsigned char c = *text;
+            const gfx_glyph *g = find_glyph(font, c);
+            if (!g)
+                continue;
+            if (prev)
+                x += kerning(font, prev, c);
+            draw_glyph(tile, font, g, x, y,
+                       clip_x0, clip_y0, clip_x1, clip_y1,
+                       color, alpha, blend);
+            x += g->advance;
+            prev = g;
+        }
+        if (!*text++)
+            return;
+    }
+}
+
+void gfx_draw_text(gfx_pixtile *tile,
+                   const gfx_font *font,
+                   gfx_ipoint origin,
+                   const char *text,
+                   gfx_rgb888 color)
+{
+    draw_text(tile, font, origin, text, color, 0xFF, false);
+}
+
+void gfx_draw_text_blend(gfx_pixtile *tile,
+                         const gfx_font *font,
+                         gfx_ipoint origin,
+                         const char *text,
+                         gfx_rgb888 color,
+                         gfx_alpha8 alpha)
+{
+    draw_text(tile, font, origin, text, color, alpha, true);
+}